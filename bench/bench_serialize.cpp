@@ -0,0 +1,101 @@
+/**
+ * Compares file size and store/load time of the json and binary NeuralNet
+ * formats.
+ *
+ * Usage: bench_serialize [hidden neurons] [repetitions]
+ */
+
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+
+#include "binformat.h"
+#include "genome.h"
+#include "phenotype.h"
+#include "serialize.h"
+
+
+double average_ms(int repetitions, const std::function<void()>& func)
+{
+    auto start = std::chrono::steady_clock::now();
+    for(int i = 0; i < repetitions; ++i)
+    {
+        func();
+    }
+    std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+    return elapsed.count() / repetitions;
+}
+
+
+void report(const std::string& name, const std::string& path, double store_ms, double load_ms)
+{
+    std::printf("%-16s %12ju %12.3f %12.3f\n", name.c_str(),
+                static_cast<std::uintmax_t>(std::filesystem::file_size(path)), store_ms, load_ms);
+}
+
+
+int main(int argc, char** argv)
+{
+    int num_hidden = argc > 1 ? std::stoi(argv[1]) : 200;
+    int repetitions = argc > 2 ? std::stoi(argv[2]) : 20;
+
+    neat::Params p;
+    neat::Genome g(1, 16, 4, &p);
+    neat::InnovationDB inno_db(g.NeuronGenes(), g.NeuronLinks());
+    for(int i = 0; i < num_hidden; ++i)
+    {
+        g.AddNeuron(1.0, inno_db, 100);
+        for(int j = 0; j < 4; ++j)
+        {
+            g.AddLink(1.0, 0.2, inno_db, 100, 100);
+        }
+    }
+    neat::NeuralNet nn(g);
+
+    std::size_t num_links = 0;
+    for(auto& n : nn.GetNeurons())
+    {
+        num_links += n.InLinks.size();
+    }
+    std::cout << nn.GetNeurons().size() << " neurons, " << num_links << " links, "
+              << repetitions << " repetitions" << std::endl;
+    std::printf("%-16s %12s %12s %12s\n", "format", "bytes", "store ms", "load ms");
+
+    auto json_store = average_ms(repetitions, [&]() { neat::serialize_to_file("bench.json", nn); });
+    auto json_load = average_ms(repetitions, [&]()
+    {
+        auto object = neat::deserialize_from_file("bench.json");
+        neat::NeuralNet loaded(object);
+    });
+    report("json (indent 2)", "bench.json", json_store, json_load);
+
+    json_store = average_ms(repetitions, [&]() { neat::serialize_to_file("bench.json", nn, false); });
+    json_load = average_ms(repetitions, [&]()
+    {
+        auto object = neat::deserialize_from_file("bench.json");
+        neat::NeuralNet loaded(object);
+    });
+    report("json (compact)", "bench.json", json_store, json_load);
+
+    json_load = average_ms(repetitions, [&]()
+    {
+        std::ifstream in("bench.json");
+        neat::NeuralNet::FromStream(in);
+    });
+    report("json (streamed)", "bench.json", json_store, json_load);
+
+    for(auto precision : {neat::WeightPrecision::FLOAT64, neat::WeightPrecision::FLOAT32})
+    {
+        auto store = average_ms(repetitions, [&]() { neat::serialize_binary_to_file("bench.nnet", nn, precision); });
+        auto load = average_ms(repetitions, [&]() { neat::deserialize_binary_from_file("bench.nnet"); });
+        report(precision == neat::WeightPrecision::FLOAT64 ? "binary (f64)" : "binary (f32)", "bench.nnet", store, load);
+    }
+
+    std::remove("bench.json");
+    std::remove("bench.nnet");
+    return 0;
+}
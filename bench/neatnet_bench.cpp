@@ -0,0 +1,325 @@
+/**
+ * Microbenchmarks of the hot paths of the library. Every benchmark restarts
+ * the random engine from the same seed, so two runs measure the same work.
+ *
+ * Prints one json object per line: first the settings of the run, then per
+ * benchmark its name, the number of operations per sample, the number of
+ * samples and minimum, median and mean nanoseconds per operation.
+ *
+ * Usage: neatnet_bench [name filter] [samples]
+ */
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "genalg.h"
+#include "genome.h"
+#include "innovation.h"
+#include "json.hpp"
+#include "phenotype.h"
+#include "serialize.h"
+#include "utils.h"
+
+
+const long long SEED = 42;
+
+std::string g_filter;
+std::size_t g_samples = 15;
+
+
+struct Timing
+{
+    std::vector<double> NsPerOp;
+
+    void Add(std::chrono::steady_clock::duration elapsed, std::size_t num_ops)
+    {
+        NsPerOp.push_back(std::chrono::duration<double, std::nano>(elapsed).count() / num_ops);
+    }
+};
+
+
+void report(const std::string& name, std::size_t batch, Timing& timing)
+{
+    auto& values = timing.NsPerOp;
+    std::sort(values.begin(), values.end());
+    double total = 0.0;
+    for(double value : values)
+    {
+        total += value;
+    }
+
+    nlohmann::json result = {
+        {"benchmark", name},
+        {"batch", batch},
+        {"samples", values.size()},
+        {"ns_min", values.front()},
+        {"ns_median", values[values.size() / 2]},
+        {"ns_mean", total / values.size()}
+    };
+    std::cout << result.dump() << std::endl;
+}
+
+
+bool selected(const std::string& name)
+{
+    return name.find(g_filter) != std::string::npos;
+}
+
+
+/**
+ * Runs setup once, then times batches of func. Setup has to return the state
+ * func works on, so every benchmark starts from the same state.
+ */
+template<typename TState>
+void bench(const std::string& name,
+           std::size_t batch,
+           const std::function<TState()>& setup,
+           const std::function<void(TState&)>& func)
+{
+    if(!selected(name))
+    {
+        return;
+    }
+
+    Utils::DefaultRandom::Instance().Seed(SEED);
+    TState state = setup();
+
+    // warm up caches and the allocator
+    func(state);
+
+    Timing timing;
+    for(std::size_t sample = 0; sample < g_samples; ++sample)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for(std::size_t i = 0; i < batch; ++i)
+        {
+            func(state);
+        }
+        timing.Add(std::chrono::steady_clock::now() - start, batch);
+    }
+    report(name, batch, timing);
+}
+
+
+struct Evolved
+{
+    neat::Params Parameters;
+    neat::InnovationDB Innovations;
+    neat::Genome Mom;
+    neat::Genome Dad;
+};
+
+
+neat::Genome grow_genome(std::size_t num_inputs,
+                         std::size_t num_outputs,
+                         std::size_t num_hidden,
+                         double recurrent_prob,
+                         neat::Params* params,
+                         neat::InnovationDB& inno_db)
+{
+    neat::Genome g(1, num_inputs, num_outputs, params);
+    inno_db = neat::InnovationDB(g.NeuronGenes(), g.NeuronLinks());
+    while(g.NumHiddenNeurons() < num_hidden)
+    {
+        g.AddNeuron(1.0, inno_db, 100);
+        g.AddLink(1.0, recurrent_prob, inno_db, 100, 100);
+        g.AddLink(1.0, recurrent_prob, inno_db, 100, 100);
+    }
+    g.SortLinks();
+    return g;
+}
+
+
+// two genomes sharing most of their history, like members of one species
+std::unique_ptr<Evolved> evolve_parents(std::size_t num_hidden)
+{
+    auto e = std::make_unique<Evolved>();
+    e->Mom = grow_genome(16, 4, num_hidden, 0.0, &e->Parameters, e->Innovations);
+    e->Dad = e->Mom;
+    e->Dad.SetID(2);
+    for(std::size_t i = 0; i < num_hidden / 4 + 1; ++i)
+    {
+        e->Mom.AddNeuron(1.0, e->Innovations, 100);
+        e->Dad.AddLink(1.0, 0.0, e->Innovations, 100, 100);
+    }
+    e->Mom.MutateWeights(0.5, 0.1, 0.5);
+    e->Dad.MutateWeights(0.5, 0.1, 0.5);
+    e->Mom.SortLinks();
+    e->Dad.SortLinks();
+    e->Mom.SetFitness(2.0);
+    e->Dad.SetFitness(1.0);
+    return e;
+}
+
+
+std::vector<double> xor_scores(const std::vector<neat::SNeuralNetPtr>& brains)
+{
+    std::vector<double> scores;
+    scores.reserve(brains.size());
+    for(auto& brain : brains)
+    {
+        double error = 0.0;
+        error += brain->Update({0, 0}, neat::UPDATE_TYPE::SNAPSHOT)[0];
+        error += 1 - brain->Update({0, 1}, neat::UPDATE_TYPE::SNAPSHOT)[0];
+        error += 1 - brain->Update({1, 0}, neat::UPDATE_TYPE::SNAPSHOT)[0];
+        error += brain->Update({1, 1}, neat::UPDATE_TYPE::SNAPSHOT)[0];
+        scores.push_back(4 - error);
+    }
+    return scores;
+}
+
+
+// Epoch is timed alone, scoring the networks is not part of the sample
+void bench_epoch(std::size_t population_size, std::size_t num_generations)
+{
+    std::string name = "epoch/" + std::to_string(population_size);
+    if(!selected(name))
+    {
+        return;
+    }
+
+    Utils::DefaultRandom::Instance().Seed(SEED);
+    auto p = neat::Params::FromString(R"({"ChanceAddNeuron": 0.1, "ChanceAddLink": 0.3, "PopulationSize": )"
+                                      + std::to_string(population_size) + "}");
+
+    Timing timing;
+    for(std::size_t sample = 0; sample < std::max<std::size_t>(g_samples / 5, 1); ++sample)
+    {
+        neat::GenAlg ga(2, 1, p);
+        auto brains = ga.CreateNeuralNetworks();
+        std::chrono::steady_clock::duration elapsed{};
+        for(std::size_t gen = 0; gen < num_generations; ++gen)
+        {
+            auto scores = xor_scores(brains);
+            auto start = std::chrono::steady_clock::now();
+            brains = ga.Epoch(scores);
+            elapsed += std::chrono::steady_clock::now() - start;
+        }
+        timing.Add(elapsed, num_generations);
+    }
+    report(name, num_generations, timing);
+}
+
+
+int main(int argc, char** argv)
+{
+    g_filter = argc > 1 ? argv[1] : "";
+    g_samples = argc > 2 ? std::stoul(argv[2]) : g_samples;
+
+    std::cout << nlohmann::json({{"suite", "neatnet_bench"}, {"seed", SEED}, {"samples", g_samples}}).dump() << std::endl;
+
+    typedef std::unique_ptr<Evolved> Parents;
+    typedef std::shared_ptr<neat::NeuralNet> Net;
+
+    for(std::size_t num_hidden : {10, 100, 1000})
+    {
+        for(bool recurrent : {false, true})
+        {
+            std::string kind = recurrent ? "recurrent" : "feedforward";
+            bench<Net>("update/" + kind + "/" + std::to_string(num_hidden), 1000 / (num_hidden / 10),
+                [=]()
+                {
+                    neat::Params p;
+                    neat::InnovationDB inno_db;
+                    auto g = grow_genome(16, 4, num_hidden, recurrent ? 0.3 : 0.0, &p, inno_db);
+                    return std::make_shared<neat::NeuralNet>(g);
+                },
+                [](Net& nn)
+                {
+                    nn->Update(std::vector<double>(16, 0.5), neat::UPDATE_TYPE::ACTIVE);
+                });
+        }
+    }
+
+    for(std::size_t num_hidden : {10, 100})
+    {
+        auto size = "/" + std::to_string(num_hidden);
+        bench<Parents>("genome/difference_score" + size, 1000,
+            [=]() { return evolve_parents(num_hidden); },
+            [](Parents& e) { e->Mom.CalculateDifferenceScore(e->Dad); });
+
+        bench<Parents>("genome/crossover" + size, 200,
+            [=]() { return evolve_parents(num_hidden); },
+            [](Parents& e) { e->Mom.Crossover(e->Dad, e->Innovations, 3); });
+
+        bench<Parents>("genome/copy" + size, 1000,
+            [=]() { return evolve_parents(num_hidden); },
+            [](Parents& e) { neat::Genome copy(e->Mom); });
+
+        bench<Parents>("mutate/weights" + size, 1000,
+            [=]() { return evolve_parents(num_hidden); },
+            [](Parents& e) { e->Mom.MutateWeights(0.2, 0.1, 0.5); });
+
+        bench<Parents>("mutate/activation_response" + size, 1000,
+            [=]() { return evolve_parents(num_hidden); },
+            [](Parents& e) { e->Mom.MutateActivationResponse(0.2, 0.1); });
+
+        // structural mutations work on a copy, compare with genome/copy
+        bench<Parents>("mutate/add_neuron" + size, 200,
+            [=]() { return evolve_parents(num_hidden); },
+            [](Parents& e)
+            {
+                neat::Genome child(e->Mom);
+                child.AddNeuron(1.0, e->Innovations, 20);
+            });
+
+        bench<Parents>("mutate/add_link" + size, 200,
+            [=]() { return evolve_parents(num_hidden); },
+            [](Parents& e)
+            {
+                neat::Genome child(e->Mom);
+                child.AddLink(1.0, 0.2, e->Innovations, 20, 20);
+            });
+
+        bench<Parents>("innovation/lookup" + size, 1000,
+            [=]() { return evolve_parents(num_hidden); },
+            [](Parents& e)
+            {
+                auto& link = e->Mom.NeuronLinks()[e->Mom.NumLinks() / 2];
+                e->Innovations.GetInnovationId(link.FromNeuronID, link.ToNeuronID, neat::InnovationType::NEW_LINK);
+            });
+
+        bench<Parents>("phenotype/construct" + size, 200,
+            [=]() { return evolve_parents(num_hidden); },
+            [](Parents& e) { neat::NeuralNet nn(e->Mom); });
+
+        bench<Net>("json/serialize" + size, 20,
+            [=]() { return std::make_shared<neat::NeuralNet>(evolve_parents(num_hidden)->Mom); },
+            [](Net& nn) { nn->serialize().dump(); });
+
+        bench<Net>("json/serialize_stream" + size, 20,
+            [=]() { return std::make_shared<neat::NeuralNet>(evolve_parents(num_hidden)->Mom); },
+            [](Net& nn)
+            {
+                std::ostringstream out;
+                neat::serialize_to_stream(out, *nn, false);
+            });
+
+        bench<std::string>("json/deserialize" + size, 20,
+            [=]() { return neat::NeuralNet(evolve_parents(num_hidden)->Mom).serialize().dump(); },
+            [](std::string& text)
+            {
+                auto object = nlohmann::json::parse(text);
+                neat::NeuralNet nn(object);
+            });
+
+        bench<std::string>("json/deserialize_stream" + size, 20,
+            [=]() { return neat::NeuralNet(evolve_parents(num_hidden)->Mom).serialize().dump(); },
+            [](std::string& text)
+            {
+                std::istringstream in(text);
+                neat::NeuralNet::FromStream(in);
+            });
+    }
+
+    bench_epoch(150, 20);
+    bench_epoch(1000, 10);
+    bench_epoch(10000, 3);
+
+    return 0;
+}
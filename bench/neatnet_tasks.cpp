@@ -0,0 +1,396 @@
+/**
+ * Time to solution on standard NEAT tasks. Every task is evolved from a
+ * number of seeds, several seeds at a time, and the generations, network
+ * evaluations and seconds it took to find a solution are summarized as
+ * median and 90th percentile over the runs that found one.
+ *
+ *   xor            2 inputs, all four cases on the right side of 0.5
+ *   parity4/6      n-bit parity, every pattern on the right side of 0.5
+ *   pole1          single pole on a cart with velocities as inputs
+ *   pole1_novel    the same without velocities, needs recurrent links
+ *   pole2          two poles of different length on one cart
+ *   pole2_novel    the same without velocities
+ *
+ * A pole task is solved by balancing for POLE_STEPS steps. Prints one json
+ * object per task and line.
+ *
+ * Usage: neatnet_tasks [task filter] [seeds] [max generations] [threads]
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "genalg.h"
+#include "json.hpp"
+#include "utils.h"
+
+
+const std::size_t POLE_STEPS = 100000;
+// neurons are activated in the order of their genes, so a hidden neuron added
+// late reaches the outputs only after a few updates
+const std::size_t ROUNDS = 5;
+
+
+struct Outcome
+{
+    double Fitness;
+    bool Solved;
+};
+
+
+struct Task
+{
+    std::string Name;
+    std::size_t NumInputs;
+    std::size_t NumOutputs;
+    // overrides of the default parameters below
+    nlohmann::json Parameters;
+    std::function<Outcome(neat::SNeuralNetPtr)> Evaluate;
+};
+
+
+struct Run
+{
+    bool Solved;
+    std::size_t Generations;
+    std::size_t Evaluations;
+    double Seconds;
+};
+
+
+const char* DEFAULT_PARAMS = R"({
+    "ActivationMutationRate": 0.1,
+    "ChanceAddLink": 0.07,
+    "ChanceAddNeuron": 0.1,
+    "ChanceAddRecurrentLink": 0.05,
+    "CompatibilityThreshold": 0.26,
+    "CrossoverRate": 0.7,
+    "DisjointScaler": 0.4,
+    "ExcessScaler": 0.4,
+    "MatchScaler": 0.4,
+    "MaxActivationPerturbation": 0.1,
+    "MaxPermittedNeurons": 100,
+    "MaxWeightPerturbation": 0.5,
+    "MutationProbability": 0.2,
+    "NumAddLinkAttempts": 5,
+    "NumAddRecurLinkAttempts": 5,
+    "NumBestGenomes": 4,
+    "NumFindOldLinkAttempts": 5,
+    "NumGensAllowedNoImprovement": 15,
+    "OldAgePenalty": 0.7,
+    "OldAgeThreshold": 50,
+    "PopulationSize": 50,
+    "SurvivalRate": 0.2,
+    "WeightReplacedProbability": 0.1,
+    "YoungBonusAgeThreshhold": 10,
+    "YoungFitnessBonus": 1.3
+})";
+
+
+// scored like test_xor: the patterns are presented in ROUNDS passes of active
+// updates, and the last pass decides whether the task is solved
+Outcome parity(neat::SNeuralNetPtr brain, std::size_t num_bits)
+{
+    std::size_t num_patterns = std::size_t(1) << num_bits;
+    double fitness = 0.0;
+    bool solved = false;
+    std::vector<double> inputs(num_bits);
+    for(std::size_t round = 0; round < ROUNDS; ++round)
+    {
+        double error = 0.0;
+        solved = true;
+        for(std::size_t pattern = 0; pattern < num_patterns; ++pattern)
+        {
+            std::size_t num_ones = 0;
+            for(std::size_t bit = 0; bit < num_bits; ++bit)
+            {
+                inputs[bit] = (pattern >> bit) & 1;
+                num_ones += (pattern >> bit) & 1;
+            }
+            double output = brain->Update(inputs, neat::UPDATE_TYPE::ACTIVE)[0];
+            double distance = std::fabs(double(num_ones % 2) - output);
+            error += distance;
+            solved = solved && distance < 0.5;
+        }
+        fitness += std::pow(num_patterns - error, 2);
+    }
+    return Outcome{fitness, solved};
+}
+
+
+/**
+ * Cart with one or two hinged poles, integrated with Runge-Kutta as in
+ * Wieland's double pole benchmark.
+ */
+class CartPole
+{
+private:
+    static constexpr double GRAVITY = -9.8;
+    static constexpr double CART_MASS = 1.0;
+    static constexpr double FORCE = 10.0;
+    static constexpr double FRICTION = 0.000002;
+    static constexpr double TIME_STEP = 0.01;
+    static constexpr double TRACK_LIMIT = 2.4;
+
+    std::size_t m_num_poles;
+    // half lengths and masses
+    double m_length[2] = {0.5, 0.05};
+    double m_mass[2] = {0.1, 0.01};
+    double m_angle_limit;
+    // x, x', angle 1, angle 1', angle 2, angle 2'
+    double m_state[6] = {0, 0, 0.07, 0, 0, 0};
+
+    void Derivatives(const double* state, double force, double* derivs) const
+    {
+        double total_force = force;
+        double total_mass = CART_MASS;
+        double angle_acc[2] = {0, 0};
+        for(std::size_t p = 0; p < m_num_poles; ++p)
+        {
+            double angle = state[2 + 2 * p];
+            double velocity = state[3 + 2 * p];
+            double cos_angle = std::cos(angle);
+            double g_sin_angle = GRAVITY * std::sin(angle);
+            double ml = m_length[p] * m_mass[p];
+            double temp = FRICTION * velocity / ml;
+            total_force += ml * velocity * velocity * std::sin(angle) +
+                           0.75 * m_mass[p] * cos_angle * (temp + g_sin_angle);
+            total_mass += m_mass[p] * (1 - 0.75 * cos_angle * cos_angle);
+            angle_acc[p] = g_sin_angle + temp;
+        }
+
+        double cart_acc = total_force / total_mass;
+        derivs[0] = state[1];
+        derivs[1] = cart_acc;
+        for(std::size_t p = 0; p < 2; ++p)
+        {
+            double cos_angle = std::cos(state[2 + 2 * p]);
+            derivs[2 + 2 * p] = state[3 + 2 * p];
+            derivs[3 + 2 * p] = p < m_num_poles ? -0.75 * (cart_acc * cos_angle + angle_acc[p]) / m_length[p] : 0;
+        }
+    }
+
+    void RungeKutta(double force)
+    {
+        double k1[6], k2[6], k3[6], k4[6], tmp[6];
+        Derivatives(m_state, force, k1);
+        for(int i = 0; i < 6; ++i) tmp[i] = m_state[i] + 0.5 * TIME_STEP * k1[i];
+        Derivatives(tmp, force, k2);
+        for(int i = 0; i < 6; ++i) tmp[i] = m_state[i] + 0.5 * TIME_STEP * k2[i];
+        Derivatives(tmp, force, k3);
+        for(int i = 0; i < 6; ++i) tmp[i] = m_state[i] + TIME_STEP * k3[i];
+        Derivatives(tmp, force, k4);
+        for(int i = 0; i < 6; ++i)
+        {
+            m_state[i] += TIME_STEP / 6 * (k1[i] + 2 * k2[i] + 2 * k3[i] + k4[i]);
+        }
+    }
+
+public:
+    CartPole(std::size_t num_poles): m_num_poles(num_poles),
+                                     m_angle_limit(num_poles == 1 ? 0.2094384 : 0.628329)
+    {}
+
+    std::vector<double> Observe(bool velocities) const
+    {
+        std::vector<double> inputs{m_state[0] / TRACK_LIMIT};
+        if(velocities)
+        {
+            inputs.push_back(m_state[1] / 10);
+        }
+        for(std::size_t p = 0; p < m_num_poles; ++p)
+        {
+            inputs.push_back(m_state[2 + 2 * p] / m_angle_limit);
+            if(velocities)
+            {
+                inputs.push_back(m_state[3 + 2 * p] / 5);
+            }
+        }
+        return inputs;
+    }
+
+    // network output in [0, 1] pushes the cart left to right
+    void Step(double action)
+    {
+        double force = (2 * action - 1) * FORCE;
+        // two integration steps per decision
+        RungeKutta(force);
+        RungeKutta(force);
+    }
+
+    bool Failed() const
+    {
+        if(std::fabs(m_state[0]) > TRACK_LIMIT)
+        {
+            return true;
+        }
+        for(std::size_t p = 0; p < m_num_poles; ++p)
+        {
+            if(std::fabs(m_state[2 + 2 * p]) > m_angle_limit)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+};
+
+
+Outcome balance(neat::SNeuralNetPtr brain, std::size_t num_poles, bool velocities)
+{
+    CartPole cart(num_poles);
+    std::size_t steps = 0;
+    while(steps < POLE_STEPS && !cart.Failed())
+    {
+        cart.Step(brain->Update(cart.Observe(velocities), neat::UPDATE_TYPE::ACTIVE)[0]);
+        ++steps;
+    }
+    return Outcome{static_cast<double>(steps), steps == POLE_STEPS};
+}
+
+
+std::vector<Task> make_tasks()
+{
+    using nlohmann::json;
+    std::vector<Task> tasks;
+
+    tasks.push_back({"xor", 2, 1, json::object(), [](neat::SNeuralNetPtr brain) { return parity(brain, 2); }});
+    tasks.push_back({"parity4", 4, 1, json::object(), [](neat::SNeuralNetPtr brain) { return parity(brain, 4); }});
+    tasks.push_back({"parity6", 6, 1, json::object(), [](neat::SNeuralNetPtr brain) { return parity(brain, 6); }});
+
+    json recurrent = {{"ChanceAddRecurrentLink", 0.2}};
+    for(std::size_t num_poles : {1, 2})
+    {
+        std::string name = "pole" + std::to_string(num_poles);
+        tasks.push_back({name, 2 + 2 * num_poles, 1, json::object(),
+                         [=](neat::SNeuralNetPtr brain) { return balance(brain, num_poles, true); }});
+        tasks.push_back({name + "_novel", 1 + num_poles, 1, recurrent,
+                         [=](neat::SNeuralNetPtr brain) { return balance(brain, num_poles, false); }});
+    }
+    return tasks;
+}
+
+
+Run evolve(const Task& task, long long seed, std::size_t max_generations)
+{
+    Utils::DefaultRandom::Instance().Seed(seed);
+    auto config = nlohmann::json::parse(DEFAULT_PARAMS);
+    config.update(task.Parameters);
+    neat::Params p(config);
+
+    auto start = std::chrono::steady_clock::now();
+    neat::GenAlg ga(task.NumInputs, task.NumOutputs, p);
+    auto brains = ga.CreateNeuralNetworks();
+
+    Run run{false, 0, 0, 0.0};
+    for(; run.Generations < max_generations && !run.Solved; ++run.Generations)
+    {
+        std::vector<double> scores;
+        for(auto& brain : brains)
+        {
+            auto outcome = task.Evaluate(brain);
+            ++run.Evaluations;
+            if(outcome.Solved)
+            {
+                run.Solved = true;
+                break;
+            }
+            scores.push_back(outcome.Fitness);
+        }
+        if(!run.Solved)
+        {
+            brains = ga.Epoch(scores);
+        }
+    }
+    run.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return run;
+}
+
+
+// nearest rank
+template<typename T>
+nlohmann::json percentile(std::vector<T> values, double fraction)
+{
+    if(values.empty())
+    {
+        return nullptr;
+    }
+    std::sort(values.begin(), values.end());
+    std::size_t rank = std::ceil(fraction * values.size());
+    return values[std::max<std::size_t>(rank, 1) - 1];
+}
+
+
+void report(const Task& task, const std::vector<Run>& runs, std::size_t max_generations)
+{
+    std::vector<std::size_t> generations, evaluations;
+    std::vector<double> seconds;
+    for(auto& run : runs)
+    {
+        if(run.Solved)
+        {
+            generations.push_back(run.Generations);
+            evaluations.push_back(run.Evaluations);
+            seconds.push_back(run.Seconds);
+        }
+    }
+
+    nlohmann::json result = {
+        {"task", task.Name},
+        {"seeds", runs.size()},
+        {"solved", generations.size()},
+        {"max_generations", max_generations},
+        {"generations_median", percentile(generations, 0.5)},
+        {"generations_p90", percentile(generations, 0.9)},
+        {"evaluations_median", percentile(evaluations, 0.5)},
+        {"evaluations_p90", percentile(evaluations, 0.9)},
+        {"seconds_median", percentile(seconds, 0.5)},
+        {"seconds_p90", percentile(seconds, 0.9)}
+    };
+    std::cout << result.dump() << std::endl;
+}
+
+
+int main(int argc, char** argv)
+{
+    std::string filter = argc > 1 ? argv[1] : "";
+    std::size_t num_seeds = argc > 2 ? std::stoul(argv[2]) : 10;
+    std::size_t max_generations = argc > 3 ? std::stoul(argv[3]) : 500;
+    std::size_t num_threads = argc > 4 ? std::stoul(argv[4]) : std::max(1u, std::thread::hardware_concurrency());
+
+    for(auto& task : make_tasks())
+    {
+        if(task.Name.find(filter) == std::string::npos)
+        {
+            continue;
+        }
+
+        // GenAlg keeps its random engine per thread, so seeds run side by side
+        std::vector<Run> runs(num_seeds);
+        std::atomic<std::size_t> next_seed(0);
+        std::vector<std::thread> threads;
+        for(std::size_t t = 0; t < std::min(num_threads, num_seeds); ++t)
+        {
+            threads.emplace_back([&]()
+                {
+                    for(auto seed = next_seed++; seed < num_seeds; seed = next_seed++)
+                    {
+                        runs[seed] = evolve(task, 1000 + seed, max_generations);
+                    }
+                });
+        }
+        for(auto& thread : threads)
+        {
+            thread.join();
+        }
+        report(task, runs, max_generations);
+    }
+    return 0;
+}
@@ -0,0 +1,154 @@
+#ifndef __BINARY_H__
+#define __BINARY_H__
+
+/**
+ * Author: Aleksandr Yeganov
+ *
+ * Little-endian encoding of plain values into byte buffers. Used by the
+ * binary file formats and by the evaluation backends that ship networks to
+ * other processes.
+ */
+
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+
+namespace neat
+{
+
+
+class BinaryWriter
+{
+private:
+    std::vector<std::uint8_t>& m_buffer;
+
+public:
+    BinaryWriter(std::vector<std::uint8_t>& buffer): m_buffer(buffer)
+    {}
+
+    template <typename T>
+    void Write(T value)
+    {
+        static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value,
+                      "Only arithmetic and enum values can be written.");
+
+        if constexpr(std::is_enum<T>::value)
+        {
+            Write(static_cast<std::underlying_type_t<T>>(value));
+        }
+        else if constexpr(std::is_same<T, bool>::value)
+        {
+            Write<std::uint8_t>(value ? 1 : 0);
+        }
+        else
+        {
+            using raw_type = std::conditional_t<sizeof(T) == 1, std::uint8_t,
+                             std::conditional_t<sizeof(T) == 2, std::uint16_t,
+                             std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>>>;
+            auto raw = std::bit_cast<raw_type>(value);
+            for(std::size_t i = 0; i < sizeof(T); ++i)
+            {
+                m_buffer.push_back(static_cast<std::uint8_t>(raw >> (8 * i)));
+            }
+        }
+    }
+
+    void Write(const std::string& value)
+    {
+        Write<std::uint32_t>(value.size());
+        m_buffer.insert(m_buffer.end(), value.begin(), value.end());
+    }
+
+    // overwrites a value written earlier, e.g. a size known only at the end
+    template <typename T>
+    void WriteAt(std::size_t offset, T value)
+    {
+        std::vector<std::uint8_t> encoded;
+        BinaryWriter(encoded).Write(value);
+        std::memcpy(m_buffer.data() + offset, encoded.data(), encoded.size());
+    }
+
+    std::size_t Size() const { return m_buffer.size(); }
+};
+
+
+class BinaryReader
+{
+private:
+    const std::uint8_t* m_data;
+    std::size_t m_size;
+    std::size_t m_pos;
+
+    void Require(std::size_t num_bytes)
+    {
+        if(m_size - m_pos < num_bytes)
+        {
+            throw std::runtime_error("BinaryReader: unexpected end of data");
+        }
+    }
+
+public:
+    BinaryReader(const std::uint8_t* data, std::size_t size): m_data(data),
+                                                               m_size(size),
+                                                               m_pos(0)
+    {}
+
+    BinaryReader(const std::vector<std::uint8_t>& buffer): BinaryReader(buffer.data(), buffer.size())
+    {}
+
+    template <typename T>
+    T Read()
+    {
+        static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value,
+                      "Only arithmetic and enum values can be read.");
+
+        if constexpr(std::is_enum<T>::value)
+        {
+            return static_cast<T>(Read<std::underlying_type_t<T>>());
+        }
+        else if constexpr(std::is_same<T, bool>::value)
+        {
+            return Read<std::uint8_t>() != 0;
+        }
+        else
+        {
+            using raw_type = std::conditional_t<sizeof(T) == 1, std::uint8_t,
+                             std::conditional_t<sizeof(T) == 2, std::uint16_t,
+                             std::conditional_t<sizeof(T) == 4, std::uint32_t, std::uint64_t>>>;
+            Require(sizeof(T));
+            raw_type raw = 0;
+            for(std::size_t i = 0; i < sizeof(T); ++i)
+            {
+                raw |= static_cast<raw_type>(m_data[m_pos++]) << (8 * i);
+            }
+            return std::bit_cast<T>(raw);
+        }
+    }
+
+    std::string ReadString()
+    {
+        auto size = Read<std::uint32_t>();
+        Require(size);
+        std::string value(reinterpret_cast<const char*>(m_data + m_pos), size);
+        m_pos += size;
+        return value;
+    }
+
+    void Skip(std::size_t num_bytes)
+    {
+        Require(num_bytes);
+        m_pos += num_bytes;
+    }
+
+    std::size_t Position() const { return m_pos; }
+    std::size_t Remaining() const { return m_size - m_pos; }
+};
+
+
+};
+#endif
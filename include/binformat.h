@@ -0,0 +1,81 @@
+#ifndef __BINFORMAT_H__
+#define __BINFORMAT_H__
+
+/**
+ * Versioned binary file format for NeuralNet, a compact alternative to the
+ * json produced by NeuralNet::serialize. All values are little-endian.
+ *
+ *   header   u32 magic "NNET", u16 version, u8 WeightPrecision, u8 unused,
+ *            u32 neuron count N, u32 link count L
+ *   neurons  N x [u8 NeuronType, i32 id, f64 activation response,
+ *                 f64 split x, f64 split y]
+ *   links    CSR by receiving neuron: u32 offsets[N + 1], then
+ *            u32 source neuron position[L], weight[L] as f32 or f64 and a
+ *            bit set of recurrent flags, ceil(L / 8) bytes
+ *
+ * Every link is stored once and incoming links keep their order, so a
+ * network loaded with double precision weights produces exactly the same
+ * outputs as the one that was saved.
+ */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "binary.h"
+#include "genome.h"
+#include "phenotype.h"
+
+namespace neat
+{
+
+
+const std::uint32_t NET_FORMAT_MAGIC = 0x54454E4E;
+const std::uint16_t NET_FORMAT_VERSION = 1;
+
+
+enum class WeightPrecision : std::uint8_t
+{
+    FLOAT32,
+    FLOAT64
+};
+
+
+/**
+ * Network in the format above, written to or read from the current position
+ * of a larger buffer, e.g. a message to an evaluation worker. Enums are
+ * written as u8 throughout.
+ */
+void encode_net(BinaryWriter& writer, const NeuralNet& nn, WeightPrecision precision=WeightPrecision::FLOAT64);
+NeuralNet decode_net(BinaryReader& reader);
+
+std::vector<std::uint8_t> serialize_binary(const NeuralNet& nn, WeightPrecision precision=WeightPrecision::FLOAT64);
+NeuralNet deserialize_binary(const std::uint8_t* data, std::size_t size);
+NeuralNet deserialize_binary(const std::vector<std::uint8_t>& buffer);
+
+void serialize_binary_to_file(std::string path, const NeuralNet& nn, WeightPrecision precision=WeightPrecision::FLOAT64);
+NeuralNet deserialize_binary_from_file(std::string path);
+
+
+/**
+ * Complete genome including fitness bookkeeping, for the formats that store
+ * populations. A decoded genome uses the given parameters.
+ */
+void encode_genome(BinaryWriter& writer, const Genome& g);
+Genome decode_genome(BinaryReader& reader, Params* params);
+
+// single genes in the layout encode_genome stores them in
+void encode_neuron_gene(BinaryWriter& writer, const NeuronGene& ng);
+NeuronGene decode_neuron_gene(BinaryReader& reader);
+void encode_link_gene(BinaryWriter& writer, const LinkGene& lg);
+LinkGene decode_link_gene(BinaryReader& reader);
+
+// single innovation records and complete databases with their next IDs
+void encode_innovation(BinaryWriter& writer, const Innovation& innov);
+Innovation decode_innovation(BinaryReader& reader);
+void encode_innovations(BinaryWriter& writer, const InnovationDB& inno_db);
+InnovationDB decode_innovations(BinaryReader& reader);
+
+
+};
+#endif
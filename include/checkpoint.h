@@ -0,0 +1,133 @@
+#ifndef __CHECKPOINT_H__
+#define __CHECKPOINT_H__
+
+/**
+ * Checkpoints of a running evolution. GenAlg::Snapshot captures everything
+ * GenAlg needs to continue between two generations and GenAlg(state) picks
+ * it up again, so a resumed run produces exactly the generations the
+ * original run would have.
+ *
+ * The file is little-endian: u32 magic "NCKP", u16 version, u16 unused,
+ * followed by the fields of GenAlgState in declaration order.
+ */
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "genome.h"
+#include "innovation.h"
+#include "params.h"
+#include "utils.h"
+
+namespace neat
+{
+
+
+const std::uint32_t CHECKPOINT_MAGIC = 0x504B434E;
+const std::uint16_t CHECKPOINT_VERSION = 1;
+
+
+struct SpeciesState
+{
+    Genome Leader;
+    SpeciesID ID;
+    std::size_t GensNoImprovement;
+    std::size_t Age;
+    double SpawnsRequired;
+};
+
+
+struct GenAlgState
+{
+    Params Parameters;
+    std::size_t Generation;
+    GenomeID NextGenomeID;
+    SpeciesID NextSpeciesID;
+    double BestEverFitness;
+    std::vector<Genome> Genomes;
+    std::vector<Genome> BestGenomes;
+    std::vector<SpeciesState> Species;
+    InnovationDB Innovations;
+    Utils::RunningStat::State NumSpeciesStat;
+    Utils::RunningStat::State GenomeLinksStat;
+    Utils::RunningStat::State GenomeNeuronStat;
+    Utils::RunningStat::State FitnessStat;
+    // state of the random engine of the thread running the evolution
+    std::string RandomState;
+};
+
+
+std::vector<std::uint8_t> encode_checkpoint(const GenAlgState& state);
+GenAlgState decode_checkpoint(const std::uint8_t* data, std::size_t size);
+
+/**
+ * Writes to a temporary file next to path and renames it, so a crash while
+ * writing leaves the previous checkpoint intact.
+ */
+void write_checkpoint(const std::string& path, const GenAlgState& state);
+GenAlgState read_checkpoint(const std::string& path);
+
+
+/**
+ * Append-only log of checkpoints. The first write and every full_interval-th
+ * write after it replace the log with a full snapshot, all others append a
+ * delta against the previously written state. Genomes kept from that state
+ * (species leaders, best genomes) are stored as their ID and fitness values,
+ * offspring as the ID of their parent and the edits that turn the genes of
+ * the parent into their own - runs of unchanged genes, genes with a new
+ * weight or activation response and new genes. Genomes without a parent in
+ * the previous state, the species and the innovations added since are
+ * stored in full.
+ *
+ * Every offspring still costs an entry with its IDs and fitness values, it
+ * is the size of its genes that follows the number of changes. A delta
+ * saves bytes, not copying: GenAlg::Snapshot copies the whole population and
+ * the log keeps a copy of the last written state to compare against.
+ *
+ * The log starts with u32 magic "NCKL" and u16 version, followed by records
+ * of [u8 kind][u64 payload size][payload]. A full record holds the output of
+ * encode_checkpoint. A record cut short by a crash is ignored on reading.
+ */
+class CheckpointLog
+{
+private:
+    std::string m_path;
+    std::size_t m_full_interval;
+    std::size_t m_num_deltas;
+    std::size_t m_last_write_size;
+    // what the next delta is written against
+    std::unordered_map<int, Genome> m_written_genomes;
+    std::size_t m_num_written_innovations;
+
+    void WriteFull(const GenAlgState& state);
+    void WriteDelta(const GenAlgState& state);
+    void Remember(const GenAlgState& state);
+
+public:
+    /**
+     * @param path - file of the log, an existing log is replaced by the
+     *               first write
+     * @param full_interval - number of deltas between two full snapshots
+     */
+    CheckpointLog(const std::string& path, std::size_t full_interval);
+
+    void Write(const GenAlgState& state);
+
+    // deltas written since the last full snapshot
+    std::size_t NumDeltas() const { return m_num_deltas; }
+    // bytes written by the last call to Write
+    std::size_t LastWriteSize() const { return m_last_write_size; }
+};
+
+
+// replays the last full snapshot of a log and every delta after it
+GenAlgState read_checkpoint_log(const std::string& path);
+
+// folds all records of a log into a single full snapshot
+void compact_checkpoint_log(const std::string& path);
+
+
+};
+#endif
@@ -0,0 +1,119 @@
+#ifndef __DISTRIBUTED_H__
+#define __DISTRIBUTED_H__
+
+/**
+ * Evaluation by worker processes connected over a socket. The coordinator
+ * lives next to GenAlg and hands out networks, workers send back fitness.
+ *
+ * Addresses are either "unix:<path>" for a Unix-domain socket or
+ * "tcp:<ipv4 address>:<port>"; port 0 picks a free port.
+ *
+ * Every message is framed as [u32 payload size][u8 MessageType][payload],
+ * little-endian:
+ *   HELLO    worker -> coordinator  u32 protocol version
+ *   JOB      coordinator -> worker  u64 job id, network in the binary format (binformat.h)
+ *   RESULT   worker -> coordinator  u64 job id, f64 fitness
+ *   SHUTDOWN coordinator -> worker  empty
+ */
+
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "evaluate.h"
+
+namespace neat
+{
+
+
+const std::uint32_t PROTOCOL_VERSION = 2;
+const std::chrono::milliseconds DEFAULT_WORKER_TIMEOUT = std::chrono::seconds(60);
+
+
+enum class MessageType : std::uint8_t
+{
+    HELLO,
+    JOB,
+    RESULT,
+    SHUTDOWN
+};
+
+
+class DistributedEvaluator : public IEvaluator
+{
+private:
+    struct Connection
+    {
+        int Fd;
+        bool Greeted;
+        std::vector<std::uint8_t> Received;
+        // job ids sent to the worker and not answered yet
+        std::deque<std::uint64_t> Outstanding;
+    };
+
+    int m_listen_fd;
+    std::string m_address;
+    std::string m_unix_path;
+    std::vector<Connection> m_workers;
+    std::chrono::milliseconds m_worker_timeout;
+    std::size_t m_num_requeued;
+    // job ids keep counting across calls to Evaluate
+    std::uint64_t m_next_job_id;
+
+    // gets the job id and fitness of every result
+    typedef std::function<void(std::uint64_t, double)> ResultReport;
+
+    void Accept();
+    bool Receive(Connection& worker, const ResultReport& report);
+    bool SendJob(Connection& worker, std::uint64_t job_id, const NeuralNet& brain);
+    std::size_t NumGreeted() const;
+
+public:
+    /**
+     * @param worker_timeout - how long Evaluate waits while no worker is
+     *                         connected before it gives up
+     */
+    DistributedEvaluator(const std::string& address,
+                         std::chrono::milliseconds worker_timeout = DEFAULT_WORKER_TIMEOUT);
+    ~DistributedEvaluator();
+
+    DistributedEvaluator(const DistributedEvaluator&) = delete;
+    DistributedEvaluator& operator=(const DistributedEvaluator&) = delete;
+
+    /**
+     * Hands the networks out to connected workers, including ones that
+     * connect while the evaluation runs. Work of a worker that disconnects
+     * goes to the others. Blocks until every network has been scored, or
+     * throws std::runtime_error once no worker has been connected for the
+     * worker timeout. If report throws, results of the networks still out
+     * are dropped when they arrive, so the evaluator can be used again.
+     */
+    void Evaluate(const std::vector<SNeuralNetPtr>& brains, const FitnessReport& report) override;
+
+    /**
+     * Accepts connections until num_workers workers said hello or the
+     * timeout expires. Returns the number of workers ready for work.
+     */
+    std::size_t WaitForWorkers(std::size_t num_workers, std::chrono::milliseconds timeout);
+
+    // address workers connect to, with the actual port for "tcp:...:0"
+    const std::string& Address() const { return m_address; }
+    std::size_t NumWorkers() const { return NumGreeted(); }
+    // number of jobs that were handed out again after a worker disconnected
+    std::size_t NumRequeued() const { return m_num_requeued; }
+};
+
+
+/**
+ * Connects to a coordinator and evaluates the networks it sends until it
+ * shuts the worker down or closes the connection.
+ * @return number of networks evaluated
+ */
+std::size_t run_worker(const std::string& address, const FitnessFunc& fitness);
+
+
+};
+#endif
@@ -0,0 +1,100 @@
+#ifndef __EVALUATE_H__
+#define __EVALUATE_H__
+
+/**
+ * Evaluation drivers that score a whole population of phenotypes and report
+ * each fitness as soon as it is known.
+ */
+
+#include <chrono>
+#include <functional>
+#include <future>
+#include <stop_token>
+#include <vector>
+
+#include "phenotype.h"
+
+namespace neat
+{
+
+
+typedef std::function<double(SNeuralNetPtr)> FitnessFunc;
+
+/**
+ * Fitness function that returns right away with a future of the fitness. The
+ * stop token is signalled when the evaluation ran out of its time budget, so
+ * long running simulations can bail out early.
+ */
+typedef std::function<std::future<double>(SNeuralNetPtr, std::stop_token)> AsyncFitnessFunc;
+
+/**
+ * Receives the index of a network within the evaluated batch and its fitness.
+ * Evaluators never call it concurrently.
+ */
+typedef std::function<void(std::size_t, double)> FitnessReport;
+
+
+class IEvaluator
+{
+public:
+    virtual ~IEvaluator() {}
+
+    /**
+     * Scores every network in brains, returning once all of them have been
+     * reported.
+     */
+    virtual void Evaluate(const std::vector<SNeuralNetPtr>& brains, const FitnessReport& report) = 0;
+};
+
+
+/**
+ * Runs a synchronous fitness function on a fixed number of threads.
+ */
+class ThreadPoolEvaluator : public IEvaluator
+{
+private:
+    FitnessFunc m_fitness;
+    std::size_t m_num_threads;
+
+public:
+    ThreadPoolEvaluator(FitnessFunc fitness, std::size_t num_threads);
+
+    void Evaluate(const std::vector<SNeuralNetPtr>& brains, const FitnessReport& report) override;
+
+    std::size_t NumThreads() const { return m_num_threads; }
+};
+
+
+/**
+ * Dispatches every network to an asynchronous fitness function, keeping at
+ * most max_in_flight evaluations outstanding. An evaluation that doesn't
+ * finish within its time budget gets the penalty fitness; its future is
+ * abandoned rather than cancelled, so the callback should honour the stop
+ * token. Deferred futures are run on a thread of their own so the time budget
+ * applies to them too. If a future or the report throws, every evaluation
+ * still in flight is told to stop before the exception is passed on.
+ */
+class AsyncEvaluator : public IEvaluator
+{
+private:
+    AsyncFitnessFunc m_fitness;
+    std::size_t m_max_in_flight;
+    std::chrono::milliseconds m_timeout;
+    double m_penalty;
+    std::size_t m_num_timeouts;
+
+public:
+    AsyncEvaluator(AsyncFitnessFunc fitness,
+                   std::size_t max_in_flight,
+                   std::chrono::milliseconds timeout,
+                   double penalty = 0.0);
+
+    void Evaluate(const std::vector<SNeuralNetPtr>& brains, const FitnessReport& report) override;
+
+    // total number of evaluations that ran out of time
+    std::size_t NumTimeouts() const { return m_num_timeouts; }
+};
+
+
+};
+#endif
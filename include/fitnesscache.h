@@ -0,0 +1,107 @@
+#ifndef __FITNESSCACHE_H__
+#define __FITNESSCACHE_H__
+
+/**
+ * Fitness of recently evaluated genomes keyed by Genome::Fingerprint, so exact
+ * copies of a genome, e.g. species leaders carried over to the next
+ * generation, don't have to be evaluated again. Only worth it when the
+ * fitness function is deterministic.
+ */
+
+#include <cstdint>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+namespace neat
+{
+
+
+/**
+ * Keeps at most Capacity() fingerprints, evicting the least recently used
+ * one. A capacity of 0 disables the cache.
+ */
+class FitnessCache
+{
+private:
+    typedef std::pair<std::uint64_t, double> Entry;
+
+    std::size_t m_capacity;
+    // most recently used first
+    std::list<Entry> m_entries;
+    std::unordered_map<std::uint64_t, std::list<Entry>::iterator> m_index;
+    std::size_t m_num_hits;
+    std::size_t m_num_lookups;
+
+public:
+    explicit FitnessCache(std::size_t capacity = 0): m_capacity(capacity),
+                                                     m_entries(),
+                                                     m_index(),
+                                                     m_num_hits(0),
+                                                     m_num_lookups(0)
+    {}
+
+    /**
+     * Sets fitness to the remembered fitness of the fingerprint.
+     * @returns false if the fingerprint is not in the cache
+     */
+    bool Find(std::uint64_t fingerprint, double& fitness)
+    {
+        if(m_capacity == 0)
+        {
+            return false;
+        }
+
+        ++m_num_lookups;
+        auto found = m_index.find(fingerprint);
+        if(found == m_index.end())
+        {
+            return false;
+        }
+        m_entries.splice(m_entries.begin(), m_entries, found->second);
+        fitness = found->second->second;
+        ++m_num_hits;
+        return true;
+    }
+
+    void Insert(std::uint64_t fingerprint, double fitness)
+    {
+        if(m_capacity == 0)
+        {
+            return;
+        }
+
+        auto found = m_index.find(fingerprint);
+        if(found != m_index.end())
+        {
+            found->second->second = fitness;
+            m_entries.splice(m_entries.begin(), m_entries, found->second);
+            return;
+        }
+
+        if(m_entries.size() == m_capacity)
+        {
+            m_index.erase(m_entries.back().first);
+            m_entries.pop_back();
+        }
+        m_entries.emplace_front(fingerprint, fitness);
+        m_index[fingerprint] = m_entries.begin();
+    }
+
+    void Clear()
+    {
+        m_entries.clear();
+        m_index.clear();
+    }
+
+    std::size_t Capacity() const { return m_capacity; }
+    std::size_t Size() const { return m_entries.size(); }
+    bool IsEnabled() const { return m_capacity > 0; }
+
+    std::size_t NumHits() const { return m_num_hits; }
+    std::size_t NumLookups() const { return m_num_lookups; }
+};
+
+
+};
+#endif
@@ -1,13 +1,21 @@
 #ifndef __GENALG_H__
 #define __GENALG_H__
 
+#include <future>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
 #include <vector>
 
+#include "checkpoint.h"
+#include "evaluate.h"
+#include "fitnesscache.h"
 #include "genes.h"
 #include "genome.h"
 #include "species.h"
 #include "innovation.h"
 #include "phenotype.h"
+#include "profile.h"
 #include "utils.h"
 #include "params.h"
 
@@ -19,7 +27,7 @@ class GenAlg
 {
 private:
     std::vector<Genome> m_genomes;
-    InnovationDB m_inno_db;
+    std::shared_ptr<InnovationDB> m_inno_db;
 
     std::size_t m_generation_count;
     GenomeID m_next_genome_id;
@@ -32,11 +40,23 @@ private:
     Utils::RunningStat m_num_species_stat;
     Utils::RunningStat m_genome_links_stat;
     Utils::RunningStat m_genome_neuron_stat;
+    Utils::RunningStat m_fitness_stat;
+    EpochProfile m_profile;
+    FitnessCache m_fitness_cache;
 
+    // bookkeeping for scores reported one genome at a time via SubmitFitness
+    std::unordered_map<int, std::size_t> m_genome_index;
+    std::vector<bool> m_scored;
+    std::size_t m_num_scored;
+    std::mutex m_submit_mutex;
+
+    void IndexGenomes();
     void PurgeSpecies();
     void UpdateGenomeScores(const std::vector<double>& fitness_scores);
     void UpdateBestGenomes();
     void SpeciateGenomes();
+    void SpeciateGenome(std::size_t idx);
+    void PartitionSpecies();
     void UpdateSpeciesFitness();
     void CalculateSpeciesSpawnAmounts();
     std::vector<Genome> CreateNewPopulation();
@@ -45,6 +65,7 @@ private:
 
     void RunEpochStatistics();
     void RunLongTermStatistics();
+    std::vector<SNeuralNetPtr> FinishEpoch();
 
 public:
     GenAlg(std::size_t num_inputs,
@@ -54,17 +75,120 @@ public:
            std::size_t num_outputs,
            const Params& params);
 
+    /**
+     * Creates a population that records its innovations in a database shared
+     * with other populations, e.g. islands evolving on other threads.
+     */
+    GenAlg(std::size_t num_inputs,
+           std::size_t num_outputs,
+           const Params& params,
+           std::shared_ptr<InnovationDB> inno_db);
+
+    /**
+     * Starts a population from previously evolved genomes, e.g. ones loaded
+     * from a GenomeArchive, and the innovation database they were evolved
+     * with. The seeds are copied in turn until the population is full; the
+     * copies keep their genes but get new IDs and no fitness.
+     */
+    GenAlg(const std::vector<Genome>& seeds,
+           const Params& params,
+           const InnovationDB& inno_db);
+
+    /**
+     * Continues an evolution from a snapshot, e.g. one loaded with
+     * read_checkpoint. Restores the random engine of the calling thread too.
+     */
+    explicit GenAlg(const GenAlgState& state);
+
+    // innovation database that knows the genes of a minimal genome
+    static std::shared_ptr<InnovationDB> CreateInnovationDB(std::size_t num_inputs,
+                                                            std::size_t num_outputs,
+                                                            const Params& params);
+
     std::vector<SNeuralNetPtr> Epoch(const std::vector<double>& fitness_scores);
+
+    /**
+     * Records the fitness of a single genome of the current generation. The
+     * genome is speciated right away, so by the time the last score arrives
+     * Epoch() only has to do the remaining work. Safe to call from multiple
+     * threads.
+     *
+     * Genomes join species in the order their scores arrive, while the batch
+     * Epoch speciates them from fittest to weakest. Both give the same
+     * species only when scores are submitted fittest first; an evaluator
+     * running on several threads or processes submits them as they finish,
+     * so the species founders, and the rest of a run with a fixed seed,
+     * depend on how the evaluations were scheduled.
+     * @param id - ID of the genome that was evaluated
+     * @param fitness - non-negative fitness of the genome
+     */
+    void SubmitFitness(GenomeID id, double fitness);
+
+    /**
+     * Finishes the generation once every genome has been scored through
+     * SubmitFitness.
+     */
+    std::vector<SNeuralNetPtr> Epoch();
+
+    /**
+     * Scores the current generation with the given evaluator, submitting each
+     * fitness as it arrives, and then finishes the generation. With a fitness
+     * cache (Params::FitnessCacheSize) genomes identical to an already scored
+     * one get its fitness and are not passed to the evaluator. If the
+     * evaluator throws, the scores submitted so far are kept and calling this
+     * again evaluates only the genomes that are still missing a score.
+     * Genomes are speciated as their scores arrive, see SubmitFitness.
+     * @param brains - networks of the current generation as returned by the
+     *                 previous Epoch or CreateNeuralNetworks
+     * @param evaluator - evaluation driver to score the networks with
+     */
+    std::vector<SNeuralNetPtr> Epoch(const std::vector<SNeuralNetPtr>& brains, IEvaluator& evaluator);
+
     std::vector<SNeuralNetPtr> CreateNeuralNetworks();
 
+    /**
+     * Replaces the last genomes of the current, not yet scored, generation
+     * with copies of the given ones. Migrants must come from a population
+     * sharing this population's innovation database.
+     */
+    void ImportGenomes(const std::vector<Genome>& migrants);
+
+    /**
+     * Copies the complete state between two generations, including the state
+     * of the calling thread's random engine. Throws std::logic_error once
+     * scores of the current generation have been submitted.
+     */
+    GenAlgState Snapshot();
+
+    void SaveCheckpoint(const std::string& path);
+
+    /**
+     * Takes a snapshot right away and writes it on a background thread, so
+     * the current generation can be evaluated in the meantime.
+     */
+    std::future<void> SaveCheckpointAsync(const std::string& path);
+
 
     // Getters and setters
     double BestEverFitness() const { return m_best_ever_fitness; }
     const Utils::RunningStat& SpeciesStats() { return m_num_species_stat; }
     const Utils::RunningStat& GenomeLinksStats() { return m_genome_links_stat; }
     const Utils::RunningStat& GenomeNeuronStats() { return m_genome_neuron_stat; }
+    // fitness of the genomes scored so far in the current generation
+    const Utils::RunningStat& FitnessStats() { return m_fitness_stat; }
+
+    std::size_t NumScored() const { return m_num_scored; }
+
+    // fitness of the most recently scored genomes, see Params::FitnessCacheSize
+    const FitnessCache& GetFitnessCache() const { return m_fitness_cache; }
+
+    // seconds spent in every phase of Epoch and in phenotype construction
+    const EpochProfile& EpochTimes() const { return m_profile; }
+    // keeps every timed phase for a Chrome trace, see EpochProfile
+    void EnableTracing(bool enable) { m_profile.EnableTracing(enable); }
 
-    std::size_t Generation() { return m_generation_count; }
+    std::size_t Generation() const { return m_generation_count; }
+    const Params& Parameters() const { return m_params; }
 
     SNeuralNetPtr BestNN() const;
     Genome BestGenome() const { return m_best_genomes[0]; }
@@ -38,6 +38,8 @@ enum class NeuronType
 
 
 std::string to_string(const NeuronType& nt);
+// inverse of to_string, NONE for unknown names
+NeuronType neuron_type_from_string(const std::string& type);
 
 /**
  * Neuron gene definition
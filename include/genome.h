@@ -7,21 +7,26 @@
  * Definition of a genome used in the NEAT algorithm.
  */
 
+#include <cstdint>
 #include <vector>
 #include <memory>
 
 #include "genes.h"
 #include "innovation.h"
+#include "mutate.h"
 #include "utils.h"
 #include "params.h"
+#include "serialize.h"
 
 namespace neat
 {
 
-class Genome
+class Genome : public ISerialize
 {
 private:
     GenomeID m_genome_id;
+    // genome this one was copied or bred from, -1 if it has none
+    GenomeID m_parent_id;
     std::vector<NeuronGene> m_neuron_genes;
     std::vector<LinkGene> m_link_genes;
 
@@ -54,7 +59,16 @@ private:
     bool FindUnlinkedNeurons(NeuronID& neuron_id_from, NeuronID& neuron_id_to, int num_trys);
 
 public:
-    Genome() {}
+    Genome(): m_genome_id(0),
+              m_parent_id(-1),
+              m_fitness(0),
+              m_adjusted_fitness(0),
+              m_amount_to_spawn(0),
+              m_num_inputs(0),
+              m_num_outputs(0),
+              m_species_id(0),
+              m_params(nullptr)
+    {}
 
     Genome(GenomeID id, std::size_t num_inputs, std::size_t num_outputs, Params* params);
     Genome(GenomeID id,
@@ -64,9 +78,13 @@ public:
            std::size_t num_outputs,
            Params* params);
 
+    // loads the output of serialize()
+    Genome(const nlohmann::json& object, Params* params);
+
     Genome(const Genome& g)
     {
         m_genome_id = g.m_genome_id;
+        m_parent_id = g.m_parent_id;
         m_neuron_genes = g.m_neuron_genes;
         m_link_genes = g.m_link_genes;
         m_fitness = g.m_fitness;
@@ -78,19 +96,7 @@ public:
         m_params = g.m_params;
     }
 
-    Genome(Genome&& g)
-    {
-        m_genome_id = g.m_genome_id;
-        m_neuron_genes = g.m_neuron_genes;
-        m_link_genes = g.m_link_genes;
-        m_fitness = g.m_fitness;
-        m_adjusted_fitness = g.m_adjusted_fitness;
-        m_amount_to_spawn = g.m_amount_to_spawn;
-        m_num_inputs = g.m_num_inputs;
-        m_num_outputs = g.m_num_outputs;
-        m_species_id = g.m_species_id;
-        m_params = g.m_params;
-    }
+    Genome(Genome&& g) = default;
 
     Genome& operator=(const Genome& g) = default;
     Genome& operator=(Genome&& g) = default;
@@ -109,12 +115,16 @@ public:
 
     void AddNeuronToLink(LinkGene& link, InnovationDB& inno_db);
 
+    // uniform perturbation, unbounded weights
     void MutateWeights(double mutation_prob,
                        double prob_new_weight,
                        double max_perturbation);
+    void MutateWeights(const MutationSpec& spec);
 
     void MutateActivationResponse(double mutation_prob,
                                   double max_perturbation);
+    // activation responses are never replaced, ReplaceProb is ignored
+    void MutateActivationResponse(const MutationSpec& spec);
 
     double CalculateDifferenceScore(const Genome& other) const;
 
@@ -124,6 +134,20 @@ public:
 
     void SortLinks();
 
+    /**
+     * Hash of everything the phenotype is built from: neurons with their
+     * activation responses and enabled links by innovation with their weights.
+     * Genomes that only differ in disabled genes, ID, species or fitness have
+     * the same fingerprint.
+     */
+    std::uint64_t Fingerprint() const;
+
+    /**
+     * Genes with their innovation IDs along with fitness and species, enough
+     * to seed a new population with the genome.
+     */
+    nlohmann::json serialize() const;
+
     // overload '<' operator for sorting by fitness - fittest to weakest
     friend bool operator<(const Genome& lhs, const Genome& rhs)
     {
@@ -157,9 +181,15 @@ public:
         return m_link_genes;
     }
 
+    std::size_t NumInputs() const { return m_num_inputs; }
+    std::size_t NumOutputs() const { return m_num_outputs; }
+
     GenomeID ID() const { return m_genome_id; }
     void SetID(const GenomeID id) { m_genome_id = id; }
 
+    GenomeID ParentID() const { return m_parent_id; }
+    void SetParentID(const GenomeID id) { m_parent_id = id; }
+
     double Fitness() const { return m_fitness; }
     void SetFitness(double fitness) { m_fitness = fitness; }
     void SetAjustedFitness(double adjusted_fitness) { m_adjusted_fitness = adjusted_fitness; }
@@ -0,0 +1,61 @@
+#ifndef __GENOMEARCHIVE_H__
+#define __GENOMEARCHIVE_H__
+
+/**
+ * Archive of genomes, e.g. a population or the champions of earlier runs,
+ * used to seed new runs. The archive is memory-mapped and every genome is
+ * decoded only when it is asked for. Values are little-endian.
+ *
+ *   header       u32 magic "NGEN", u16 version, u16 unused, u64 genome count,
+ *                u64 index offset, u64 file size
+ *   innovations  the innovation database the genomes were evolved with, in
+ *                the encoding of encode_innovations
+ *   genomes      every genome in the encoding of encode_genome
+ *   index        per genome: u64 offset, u64 size, i32 id, i32 species id,
+ *                f64 fitness
+ */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "genome.h"
+#include "innovation.h"
+#include "mappedfile.h"
+
+namespace neat
+{
+
+
+const std::uint32_t GENOME_ARCHIVE_MAGIC = 0x4E45474E;
+const std::uint16_t GENOME_ARCHIVE_VERSION = 1;
+
+
+class GenomeArchive
+{
+private:
+    MappedFile m_file;
+
+public:
+    GenomeArchive(const std::string& path);
+
+    std::size_t Size() const { return m_file.NumEntries(); }
+    GenomeID ID(std::size_t idx) const;
+    SpeciesID GetSpeciesID(std::size_t idx) const;
+    double Fitness(std::size_t idx) const;
+
+    // decodes a single genome, which will use the given parameters
+    Genome Load(std::size_t idx, Params* params) const;
+    std::vector<Genome> LoadAll(Params* params) const;
+
+    InnovationDB Innovations() const;
+};
+
+
+void write_genome_archive(const std::string& path,
+                          const std::vector<Genome>& genomes,
+                          const InnovationDB& inno_db);
+
+
+};
+#endif
@@ -1,6 +1,7 @@
 #ifndef __INNOVATION_H__
 #define __INNOVATION_H__
 
+#include <mutex>
 #include <vector>
 #include <string>
 
@@ -33,7 +34,9 @@ struct Innovation
                    NeuronFromID(-1),
                    NeuronToID(-1),
                    NewNeuronID(-1),
-                   Neuron_Type(NeuronType::NONE)
+                   Neuron_Type(NeuronType::NONE),
+                   SplitX(0),
+                   SplitY(0)
     {
     }
 
@@ -54,7 +57,9 @@ struct Innovation
                                  NeuronFromID(lg.FromNeuronID),
                                  NeuronToID(lg.ToNeuronID),
                                  NewNeuronID(-1),
-                                 Neuron_Type(NeuronType::NONE)
+                                 Neuron_Type(NeuronType::NONE),
+                                 SplitX(0),
+                                 SplitY(0)
     {}
 
 
@@ -64,7 +69,11 @@ struct Innovation
                NeuronID neuron_to_id) : Type(type),
                                         ID(id),
                                         NeuronFromID(neuron_from_id),
-                                        NeuronToID(neuron_to_id)
+                                        NeuronToID(neuron_to_id),
+                                        NewNeuronID(-1),
+                                        Neuron_Type(NeuronType::NONE),
+                                        SplitX(0),
+                                        SplitY(0)
     {}
 };
 
@@ -73,12 +82,18 @@ std::string to_string(InnovationType type);
 std::string to_string(const Innovation& innov);
 
 
+/**
+ * The database itself is not synchronized. Populations sharing a database
+ * across threads lock it (it satisfies BasicLockable) around every series of
+ * lookups and additions that must not interleave with another thread's.
+ */
 class InnovationDB
 {
 private:
     std::vector<Innovation> m_innovations;
     int m_next_neuron_id;
     int m_next_innovation_id;
+    std::mutex m_mutex;
 
 public:
     InnovationDB(const std::vector<NeuronGene>& start_neuron_genes,
@@ -89,12 +104,38 @@ public:
           m_next_innovation_id(next_inno_id)
     {}
 
+    // restores a database saved with Innovations(), NextNeuronID() and
+    // NextInnovationID()
+    InnovationDB(const std::vector<Innovation>& innovations, int next_neuron_id, int next_inno_id)
+        : m_innovations(innovations),
+          m_next_neuron_id(next_neuron_id),
+          m_next_innovation_id(next_inno_id)
+    {}
+
     InnovationDB()
         : m_innovations(),
           m_next_neuron_id(0),
           m_next_innovation_id(0)
     {}
 
+    // the mutex guards a particular instance, so it is never copied
+    InnovationDB(const InnovationDB& other)
+        : m_innovations(other.m_innovations),
+          m_next_neuron_id(other.m_next_neuron_id),
+          m_next_innovation_id(other.m_next_innovation_id)
+    {}
+
+    InnovationDB& operator=(const InnovationDB& other)
+    {
+        m_innovations = other.m_innovations;
+        m_next_neuron_id = other.m_next_neuron_id;
+        m_next_innovation_id = other.m_next_innovation_id;
+        return *this;
+    }
+
+    void lock() { m_mutex.lock(); }
+    void unlock() { m_mutex.unlock(); }
+
     InnovationID GetInnovationId(NeuronID neuron_id_from, NeuronID neuron_id_to, InnovationType type);
     InnovationID AddLinkInnovation(NeuronID neuron_id_from, NeuronID neuron_id_to);
     NeuronID AddNeuronInnovation(NeuronID neuron_id1,
@@ -112,8 +153,8 @@ public:
         return m_innovations;
     }
 
-    InnovationID NextInnovationID() { return m_next_innovation_id; }
-    NeuronID NextNeuronID() { return m_next_neuron_id; }
+    InnovationID NextInnovationID() const { return m_next_innovation_id; }
+    NeuronID NextNeuronID() const { return m_next_neuron_id; }
 };
 }
 #endif
@@ -0,0 +1,81 @@
+#ifndef __ISLAND_H__
+#define __ISLAND_H__
+
+/**
+ * Island model: several independent populations evolve on their own threads
+ * and every few generations the best genomes of each island migrate to its
+ * neighbours.
+ */
+
+#include <memory>
+#include <vector>
+
+#include "evaluate.h"
+#include "genalg.h"
+#include "innovation.h"
+#include "params.h"
+
+namespace neat
+{
+
+
+enum class MigrationTopology
+{
+    // island i sends its migrants to island i+1, the last one to the first
+    RING,
+    // every island sends its migrants to all other islands
+    FULLY_CONNECTED
+};
+
+
+class IslandGenAlg
+{
+private:
+    std::shared_ptr<InnovationDB> m_inno_db;
+    std::vector<std::unique_ptr<GenAlg>> m_islands;
+    std::vector<std::vector<SNeuralNetPtr>> m_brains;
+
+    std::size_t m_migration_interval;
+    std::size_t m_num_migrants;
+    MigrationTopology m_topology;
+    std::size_t m_num_migrations;
+
+    void Migrate();
+
+public:
+    /**
+     * @param num_islands - number of populations, each evolving on its own
+     *                      thread
+     * @param migration_interval - number of generations between migrations
+     * @param num_migrants - number of best genomes every island sends out
+     * @param topology - which islands exchange migrants
+     */
+    IslandGenAlg(std::size_t num_inputs,
+                 std::size_t num_outputs,
+                 const Params& params,
+                 std::size_t num_islands,
+                 std::size_t migration_interval,
+                 std::size_t num_migrants,
+                 MigrationTopology topology = MigrationTopology::RING);
+
+    /**
+     * Evolves every island for the given number of generations. The fitness
+     * function is called from all island threads at once, so it has to be
+     * thread-safe.
+     */
+    void Evolve(std::size_t num_generations, const FitnessFunc& fitness);
+
+    // Getters
+    std::size_t NumIslands() const { return m_islands.size(); }
+    GenAlg& Island(std::size_t idx) { return *m_islands[idx]; }
+    const std::vector<SNeuralNetPtr>& IslandNeuralNetworks(std::size_t idx) const { return m_brains[idx]; }
+    std::size_t Generation() const { return m_islands[0]->Generation(); }
+    std::size_t NumMigrations() const { return m_num_migrations; }
+
+    double BestEverFitness() const;
+    Genome BestGenome() const;
+};
+
+
+};
+#endif
@@ -0,0 +1,64 @@
+#ifndef __MAPPEDFILE_H__
+#define __MAPPEDFILE_H__
+
+/**
+ * Read-only memory mapping of an indexed archive, shared by NetArchive and
+ * GenomeArchive. Every such archive starts with the same header:
+ *
+ *   header   u32 magic, u16 version, u16 unused, u64 entry count,
+ *            u64 index offset, u64 file size
+ *
+ * and keeps an index of fixed size entries at the given offset.
+ */
+
+#include <cstdint>
+#include <string>
+
+namespace neat
+{
+
+
+const std::size_t ARCHIVE_HEADER_SIZE = 32;
+
+
+class MappedFile
+{
+private:
+    const std::uint8_t* m_data;
+    std::size_t m_size;
+    std::size_t m_num_entries;
+    const std::uint8_t* m_index;
+    std::size_t m_entry_size;
+    std::string m_owner;
+    std::string m_kind;
+
+public:
+    /**
+     * Maps the file and checks its header. Throws std::system_error if the
+     * file can't be opened or mapped, std::runtime_error if it isn't an
+     * archive of the given magic and version.
+     * @param owner - name of the archive class, for error messages
+     * @param kind - what the archive holds, for error messages
+     */
+    MappedFile(const std::string& path,
+               std::uint32_t magic,
+               std::uint16_t version,
+               std::size_t entry_size,
+               const std::string& owner,
+               const std::string& kind);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const std::uint8_t* Data() const { return m_data; }
+    std::size_t Size() const { return m_size; }
+    std::size_t NumEntries() const { return m_num_entries; }
+
+    // index entry of the idx-th item, throws std::out_of_range
+    const std::uint8_t* Entry(std::size_t idx) const;
+};
+
+
+};
+#endif
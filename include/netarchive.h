@@ -0,0 +1,105 @@
+#ifndef __NETARCHIVE_H__
+#define __NETARCHIVE_H__
+
+/**
+ * Archive of compiled networks, e.g. a population snapshot or a set of
+ * champions, that is memory-mapped and evaluated in place. Opening an
+ * archive of any size neither parses nor copies the networks.
+ *
+ * Every offset is relative to the start of the file and every array is
+ * aligned to 8 bytes, so the mapping can live at any address. Values are
+ * little-endian and read directly, hence the archive can only be used on
+ * little-endian machines.
+ *
+ *   header   u32 magic "NARC", u16 version, u16 unused, u64 network count,
+ *            u64 index offset, u64 file size
+ *   index    per network: u64 offset, i64 id, f64 fitness
+ *   network  u32 neuron count N, u32 link count L, u32 input count,
+ *            u32 output count, f64 activation response[N], f64 weight[L],
+ *            u32 link offset[N + 1], u32 source neuron[L], u8 NeuronType[N]
+ *
+ * Links are grouped by the neuron they feed in the order NeuralNet::Update
+ * sums them, so a NetView produces exactly the outputs of the NeuralNet it
+ * was compiled from.
+ */
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "genome.h"
+#include "mappedfile.h"
+#include "phenotype.h"
+
+namespace neat
+{
+
+
+const std::uint32_t NET_ARCHIVE_MAGIC = 0x4352414E;
+const std::uint16_t NET_ARCHIVE_VERSION = 1;
+
+
+/**
+ * A network inside a mapped archive with its own signal buffer. Only valid
+ * as long as the archive it came from.
+ */
+class NetView
+{
+private:
+    std::uint32_t m_num_neurons;
+    std::uint32_t m_num_inputs;
+    std::uint32_t m_num_outputs;
+    const double* m_activation_responses;
+    const double* m_weights;
+    const std::uint32_t* m_link_offsets;
+    const std::uint32_t* m_sources;
+    const std::uint8_t* m_types;
+    std::vector<double> m_signals;
+    double m_settle_tolerance;
+    std::size_t m_max_ticks;
+    std::size_t m_num_ticks;
+    bool m_settled;
+
+public:
+    NetView(const std::uint8_t* block, std::size_t size);
+
+    // same semantics as NeuralNet::Update
+    std::vector<double> Update(const std::vector<double>& inputs, const UPDATE_TYPE update_type = UPDATE_TYPE::ACTIVE);
+    void SetSettling(double tolerance, std::size_t max_ticks);
+
+    std::size_t NumTicks() const { return m_num_ticks; }
+    bool IsSettled() const { return m_settled; }
+    std::size_t NumNeurons() const { return m_num_neurons; }
+    std::size_t NumLinks() const { return m_link_offsets[m_num_neurons]; }
+    std::size_t NumInputs() const { return m_num_inputs; }
+    std::size_t NumOutputs() const { return m_num_outputs; }
+};
+
+
+class NetArchive
+{
+private:
+    MappedFile m_file;
+
+public:
+    NetArchive(const std::string& path);
+
+    std::size_t Size() const { return m_file.NumEntries(); }
+    std::int64_t ID(std::size_t idx) const;
+    double Fitness(std::size_t idx) const;
+    NetView Net(std::size_t idx) const;
+};
+
+
+/**
+ * Compiles the phenotype of every genome into an archive, storing genome IDs
+ * and fitness along with it.
+ */
+void write_net_archive(const std::string& path, const std::vector<Genome>& genomes);
+
+// networks without a genome get their position as ID and no fitness
+void write_net_archive(const std::string& path, const std::vector<SNeuralNetPtr>& nets);
+
+
+};
+#endif
@@ -2,13 +2,50 @@
 #define __PARAMS_H__
 
 #include <cstddef>
+#include <string>
 
 #include "json.hpp"
 
+#include "serialize.h"
+
 namespace neat
 {
 
-class Params
+/**
+ * How Species::Spawn picks parents among the members of a species.
+ */
+enum class SelectionType
+{
+    // uniformly among the fittest SurvivalRate of the members
+    TRUNCATION,
+    // with probability proportional to fitness
+    FITNESS_PROPORTIONAL,
+    // by linear ranking, see Params::SelectionPressure
+    RANK
+};
+
+std::string to_string(SelectionType type);
+// inverse of to_string, throws std::invalid_argument for unknown names
+SelectionType selection_type_from_string(const std::string& type);
+
+/**
+ * Distribution of the amount a mutated weight or activation response is
+ * perturbed by.
+ */
+enum class PerturbationType
+{
+    // uniform within +/- the maximum perturbation
+    UNIFORM,
+    // normal with the maximum perturbation as standard deviation
+    GAUSSIAN
+};
+
+std::string to_string(PerturbationType type);
+// inverse of to_string, throws std::invalid_argument for unknown names
+PerturbationType perturbation_type_from_string(const std::string& type);
+
+
+class Params : public ISerialize
 {
 private:
     std::size_t m_num_gens_allowed_no_improv;
@@ -20,6 +57,7 @@ private:
     std::size_t m_max_neurons;
     std::size_t m_young_bonus_threshold;
     std::size_t m_old_penalty_threshold;
+    std::size_t m_fitness_cache_size;
 
     double m_survival_rate;
     double m_compatibility_threshold;
@@ -35,6 +73,12 @@ private:
     double m_old_penalty_scaler;
     double m_young_bonus_scaler;
 
+    SelectionType m_selection;
+    double m_selection_pressure;
+
+    PerturbationType m_perturbation;
+    double m_weight_limit;
+
     // scoring used for speciation
     double m_disjoint_scaler;
     double m_excess_scaler;
@@ -46,9 +90,13 @@ public:
     Params();
     Params(nlohmann::json& json_obj);
     Params(const std::string& config_path);
-    Params(const Params& params);
+    Params(const Params& params) = default;
+    Params& operator=(const Params& params) = default;
     static Params FromString(std::string params);
 
+    // same keys as the config files, so the result loads with Params(json)
+    nlohmann::json serialize() const;
+
     // Getters
     std::size_t NumGensAllowedNoImprov() const { return m_num_gens_allowed_no_improv; }
     std::size_t NumBestGenomes() const { return m_num_best_genomes; }
@@ -59,6 +107,8 @@ public:
     std::size_t MaxNeurons() const { return m_max_neurons; }
     std::size_t YoungBonusThreshold() const { return m_young_bonus_threshold; }
     std::size_t OldPenaltyThreshold() const { return m_old_penalty_threshold; }
+    // number of genome fingerprints GenAlg remembers the fitness of, 0 disables
+    std::size_t FitnessCacheSize() const { return m_fitness_cache_size; }
 
     double SurvivalRate() const { return m_survival_rate; }
     double CompatibilityThreshold() const { return m_compatibility_threshold; }
@@ -76,6 +126,15 @@ public:
     double DisjointScaler() const { return m_disjoint_scaler; }
     double ExcessScaler() const { return m_excess_scaler; }
     double MatchScaler() const { return m_match_scaler; }
+
+    SelectionType Selection() const { return m_selection; }
+    // expected number of offspring of the fittest member under RANK
+    // selection, between 1 (uniform) and 2 (weakest member never picked)
+    double SelectionPressure() const { return m_selection_pressure; }
+
+    PerturbationType Perturbation() const { return m_perturbation; }
+    // weights are kept within +/- the limit, 0 leaves them unbounded
+    double WeightLimit() const { return m_weight_limit; }
 };
 
 };
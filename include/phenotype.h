@@ -1,6 +1,8 @@
 #ifndef __PHENOTYPE_H__
 #define __PHENOTYPE_H__
 
+#include <cstddef>
+#include <istream>
 #include <vector>
 #include <memory>
 
@@ -15,13 +17,28 @@ namespace neat
 {
 
 
+/**
+ * SNAPSHOT clears every signal after a single pass, ACTIVE keeps them for the
+ * next update. SETTLE keeps them as well but repeats the pass until no signal
+ * changes by as much as the settle tolerance of the network, or it hit its
+ * tick cap, so recurrent connections get to settle on the current inputs.
+ */
 enum class UPDATE_TYPE
 {
     SNAPSHOT,
-    ACTIVE
+    ACTIVE,
+    SETTLE
 };
 
 
+const double DEFAULT_SETTLE_TOLERANCE = 1e-6;
+const std::size_t DEFAULT_MAX_TICKS = 100;
+
+
+// activation function of every neuron
+double sigmoid(double input, double act_response);
+
+
 struct Link;
 struct Neuron;
 class NeuralNet;
@@ -43,6 +60,7 @@ struct Link : public ISerialize
     {}
 
     nlohmann::json serialize() const;
+    void serialize_to(JsonWriter& writer) const;
 };
 
 
@@ -72,6 +90,7 @@ struct Neuron : public ISerialize
     {}
 
     nlohmann::json serialize() const;
+    void serialize_to(JsonWriter& writer) const;
 };
 
 
@@ -80,26 +99,77 @@ class NeuralNet : public ISerialize
 private:
     std::vector<Neuron> m_neurons;
 
-    std::size_t GetDepth(const Neuron* n, std::size_t depth) const;
+    // filled by ComputeLevels when the network is built, so readers sharing
+    // a network never write to it
+    std::vector<std::size_t> m_levels;
+    std::size_t m_depth;
+
+    double m_settle_tolerance;
+    std::size_t m_max_ticks;
+    // passes over the network of the last update and whether it settled
+    std::size_t m_num_ticks;
+    bool m_settled;
+
+    void ComputeLevels();
     Neuron* find_neuron_by_id(NeuronID id);
     Neuron* find_helper(NeuronID id, int low, int high);
 
 public:
-    NeuralNet(std::vector<Neuron>& neurons)
-        : m_neurons(neurons)
-    {}
-
+    /**
+     * Copies the neurons, pointing their links at the copies of the neurons
+     * with the same IDs. Throws std::invalid_argument if a link refers to a
+     * neuron that isn't among the given ones.
+     */
+    NeuralNet(std::vector<Neuron>& neurons);
+
+    /**
+     * Builds the network of the genes, leaving out hidden neurons that can't
+     * change the outputs and folding constant ones into bias links; see
+     * compile_phenotype in phenotype.cpp. Since the dropped neurons no longer
+     * count towards settling, UPDATE_TYPE::SETTLE may take fewer ticks than
+     * on the whole genome.
+     */
     NeuralNet(const Genome& g);
     NeuralNet(const std::vector<NeuronGene>& neuron_genes,
               const std::vector<LinkGene>& link_genes);
     NeuralNet(nlohmann::json& object);
 
+    /**
+     * Loads the output of serialize() without building a json document,
+     * in time linear in the size of the network.
+     */
+    static NeuralNet FromStream(std::istream& in);
+
     std::vector<double> Update(const std::vector<double>& inputs, const UPDATE_TYPE update_type = UPDATE_TYPE::ACTIVE);
 
     nlohmann::json serialize() const;
+    void serialize_to(JsonWriter& writer) const;
+
+    // limits of UPDATE_TYPE::SETTLE, a tick cap of 0 is taken as 1
+    void SetSettling(double tolerance, std::size_t max_ticks);
 
     // Getters and setters
-    std::size_t GetDepth() const;
+    double SettleTolerance() const { return m_settle_tolerance; }
+    std::size_t MaxTicks() const { return m_max_ticks; }
+
+    // passes over the network done by the last Update
+    std::size_t NumTicks() const { return m_num_ticks; }
+    // whether no signal changed by the settle tolerance in the last pass
+    bool IsSettled() const { return m_settled; }
+
+    /**
+     * Number of neurons on the longest path of non recurrent links from an
+     * input or bias neuron to an output neuron.
+     */
+    std::size_t GetDepth() const { return m_depth; }
+
+    /**
+     * Level of every neuron, in the order of GetNeurons(): the number of
+     * links on the longest path of non recurrent links into it. Input and
+     * bias neurons are on level 0, and a neuron only depends on neurons of
+     * lower levels through non recurrent links.
+     */
+    const std::vector<std::size_t>& GetLevels() const { return m_levels; }
     const std::vector<Neuron>& GetNeurons() const { return m_neurons; }
 
     // Friends
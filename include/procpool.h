@@ -0,0 +1,89 @@
+#ifndef __PROCPOOL_H__
+#define __PROCPOOL_H__
+
+/**
+ * Evaluation in forked worker processes, for environments that are not
+ * thread-safe or that may crash. Networks travel to the workers through a
+ * shared-memory ring buffer per worker and fitness values come back the same
+ * way.
+ */
+
+#include <sys/types.h>
+
+#include <cstdint>
+#include <deque>
+#include <vector>
+
+#include "evaluate.h"
+
+namespace neat
+{
+
+namespace internal
+{
+    struct WorkerChannel;
+}
+
+
+class ProcessPoolEvaluator : public IEvaluator
+{
+private:
+    struct Worker
+    {
+        pid_t Pid;
+        internal::WorkerChannel* Channel;
+        // indices of the networks sent to the worker, oldest first
+        std::deque<std::size_t> Outstanding;
+    };
+
+    FitnessFunc m_fitness;
+    double m_penalty;
+    std::size_t m_ring_capacity;
+    std::size_t m_num_crashes;
+
+    // memory shared with all workers, holding the semaphore they post after
+    // every result
+    void* m_shared;
+    std::size_t m_shared_size;
+    std::vector<Worker> m_workers;
+
+    void Spawn(Worker& worker);
+    void DiscardOutstanding();
+    bool Dispatch(Worker& worker, std::uint64_t job_id, const std::vector<std::uint8_t>& job);
+    std::size_t CollectResults(Worker& worker, const FitnessReport& report);
+
+public:
+    /**
+     * Forks the workers right away; each one keeps its own copy of the
+     * fitness function.
+     * @param fitness - fitness function run inside the workers
+     * @param num_workers - number of worker processes
+     * @param penalty - fitness given to a network whose evaluation crashed
+     *                  the worker
+     * @param ring_capacity - bytes of the ring buffer carrying networks to
+     *                        each worker, a network may take up at most
+     *                        half of it
+     */
+    ProcessPoolEvaluator(FitnessFunc fitness,
+                         std::size_t num_workers,
+                         double penalty = 0.0,
+                         std::size_t ring_capacity = 1 << 20);
+    ~ProcessPoolEvaluator();
+
+    ProcessPoolEvaluator(const ProcessPoolEvaluator&) = delete;
+    ProcessPoolEvaluator& operator=(const ProcessPoolEvaluator&) = delete;
+
+    /**
+     * If report throws, the networks still queued are abandoned: workers
+     * holding them are replaced, so the evaluator can be used again.
+     */
+    void Evaluate(const std::vector<SNeuralNetPtr>& brains, const FitnessReport& report) override;
+
+    std::size_t NumWorkers() const { return m_workers.size(); }
+    // number of times a worker died and had to be replaced
+    std::size_t NumCrashes() const { return m_num_crashes; }
+};
+
+
+};
+#endif
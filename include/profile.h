@@ -0,0 +1,135 @@
+#ifndef __PROFILE_H__
+#define __PROFILE_H__
+
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "serialize.h"
+#include "utils.h"
+
+namespace neat
+{
+
+
+enum class EpochPhase
+{
+    PURGE_SPECIES,
+    UPDATE_GENOME_SCORES,
+    SPECIATE_GENOMES,
+    UPDATE_BEST_GENOMES,
+    UPDATE_SPECIES_FITNESS,
+    CALCULATE_SPAWN_AMOUNTS,
+    CREATE_NEW_POPULATION,
+    STATISTICS,
+    CREATE_PHENOTYPES,
+    NONE
+};
+
+const std::size_t NUM_EPOCH_PHASES = static_cast<std::size_t>(EpochPhase::NONE);
+
+std::string to_string(EpochPhase phase);
+
+
+/**
+ * Time spent in every phase of GenAlg::Epoch, in seconds per generation.
+ * Work done between two epochs, e.g. speciating genomes as their scores come
+ * in through SubmitFitness, counts towards the generation it finishes.
+ *
+ * With tracing enabled every timed phase is kept as well, and serialize()
+ * returns them as Chrome trace events (chrome://tracing, Perfetto).
+ */
+class EpochProfile : public ISerialize
+{
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    struct TraceEvent
+    {
+        EpochPhase Phase;
+        std::size_t Generation;
+        double Start;
+        double Duration;
+    };
+
+    std::array<Utils::RunningStat, NUM_EPOCH_PHASES> m_phase_stats;
+    std::array<double, NUM_EPOCH_PHASES> m_current;
+    // phases timed in many small pieces, traced as one event per generation
+    std::array<bool, NUM_EPOCH_PHASES> m_accumulated;
+    std::array<Clock::time_point, NUM_EPOCH_PHASES> m_accumulated_start;
+    Clock::time_point m_origin;
+    std::size_t m_generation;
+    bool m_tracing;
+    std::vector<TraceEvent> m_events;
+
+public:
+    EpochProfile();
+
+    void Record(EpochPhase phase, Clock::time_point start, Clock::time_point end);
+
+    /**
+     * Adds to the time of a phase that runs in many small pieces, e.g. once
+     * per genome. The pieces of a generation are traced as a single event
+     * when the generation is finished.
+     */
+    void Accumulate(EpochPhase phase, Clock::time_point start, Clock::time_point end);
+
+    // closes the current generation
+    void FinishEpoch();
+
+    void EnableTracing(bool enable) { m_tracing = enable; }
+    bool IsTracing() const { return m_tracing; }
+
+    const Utils::RunningStat& Phase(EpochPhase phase) const
+    {
+        return m_phase_stats[static_cast<std::size_t>(phase)];
+    }
+
+    // sum of all phases of the last finished generation
+    double LastEpochSeconds() const;
+
+    nlohmann::json serialize() const;
+    void serialize_to(JsonWriter& writer) const;
+};
+
+
+/**
+ * Records the time until it goes out of scope as the given phase. An
+ * accumulating timer adds to the phase instead, see EpochProfile::Accumulate.
+ */
+class PhaseTimer
+{
+private:
+    EpochProfile& m_profile;
+    EpochPhase m_phase;
+    bool m_accumulate;
+    std::chrono::steady_clock::time_point m_start;
+
+public:
+    PhaseTimer(EpochProfile& profile, EpochPhase phase, bool accumulate = false): m_profile(profile),
+                                                                                m_phase(phase),
+                                                                                m_accumulate(accumulate),
+                                                                                m_start(std::chrono::steady_clock::now())
+    {}
+
+    ~PhaseTimer()
+    {
+        auto end = std::chrono::steady_clock::now();
+        if(m_accumulate)
+        {
+            m_profile.Accumulate(m_phase, m_start, end);
+        }
+        else
+        {
+            m_profile.Record(m_phase, m_start, end);
+        }
+    }
+
+    PhaseTimer(const PhaseTimer&) = delete;
+    PhaseTimer& operator=(const PhaseTimer&) = delete;
+};
+
+
+};
+#endif
@@ -0,0 +1,142 @@
+#ifndef __RACE_H__
+#define __RACE_H__
+
+/**
+ * Racing of multi-episode fitness functions. Every episode score of a network
+ * is reported as soon as it is known, and a network that, with the given
+ * confidence, can't end up among the survivors of its species any more is
+ * told to stop, so the remaining episodes go to networks that still matter.
+ */
+
+#include <cstddef>
+#include <functional>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+#include "evaluate.h"
+#include "genes.h"
+#include "phenotype.h"
+
+namespace neat
+{
+
+
+class GenAlg;
+
+/**
+ * Plays one episode of the task, the index counts the episodes of a network
+ * from 0.
+ */
+typedef std::function<double(SNeuralNetPtr, std::size_t)> EpisodeFunc;
+
+
+/**
+ * Races the networks of one generation. A network is dropped once at least
+ * as many other members of its group as survive truncation selection in a
+ * species (see Species::Spawn) have a lower confidence bound above its upper
+ * one. A survival rate of 1 never drops a network. The
+ * bounds are mean +/- z * standard error of the episode scores; a network
+ * that played all episodes has its mean as both bounds.
+ *
+ * Every method is safe to call from several threads, e.g. from a fitness
+ * function run by ThreadPoolEvaluator.
+ */
+class Race
+{
+private:
+    struct Entry
+    {
+        std::size_t NumEpisodes;
+        double Mean;
+        // sum of squared differences from the mean
+        double M2;
+        bool Aborted;
+    };
+
+    std::size_t m_num_episodes;
+    double m_survival_rate;
+    std::size_t m_min_episodes;
+    double m_z;
+    std::vector<Entry> m_entries;
+    std::vector<SpeciesID> m_groups;
+    // networks of every group, and the group of every network
+    std::vector<std::vector<std::size_t>> m_members;
+    std::vector<std::size_t> m_group_of;
+    std::unordered_map<const NeuralNet*, std::size_t> m_index;
+    std::size_t m_num_aborted;
+    std::size_t m_episodes_played;
+    mutable std::mutex m_mutex;
+
+    double LowerBound(const Entry& entry) const;
+    double UpperBound(const Entry& entry) const;
+    bool CanSurvive(std::size_t idx) const;
+    void GroupMembers();
+    std::size_t IndexOf(const SNeuralNetPtr& brain) const;
+
+public:
+    /**
+     * @param brains - networks of the generation, in the order of the genomes
+     * @param num_episodes - number of episodes a network plays unless dropped
+     * @param survival_rate - fraction of a group that produces offspring
+     * @param groups - species of every network; empty races all networks
+     *                 against each other
+     * @param min_episodes - episodes every network plays before it can be
+     *                       dropped
+     * @param z - width of the confidence bounds in standard errors
+     */
+    Race(const std::vector<SNeuralNetPtr>& brains,
+         std::size_t num_episodes,
+         double survival_rate,
+         std::vector<SpeciesID> groups = {},
+         std::size_t min_episodes = 3,
+         double z = 2.0);
+
+    /**
+     * Races the current generation of ga, grouped by the species the genomes
+     * inherited from their parents and with its SurvivalRate. The drop rule
+     * matches truncation selection; with any other ParentSelection every
+     * member of a species can become a parent, so the survival rate is 1 and
+     * every network plays all episodes.
+     */
+    Race(const GenAlg& ga,
+         const std::vector<SNeuralNetPtr>& brains,
+         std::size_t num_episodes,
+         std::size_t min_episodes = 3,
+         double z = 2.0);
+
+    Race(const Race&) = delete;
+    Race& operator=(const Race&) = delete;
+
+    /**
+     * Records the score of the next episode of a network.
+     * @returns true if the network should play another episode
+     */
+    bool Report(const SNeuralNetPtr& brain, double score);
+
+    // false once the network played all episodes or was dropped
+    bool ShouldContinue(const SNeuralNetPtr& brain) const;
+
+    /**
+     * Fitness of a network that stopped playing: the mean of its episode
+     * scores. Throws std::logic_error for a network that hasn't played any.
+     */
+    double Finalize(const SNeuralNetPtr& brain) const;
+
+    /**
+     * Fitness function for the evaluators that plays episodes of a network
+     * until the race stops it and returns Finalize. Episode scores must not
+     * be negative.
+     */
+    FitnessFunc Fitness(EpisodeFunc episode);
+
+    std::size_t NumEpisodes() const { return m_num_episodes; }
+    std::size_t NumAborted() const;
+    // episodes played so far by all networks
+    std::size_t EpisodesPlayed() const;
+    bool IsAborted(const SNeuralNetPtr& brain) const;
+};
+
+
+};
+#endif
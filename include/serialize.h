@@ -1,19 +1,73 @@
 #ifndef __SERIALIZE_H__
 #define __SERIALIZE_H__
 
+#include <ostream>
+#include <string>
+#include <vector>
 
 #include "json.hpp"
 
 namespace neat
 {
 
+
+/**
+ * Writes json straight to a stream, formatted exactly like json::dump with
+ * the same indentation. Object keys have to be written in the order dump
+ * would print them, i.e. sorted.
+ */
+class JsonWriter
+{
+private:
+    struct Level
+    {
+        bool IsObject;
+        bool IsEmpty;
+    };
+
+    std::ostream& m_out;
+    int m_indent;
+    std::vector<Level> m_levels;
+    bool m_after_key;
+
+    void BeforeValue();
+    void NewLine(std::size_t depth);
+
+public:
+    // indent < 0 writes compact json
+    JsonWriter(std::ostream& out, int indent = -1);
+
+    void BeginObject();
+    void EndObject();
+    void BeginArray();
+    void EndArray();
+    void Key(const std::string& key);
+
+    // writes a complete document, e.g. a scalar or the result of serialize()
+    void Value(const nlohmann::json& value);
+
+    template<typename T>
+    void Value(const T& value)
+    {
+        Value(nlohmann::json(value));
+    }
+};
+
+
 class ISerialize
 {
 public:
     virtual nlohmann::json serialize() const = 0;
+
+    // writes the same json as serialize() without building it in memory first
+    virtual void serialize_to(JsonWriter& writer) const
+    {
+        writer.Value(serialize());
+    }
 };
 
 
+void serialize_to_stream(std::ostream& out, const ISerialize& object, bool pretty=true);
 void serialize_to_file(std::string path, const ISerialize& object, bool pretty=true);
 nlohmann::json deserialize_from_file(std::string path);
 
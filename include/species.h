@@ -9,14 +9,34 @@
 namespace neat
 {
 
+/**
+ * Sampling weights of the parent selection configured in params.
+ * @param fitness - fitness of the candidates, fittest first
+ */
+std::vector<double> selection_weights(const Params& params, const std::vector<double>& fitness);
+
+
+/**
+ * Members of a species are a contiguous range of the population once
+ * GenAlg::PartitionSpecies has run. Until then only their number is known,
+ * the genomes themselves carry the ID of their species.
+ */
 class Species
 {
 private:
+    // leader of the previous generations, kept while the population gets
+    // replaced
     Genome m_leader;
+    // set when a member of the current generation took over the lead
+    bool m_leader_is_member;
+    std::size_t m_leader_idx;
 
     SpeciesID m_id;
 
-    std::vector<Genome*> m_members;
+    // population the members are a range of, owned by GenAlg
+    std::vector<Genome>* m_population;
+    std::size_t m_first;
+    std::size_t m_size;
     // number of generations this species has not experienced any improvement
     // in fitness
     std::size_t m_gens_no_improvement;
@@ -25,35 +45,77 @@ private:
 
     double m_spawns_required;
 
+    // parents by the configured selection, built once per generation
+    Utils::AliasTable m_parents;
+
     Params* m_params;
 
+    Genome& Member(std::size_t i) const { return (*m_population)[m_first + i]; }
 
 public:
-    Species(Genome& originator, SpeciesID id, Params* params);
+    /**
+     * @param originator - index of the first member in population
+     * @param population - genomes of the current generation, the species
+     *                     refers to them by index instead of copying them
+     */
+    Species(std::size_t originator, std::vector<Genome>* population, SpeciesID id, Params* params);
+
+    // restores a species saved between generations, it has no members until
+    // the next generation gets speciated
+    Species(const Genome& leader,
+            SpeciesID id,
+            std::size_t gens_no_improvement,
+            std::size_t age,
+            double spawns_required,
+            std::vector<Genome>* population,
+            Params* params);
 
     void AdjustFitness();
 
-    void AddMember(Genome& new_member);
+    // counts the genome at the given index of the population in, the genome
+    // has to be tagged with the species ID by the caller
+    void AddMember(std::size_t new_member);
+
+    /**
+     * Called once the population has been reordered so the members of this
+     * species start at first, fittest to weakest.
+     * @param new_positions - new index of every genome by its old index
+     */
+    void SetMembers(std::size_t first, const std::vector<std::size_t>& new_positions);
+
+    /**
+     * Moves a leader out of the current generation before the population
+     * gets replaced.
+     */
+    void KeepLeader();
 
     void Purge();
 
     void CalculateSpawnAmount();
 
+    // builds the parent selection over the current members
+    void PrepareSelection();
+
     Genome* Spawn();
 
     friend bool operator<(const Species& lhs, const Species& rhs)
     {
-        return lhs.m_leader.Fitness() > rhs.m_leader.Fitness();
+        return lhs.LeaderFitness() > rhs.LeaderFitness();
     }
 
     // Member getters and setters
     std::size_t GensNoImprovement() const { return m_gens_no_improvement; }
     std::size_t Age() const { return m_age; }
     double SpawnsRequired() const { return m_spawns_required; }
-    double LeaderFitness() const { return m_leader.Fitness(); }
+    double LeaderFitness() const { return Leader().Fitness(); }
 
-    const Genome& Leader() const { return m_leader; }
-    std::size_t Size() const { return m_members.size(); }
+    const Genome& Leader() const
+    {
+        return m_leader_is_member ? (*m_population)[m_leader_idx] : m_leader;
+    }
+    std::size_t Size() const { return m_size; }
+    // index of the first member in the population, see SetMembers
+    std::size_t First() const { return m_first; }
 
     SpeciesID ID() const { return m_id; }
 };
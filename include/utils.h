@@ -2,18 +2,129 @@
 #define __UTILS_H__
 
 #include <chrono>
+#include <cmath>
 #include <concepts>
+#include <cstdint>
 #include <fstream>
+#include <istream>
 #include <memory>
 #include <random>
 #include <ranges>
+#include <sstream>
 #include <stdexcept>
+#include <string>
 #include <type_traits>
+#include <vector>
 
 
 namespace Utils
 {
 
+/**
+ * Four independent xoshiro256** generators advanced side by side. The state
+ * is stored lane by lane, so the compiler turns one step of all lanes into
+ * vector instructions. Used to fill buffers of random numbers in bulk.
+ */
+class Xoshiro256x4
+{
+public:
+    static const std::size_t LANES = 4;
+
+    explicit Xoshiro256x4(std::uint64_t seed = 0)
+    {
+        Seed(seed);
+    }
+
+    void Seed(std::uint64_t seed)
+    {
+        // splitmix64 spreads one seed over all the state words
+        for(std::size_t word = 0; word < 4; ++word)
+        {
+            for(std::size_t lane = 0; lane < LANES; ++lane)
+            {
+                seed += 0x9E3779B97F4A7C15ULL;
+                std::uint64_t z = seed;
+                z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+                z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+                m_state[word][lane] = z ^ (z >> 31);
+            }
+        }
+    }
+
+    // one number of every lane
+    void Next(std::uint64_t* out)
+    {
+        auto rotl = [](std::uint64_t x, int k) { return (x << k) | (x >> (64 - k)); };
+        for(std::size_t lane = 0; lane < LANES; ++lane)
+        {
+            out[lane] = rotl(m_state[1][lane] * 5, 7) * 9;
+            std::uint64_t t = m_state[1][lane] << 17;
+            m_state[2][lane] ^= m_state[0][lane];
+            m_state[3][lane] ^= m_state[1][lane];
+            m_state[1][lane] ^= m_state[2][lane];
+            m_state[0][lane] ^= m_state[3][lane];
+            m_state[2][lane] ^= t;
+            m_state[3][lane] = rotl(m_state[3][lane], 45);
+        }
+    }
+
+    // uniform doubles in [0, 1)
+    void FillUniform(double* out, std::size_t count)
+    {
+        std::uint64_t bits[LANES];
+        std::size_t i = 0;
+        for(; i + LANES <= count; i += LANES)
+        {
+            Next(bits);
+            for(std::size_t lane = 0; lane < LANES; ++lane)
+            {
+                out[i + lane] = ToUnit(bits[lane]);
+            }
+        }
+        if(i < count)
+        {
+            Next(bits);
+            for(std::size_t lane = 0; i < count; ++i, ++lane)
+            {
+                out[i] = ToUnit(bits[lane]);
+            }
+        }
+    }
+
+    friend std::ostream& operator<<(std::ostream& out, const Xoshiro256x4& engine)
+    {
+        for(std::size_t word = 0; word < 4; ++word)
+        {
+            for(std::size_t lane = 0; lane < LANES; ++lane)
+            {
+                out << (word + lane > 0 ? " " : "") << engine.m_state[word][lane];
+            }
+        }
+        return out;
+    }
+
+    friend std::istream& operator>>(std::istream& in, Xoshiro256x4& engine)
+    {
+        for(std::size_t word = 0; word < 4; ++word)
+        {
+            for(std::size_t lane = 0; lane < LANES; ++lane)
+            {
+                in >> engine.m_state[word][lane];
+            }
+        }
+        return in;
+    }
+
+private:
+    std::uint64_t m_state[4][LANES];
+
+    static double ToUnit(std::uint64_t bits)
+    {
+        return (bits >> 11) * 0x1.0p-53;
+    }
+};
+
+
 template<typename TEngine>
 class Random;
 
@@ -25,6 +136,9 @@ class Random
 {
 private:
     TEngine m_rand_engine;
+    // separate engine for the Fill methods, so they don't change the numbers
+    // the scalar methods produce
+    Xoshiro256x4 m_bulk_engine;
 
     Random(long long seed)
     {
@@ -33,17 +147,73 @@ private:
             auto tp = std::chrono::high_resolution_clock::now();
             seed = tp.time_since_epoch() / std::chrono::nanoseconds(1);
         }
-        m_rand_engine.seed(seed);
+        Seed(seed);
     }
 
 public:
 
+    /**
+     * Every thread gets its own engine, so populations and fitness functions
+     * may run concurrently. The seed only matters for the first call made on
+     * a thread.
+     */
     static DefaultRandom& Instance(long long seed = -1)
     {
-        static DefaultRandom instance(seed);
+        static thread_local DefaultRandom instance(seed);
         return instance;
     }
 
+    /**
+     * Restarts the engine of the calling thread from the given seed, e.g. in
+     * a forked process that inherited its parent's engine.
+     */
+    void Seed(long long seed)
+    {
+        m_rand_engine.seed(seed);
+        m_bulk_engine.Seed(seed);
+    }
+
+    /**
+     * Complete state of the calling thread's engine. After SetState the
+     * engine continues with exactly the numbers it produced after GetState.
+     */
+    std::string GetState() const
+    {
+        std::ostringstream out;
+        out << m_rand_engine << " " << m_bulk_engine;
+        return out.str();
+    }
+
+    /**
+     * States saved before the bulk engine existed only hold the scalar
+     * engine; the bulk engine is then seeded from it.
+     */
+    void SetState(const std::string& state)
+    {
+        std::istringstream in(state);
+        TEngine engine;
+        in >> engine;
+        if(in.fail())
+        {
+            throw std::invalid_argument("Invalid random engine state");
+        }
+
+        Xoshiro256x4 bulk_engine;
+        in >> std::ws;
+        if(in.eof())
+        {
+            // from a copy, the scalar engine has to continue where it was
+            TEngine seeder = engine;
+            bulk_engine.Seed(seeder());
+        }
+        else if((in >> bulk_engine).fail())
+        {
+            throw std::invalid_argument("Invalid random engine state");
+        }
+        m_rand_engine = engine;
+        m_bulk_engine = bulk_engine;
+    }
+
     template <typename TValue>
     TValue RandomClamped(TValue lower_bound=-1, TValue upper_bound=1)
     {
@@ -75,6 +245,45 @@ public:
     {
         return RandomDouble() < 0.5;
     }
+
+    // fills out with uniform doubles in [lower_bound, upper_bound)
+    void FillUniform(double* out, std::size_t count, double lower_bound = 0.0, double upper_bound = 1.0)
+    {
+        m_bulk_engine.FillUniform(out, count);
+        if(lower_bound != 0.0 || upper_bound != 1.0)
+        {
+            double range = upper_bound - lower_bound;
+            for(std::size_t i = 0; i < count; ++i)
+            {
+                out[i] = lower_bound + out[i] * range;
+            }
+        }
+    }
+
+    // fills out with normally distributed doubles, by Box-Muller
+    void FillNormal(double* out, std::size_t count, double mean = 0.0, double stddev = 1.0)
+    {
+        const double two_pi = 6.283185307179586;
+        double uniforms[Xoshiro256x4::LANES];
+        for(std::size_t i = 0; i < count; i += Xoshiro256x4::LANES)
+        {
+            m_bulk_engine.FillUniform(uniforms, Xoshiro256x4::LANES);
+            for(std::size_t pair = 0; pair < Xoshiro256x4::LANES; pair += 2)
+            {
+                // 1 - u keeps the logarithm finite
+                double radius = std::sqrt(-2.0 * std::log(1.0 - uniforms[pair]));
+                double angle = two_pi * uniforms[pair + 1];
+                if(i + pair < count)
+                {
+                    out[i + pair] = mean + stddev * radius * std::cos(angle);
+                }
+                if(i + pair + 1 < count)
+                {
+                    out[i + pair + 1] = mean + stddev * radius * std::sin(angle);
+                }
+            }
+        }
+    }
 };
 
 template <class TEngine>
@@ -176,6 +385,16 @@ public:
 class RunningStat
 {
 public:
+    // everything needed to continue the series, e.g. after a restart
+    struct State
+    {
+        int NumValues;
+        double OldMean, NewMean, OldStd, NewStd;
+        double Total;
+        double MinValue, MaxValue;
+        double LastValue;
+    };
+
     RunningStat(): m_num_values(0),
                    m_old_mean(0),
                    m_new_mean(0),
@@ -183,7 +402,8 @@ public:
                    m_new_std(0),
                    m_total(0),
                    m_max_value(std::numeric_limits<double>::min()),
-                   m_min_value(std::numeric_limits<double>::max())
+                   m_min_value(std::numeric_limits<double>::max()),
+                   m_last_value(0)
     {}
 
     void Clear()
@@ -294,6 +514,25 @@ public:
         return m_last_value;
     }
 
+    State GetState() const
+    {
+        return State{m_num_values, m_old_mean, m_new_mean, m_old_std, m_new_std,
+                     m_total, m_min_value, m_max_value, m_last_value};
+    }
+
+    void SetState(const State& state)
+    {
+        m_num_values = state.NumValues;
+        m_old_mean = state.OldMean;
+        m_new_mean = state.NewMean;
+        m_old_std = state.OldStd;
+        m_new_std = state.NewStd;
+        m_total = state.Total;
+        m_min_value = state.MinValue;
+        m_max_value = state.MaxValue;
+        m_last_value = state.LastValue;
+    }
+
 private:
     int m_num_values;
     double m_old_mean, m_new_mean, m_old_std, m_new_std;
@@ -303,6 +542,96 @@ private:
 };
 
 
+/**
+ * Walker's alias method: after building the table once in O(n), every sample
+ * of an index with probability proportional to its weight takes a single
+ * random number. Built with Vose's algorithm.
+ */
+class AliasTable
+{
+public:
+    AliasTable() {}
+
+    explicit AliasTable(const std::vector<double>& weights)
+    {
+        Build(weights);
+    }
+
+    /**
+     * Weights must not be negative. If they are all 0 every index is equally
+     * likely.
+     */
+    void Build(const std::vector<double>& weights)
+    {
+        std::size_t size = weights.size();
+        m_probability.assign(size, 1.0);
+        m_alias.resize(size);
+        for(std::size_t i = 0; i < size; ++i)
+        {
+            m_alias[i] = i;
+        }
+
+        double total = 0.0;
+        for(double weight : weights)
+        {
+            total += weight;
+        }
+        if(size == 0 || total <= 0.0)
+        {
+            return;
+        }
+
+        std::vector<double> scaled(size);
+        std::vector<std::size_t> small, large;
+        for(std::size_t i = 0; i < size; ++i)
+        {
+            scaled[i] = weights[i] * size / total;
+            (scaled[i] < 1.0 ? small : large).push_back(i);
+        }
+
+        while(!small.empty() && !large.empty())
+        {
+            std::size_t less = small.back();
+            std::size_t more = large.back();
+            small.pop_back();
+
+            m_probability[less] = scaled[less];
+            m_alias[less] = more;
+            scaled[more] -= 1.0 - scaled[less];
+            if(scaled[more] < 1.0)
+            {
+                large.pop_back();
+                small.push_back(more);
+            }
+        }
+        // whatever is left is 1 up to rounding errors
+        for(auto i : small)
+        {
+            m_probability[i] = 1.0;
+        }
+        for(auto i : large)
+        {
+            m_probability[i] = 1.0;
+        }
+    }
+
+    template<typename TEngine>
+    std::size_t Sample(Random<TEngine>& random) const
+    {
+        double u = random.RandomDouble() * m_probability.size();
+        std::size_t column = std::min<std::size_t>(u, m_probability.size() - 1);
+        return u - column < m_probability[column] ? column : m_alias[column];
+    }
+
+    std::size_t Size() const { return m_probability.size(); }
+    bool Empty() const { return m_probability.empty(); }
+
+private:
+    std::vector<double> m_probability;
+    std::vector<std::size_t> m_alias;
+};
+
+
 static bool is_file_exist(std::string path)
 {
     std::ifstream file(path);
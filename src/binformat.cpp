@@ -0,0 +1,420 @@
+#include <fstream>
+#include <iterator>
+#include <unordered_map>
+
+#include "binformat.h"
+#include "utils.h"
+
+namespace neat
+{
+
+
+const std::size_t HEADER_SIZE = 16;
+const std::size_t NEURON_RECORD_SIZE = 29;
+const std::size_t INNOVATION_RECORD_SIZE = 34;
+
+
+void encode_net(BinaryWriter& writer, const NeuralNet& nn, WeightPrecision precision)
+{
+    const auto& neurons = nn.GetNeurons();
+
+    std::unordered_map<const Neuron*, std::uint32_t> positions;
+    std::size_t num_links = 0;
+    for(std::size_t i = 0; i < neurons.size(); ++i)
+    {
+        positions[&neurons[i]] = i;
+        num_links += neurons[i].InLinks.size();
+    }
+
+    writer.Write(NET_FORMAT_MAGIC);
+    writer.Write(NET_FORMAT_VERSION);
+    writer.Write(precision);
+    writer.Write<std::uint8_t>(0);
+    writer.Write<std::uint32_t>(neurons.size());
+    writer.Write<std::uint32_t>(num_links);
+
+    for(auto& n : neurons)
+    {
+        writer.Write<std::uint8_t>(static_cast<std::uint8_t>(n.Type));
+        writer.Write<std::int32_t>(n.ID);
+        writer.Write(n.ActivationResponse);
+        writer.Write(n.SplitX);
+        writer.Write(n.SplitY);
+    }
+
+    std::uint32_t offset = 0;
+    writer.Write(offset);
+    for(auto& n : neurons)
+    {
+        offset += n.InLinks.size();
+        writer.Write(offset);
+    }
+
+    for(auto& n : neurons)
+    {
+        for(auto& link : n.InLinks)
+        {
+            writer.Write(positions.at(link.In));
+        }
+    }
+
+    for(auto& n : neurons)
+    {
+        for(auto& link : n.InLinks)
+        {
+            if(precision == WeightPrecision::FLOAT32)
+            {
+                writer.Write(static_cast<float>(link.Weight));
+            }
+            else
+            {
+                writer.Write(link.Weight);
+            }
+        }
+    }
+
+    std::uint8_t bits = 0;
+    std::size_t link_idx = 0;
+    for(auto& n : neurons)
+    {
+        for(auto& link : n.InLinks)
+        {
+            bits |= (link.IsRecurrent ? 1 : 0) << (link_idx % 8);
+            if(++link_idx % 8 == 0)
+            {
+                writer.Write(bits);
+                bits = 0;
+            }
+        }
+    }
+    if(link_idx % 8 != 0)
+    {
+        writer.Write(bits);
+    }
+}
+
+
+NeuralNet decode_net(BinaryReader& reader)
+{
+    if(reader.Read<std::uint32_t>() != NET_FORMAT_MAGIC)
+    {
+        throw std::runtime_error("decode_net: not a NeuralNet file");
+    }
+    auto version = reader.Read<std::uint16_t>();
+    if(version != NET_FORMAT_VERSION)
+    {
+        throw std::runtime_error("decode_net: unsupported format version " + std::to_string(version));
+    }
+    auto precision = reader.Read<WeightPrecision>();
+    if(precision != WeightPrecision::FLOAT32 && precision != WeightPrecision::FLOAT64)
+    {
+        throw std::runtime_error("decode_net: unknown weight precision");
+    }
+    reader.Skip(1);
+    auto num_neurons = reader.Read<std::uint32_t>();
+    auto num_links = reader.Read<std::uint32_t>();
+
+    // check the counts against the data before allocating anything for them
+    std::uint64_t weight_size = precision == WeightPrecision::FLOAT32 ? sizeof(float) : sizeof(double);
+    std::uint64_t min_size = std::uint64_t(num_neurons) * NEURON_RECORD_SIZE
+                           + (std::uint64_t(num_neurons) + 1) * sizeof(std::uint32_t)
+                           + std::uint64_t(num_links) * (sizeof(std::uint32_t) + weight_size)
+                           + (std::uint64_t(num_links) + 7) / 8;
+    if(min_size > reader.Remaining())
+    {
+        throw std::runtime_error("decode_net: neuron and link counts exceed the data");
+    }
+
+    std::vector<NeuronGene> neuron_genes;
+    neuron_genes.reserve(num_neurons);
+    for(std::uint32_t i = 0; i < num_neurons; ++i)
+    {
+        auto type = reader.Read<std::uint8_t>();
+        if(type >= static_cast<std::uint8_t>(NeuronType::NONE))
+        {
+            throw std::runtime_error("decode_net: unknown neuron type " + std::to_string(type));
+        }
+        NeuronID id = reader.Read<std::int32_t>();
+        // NeuralNet looks neurons up by ID with a binary search
+        if(!neuron_genes.empty() && !(neuron_genes.back().ID < id))
+        {
+            throw std::runtime_error("decode_net: neuron IDs aren't unique and increasing");
+        }
+        auto activation_response = reader.Read<double>();
+        auto split_x = reader.Read<double>();
+        auto split_y = reader.Read<double>();
+
+        NeuronGene ng(static_cast<NeuronType>(type), id, split_y, split_x);
+        ng.ActivationResponse = activation_response;
+        neuron_genes.push_back(ng);
+    }
+
+    std::vector<std::uint32_t> offsets(num_neurons + 1);
+    for(auto& offset : offsets)
+    {
+        offset = reader.Read<std::uint32_t>();
+    }
+    if(offsets.front() != 0 || offsets.back() != num_links)
+    {
+        throw std::runtime_error("decode_net: corrupt link offsets");
+    }
+
+    std::vector<std::uint32_t> sources(num_links);
+    for(auto& source : sources)
+    {
+        source = reader.Read<std::uint32_t>();
+        if(source >= num_neurons)
+        {
+            throw std::runtime_error("decode_net: link refers to a neuron that doesn't exist");
+        }
+    }
+
+    std::vector<double> weights(num_links);
+    for(auto& weight : weights)
+    {
+        weight = precision == WeightPrecision::FLOAT32 ? reader.Read<float>() : reader.Read<double>();
+    }
+
+    std::vector<LinkGene> link_genes;
+    link_genes.reserve(num_links);
+    std::uint8_t bits = 0;
+    for(std::uint32_t to = 0; to < num_neurons; ++to)
+    {
+        if(offsets[to] > offsets[to + 1] || offsets[to + 1] > num_links)
+        {
+            throw std::runtime_error("decode_net: corrupt link offsets");
+        }
+        for(auto i = offsets[to]; i < offsets[to + 1]; ++i)
+        {
+            if(i % 8 == 0)
+            {
+                bits = reader.Read<std::uint8_t>();
+            }
+            bool recurrent = (bits >> (i % 8)) & 1;
+            link_genes.emplace_back(neuron_genes[sources[i]].ID, neuron_genes[to].ID, weights[i], true, 0, recurrent);
+        }
+    }
+
+    return NeuralNet(neuron_genes, link_genes);
+}
+
+
+std::vector<std::uint8_t> serialize_binary(const NeuralNet& nn, WeightPrecision precision)
+{
+    std::size_t num_neurons = nn.GetNeurons().size();
+    std::size_t num_links = 0;
+    for(auto& n : nn.GetNeurons())
+    {
+        num_links += n.InLinks.size();
+    }
+
+    std::size_t weight_size = precision == WeightPrecision::FLOAT32 ? 4 : 8;
+    std::vector<std::uint8_t> buffer;
+    buffer.reserve(HEADER_SIZE + num_neurons * NEURON_RECORD_SIZE + (num_neurons + 1) * 4 +
+                   num_links * (4 + weight_size) + (num_links + 7) / 8);
+    BinaryWriter writer(buffer);
+    encode_net(writer, nn, precision);
+    return buffer;
+}
+
+
+NeuralNet deserialize_binary(const std::uint8_t* data, std::size_t size)
+{
+    BinaryReader reader(data, size);
+    return decode_net(reader);
+}
+
+
+NeuralNet deserialize_binary(const std::vector<std::uint8_t>& buffer)
+{
+    return deserialize_binary(buffer.data(), buffer.size());
+}
+
+
+void serialize_binary_to_file(std::string path, const NeuralNet& nn, WeightPrecision precision)
+{
+    auto buffer = serialize_binary(nn, precision);
+    std::ofstream out(path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    out.close();
+}
+
+
+NeuralNet deserialize_binary_from_file(std::string path)
+{
+    if(!Utils::is_file_exist(path))
+    {
+        throw std::ios_base::failure("Can't deserialize - file '" + path + "' doesn't exist");
+    }
+
+    std::ifstream in(path, std::ios::binary);
+    std::vector<std::uint8_t> buffer((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    return deserialize_binary(buffer);
+}
+
+
+void encode_genome(BinaryWriter& writer, const Genome& g)
+{
+    writer.Write<std::int32_t>(g.ID());
+    writer.Write<std::uint32_t>(g.NumInputs());
+    writer.Write<std::uint32_t>(g.NumOutputs());
+    writer.Write<std::int32_t>(g.GetSpeciesID());
+    writer.Write(g.Fitness());
+    writer.Write(g.GetAdjustedFitness());
+    writer.Write(g.AmountToSpawn());
+
+    writer.Write<std::uint32_t>(g.NumNeurons());
+    for(auto& ng : g.NeuronGenes())
+    {
+        encode_neuron_gene(writer, ng);
+    }
+
+    writer.Write<std::uint32_t>(g.NumLinks());
+    for(auto& lg : g.NeuronLinks())
+    {
+        encode_link_gene(writer, lg);
+    }
+}
+
+
+Genome decode_genome(BinaryReader& reader, Params* params)
+{
+    GenomeID id = reader.Read<std::int32_t>();
+    auto num_inputs = reader.Read<std::uint32_t>();
+    auto num_outputs = reader.Read<std::uint32_t>();
+    SpeciesID species_id = reader.Read<std::int32_t>();
+    auto fitness = reader.Read<double>();
+    auto adjusted_fitness = reader.Read<double>();
+    auto amount_to_spawn = reader.Read<double>();
+
+    std::vector<NeuronGene> neuron_genes;
+    auto num_neurons = reader.Read<std::uint32_t>();
+    for(std::uint32_t i = 0; i < num_neurons; ++i)
+    {
+        neuron_genes.push_back(decode_neuron_gene(reader));
+    }
+
+    std::vector<LinkGene> link_genes;
+    auto num_links = reader.Read<std::uint32_t>();
+    for(std::uint32_t i = 0; i < num_links; ++i)
+    {
+        link_genes.push_back(decode_link_gene(reader));
+    }
+
+    Genome g(id, neuron_genes, link_genes, num_inputs, num_outputs, params);
+    g.SetSpeciesID(species_id);
+    g.SetFitness(fitness);
+    g.SetAjustedFitness(adjusted_fitness);
+    g.SetAmountToSpawn(amount_to_spawn);
+    return g;
+}
+
+
+void encode_neuron_gene(BinaryWriter& writer, const NeuronGene& ng)
+{
+    writer.Write<std::uint8_t>(static_cast<std::uint8_t>(ng.Type));
+    writer.Write<std::int32_t>(ng.ID);
+    writer.Write(ng.IsRecurrent);
+    writer.Write(ng.ActivationResponse);
+    writer.Write(ng.SplitY);
+    writer.Write(ng.SplitX);
+}
+
+
+NeuronGene decode_neuron_gene(BinaryReader& reader)
+{
+    auto type = static_cast<NeuronType>(reader.Read<std::uint8_t>());
+    NeuronID neuron_id = reader.Read<std::int32_t>();
+    auto recurrent = reader.Read<bool>();
+    auto activation_response = reader.Read<double>();
+    auto split_y = reader.Read<double>();
+    auto split_x = reader.Read<double>();
+
+    NeuronGene ng(type, neuron_id, split_y, split_x, recurrent);
+    ng.ActivationResponse = activation_response;
+    return ng;
+}
+
+
+void encode_link_gene(BinaryWriter& writer, const LinkGene& lg)
+{
+    writer.Write<std::int32_t>(lg.FromNeuronID);
+    writer.Write<std::int32_t>(lg.ToNeuronID);
+    writer.Write(lg.Weight);
+    writer.Write(lg.IsEnabled);
+    writer.Write(lg.IsRecurrent);
+    writer.Write<std::int32_t>(lg.InnovID);
+}
+
+
+LinkGene decode_link_gene(BinaryReader& reader)
+{
+    NeuronID from = reader.Read<std::int32_t>();
+    NeuronID to = reader.Read<std::int32_t>();
+    auto weight = reader.Read<double>();
+    auto enabled = reader.Read<bool>();
+    auto recurrent = reader.Read<bool>();
+    InnovationID innovation_id = reader.Read<std::int32_t>();
+    return LinkGene(from, to, weight, enabled, innovation_id, recurrent);
+}
+
+
+void encode_innovation(BinaryWriter& writer, const Innovation& innov)
+{
+    writer.Write<std::uint8_t>(static_cast<std::uint8_t>(innov.Type));
+    writer.Write<std::int32_t>(innov.ID);
+    writer.Write<std::int32_t>(innov.NeuronFromID);
+    writer.Write<std::int32_t>(innov.NeuronToID);
+    writer.Write<std::int32_t>(innov.NewNeuronID);
+    writer.Write<std::uint8_t>(static_cast<std::uint8_t>(innov.Neuron_Type));
+    writer.Write(innov.SplitX);
+    writer.Write(innov.SplitY);
+}
+
+
+Innovation decode_innovation(BinaryReader& reader)
+{
+    Innovation innov;
+    innov.Type = static_cast<InnovationType>(reader.Read<std::uint8_t>());
+    innov.ID = reader.Read<std::int32_t>();
+    innov.NeuronFromID = reader.Read<std::int32_t>();
+    innov.NeuronToID = reader.Read<std::int32_t>();
+    innov.NewNeuronID = reader.Read<std::int32_t>();
+    innov.Neuron_Type = static_cast<NeuronType>(reader.Read<std::uint8_t>());
+    innov.SplitX = reader.Read<double>();
+    innov.SplitY = reader.Read<double>();
+    return innov;
+}
+
+
+void encode_innovations(BinaryWriter& writer, const InnovationDB& inno_db)
+{
+    writer.Write<std::int32_t>(inno_db.NextNeuronID());
+    writer.Write<std::int32_t>(inno_db.NextInnovationID());
+    writer.Write<std::uint32_t>(inno_db.Innovations().size());
+    for(auto& innov : inno_db.Innovations())
+    {
+        encode_innovation(writer, innov);
+    }
+}
+
+
+InnovationDB decode_innovations(BinaryReader& reader)
+{
+    auto next_neuron_id = reader.Read<std::int32_t>();
+    auto next_innovation_id = reader.Read<std::int32_t>();
+    auto num_innovations = reader.Read<std::uint32_t>();
+    if(std::uint64_t(num_innovations) * INNOVATION_RECORD_SIZE > reader.Remaining())
+    {
+        throw std::runtime_error("decode_innovations: innovation count exceeds the data");
+    }
+    std::vector<Innovation> innovations(num_innovations);
+    for(auto& innov : innovations)
+    {
+        innov = decode_innovation(reader);
+    }
+    return InnovationDB(innovations, next_neuron_id, next_innovation_id);
+}
+
+
+};
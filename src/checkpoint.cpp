@@ -0,0 +1,751 @@
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <unordered_map>
+
+#include "binary.h"
+#include "binformat.h"
+#include "checkpoint.h"
+
+namespace neat
+{
+
+
+static void write_stat(BinaryWriter& writer, const Utils::RunningStat::State& stat)
+{
+    writer.Write<std::int32_t>(stat.NumValues);
+    for(double value : {stat.OldMean, stat.NewMean, stat.OldStd, stat.NewStd,
+                        stat.Total, stat.MinValue, stat.MaxValue, stat.LastValue})
+    {
+        writer.Write(value);
+    }
+}
+
+
+static Utils::RunningStat::State read_stat(BinaryReader& reader)
+{
+    Utils::RunningStat::State stat;
+    stat.NumValues = reader.Read<std::int32_t>();
+    for(double* value : {&stat.OldMean, &stat.NewMean, &stat.OldStd, &stat.NewStd,
+                         &stat.Total, &stat.MinValue, &stat.MaxValue, &stat.LastValue})
+    {
+        *value = reader.Read<double>();
+    }
+    return stat;
+}
+
+
+static void write_genomes(BinaryWriter& writer, const std::vector<Genome>& genomes)
+{
+    writer.Write<std::uint32_t>(genomes.size());
+    for(auto& g : genomes)
+    {
+        encode_genome(writer, g);
+    }
+}
+
+
+static std::vector<Genome> read_genomes(BinaryReader& reader)
+{
+    std::vector<Genome> genomes;
+    auto num_genomes = reader.Read<std::uint32_t>();
+    for(std::uint32_t i = 0; i < num_genomes; ++i)
+    {
+        genomes.push_back(decode_genome(reader, nullptr));
+    }
+    return genomes;
+}
+
+
+std::vector<std::uint8_t> encode_checkpoint(const GenAlgState& state)
+{
+    std::vector<std::uint8_t> buffer;
+    BinaryWriter writer(buffer);
+
+    writer.Write(CHECKPOINT_MAGIC);
+    writer.Write(CHECKPOINT_VERSION);
+    writer.Write<std::uint16_t>(0);
+
+    writer.Write(state.Parameters.serialize().dump());
+    writer.Write<std::uint64_t>(state.Generation);
+    writer.Write<std::int32_t>(state.NextGenomeID);
+    writer.Write<std::int32_t>(state.NextSpeciesID);
+    writer.Write(state.BestEverFitness);
+
+    write_genomes(writer, state.Genomes);
+    write_genomes(writer, state.BestGenomes);
+
+    writer.Write<std::uint32_t>(state.Species.size());
+    for(auto& s : state.Species)
+    {
+        encode_genome(writer, s.Leader);
+        writer.Write<std::int32_t>(s.ID);
+        writer.Write<std::uint64_t>(s.GensNoImprovement);
+        writer.Write<std::uint64_t>(s.Age);
+        writer.Write(s.SpawnsRequired);
+    }
+
+    encode_innovations(writer, state.Innovations);
+
+    write_stat(writer, state.NumSpeciesStat);
+    write_stat(writer, state.GenomeLinksStat);
+    write_stat(writer, state.GenomeNeuronStat);
+    write_stat(writer, state.FitnessStat);
+    writer.Write(state.RandomState);
+
+    return buffer;
+}
+
+
+GenAlgState decode_checkpoint(const std::uint8_t* data, std::size_t size)
+{
+    BinaryReader reader(data, size);
+    if(reader.Read<std::uint32_t>() != CHECKPOINT_MAGIC)
+    {
+        throw std::runtime_error("decode_checkpoint: not a GenAlg checkpoint");
+    }
+    auto version = reader.Read<std::uint16_t>();
+    if(version != CHECKPOINT_VERSION)
+    {
+        throw std::runtime_error("decode_checkpoint: unsupported checkpoint version " + std::to_string(version));
+    }
+    reader.Skip(2);
+
+    GenAlgState state;
+    auto params = nlohmann::json::parse(reader.ReadString());
+    state.Parameters = Params(params);
+    state.Generation = reader.Read<std::uint64_t>();
+    state.NextGenomeID = reader.Read<std::int32_t>();
+    state.NextSpeciesID = reader.Read<std::int32_t>();
+    state.BestEverFitness = reader.Read<double>();
+
+    state.Genomes = read_genomes(reader);
+    state.BestGenomes = read_genomes(reader);
+
+    auto num_species = reader.Read<std::uint32_t>();
+    for(std::uint32_t i = 0; i < num_species; ++i)
+    {
+        SpeciesState s;
+        s.Leader = decode_genome(reader, nullptr);
+        s.ID = reader.Read<std::int32_t>();
+        s.GensNoImprovement = reader.Read<std::uint64_t>();
+        s.Age = reader.Read<std::uint64_t>();
+        s.SpawnsRequired = reader.Read<double>();
+        state.Species.push_back(s);
+    }
+
+    state.Innovations = decode_innovations(reader);
+
+    state.NumSpeciesStat = read_stat(reader);
+    state.GenomeLinksStat = read_stat(reader);
+    state.GenomeNeuronStat = read_stat(reader);
+    state.FitnessStat = read_stat(reader);
+    state.RandomState = reader.ReadString();
+
+    if(reader.Remaining() != 0)
+    {
+        throw std::runtime_error("decode_checkpoint: unexpected data after the checkpoint");
+    }
+    return state;
+}
+
+
+void write_checkpoint(const std::string& path, const GenAlgState& state)
+{
+    auto buffer = encode_checkpoint(state);
+
+    auto tmp_path = path + ".tmp";
+    std::ofstream out(tmp_path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    out.close();
+    if(!out || std::rename(tmp_path.c_str(), path.c_str()) != 0)
+    {
+        std::remove(tmp_path.c_str());
+        throw std::ios_base::failure("Can't write checkpoint '" + path + "'");
+    }
+}
+
+
+GenAlgState read_checkpoint(const std::string& path)
+{
+    if(!Utils::is_file_exist(path))
+    {
+        throw std::ios_base::failure("Can't read checkpoint - file '" + path + "' doesn't exist");
+    }
+
+    std::ifstream in(path, std::ios::binary);
+    std::vector<std::uint8_t> buffer((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    return decode_checkpoint(buffer.data(), buffer.size());
+}
+
+
+//================================CHECKPOINT LOG=================================
+
+const std::uint32_t CHECKPOINT_LOG_MAGIC = 0x4C4B434E;
+const std::uint16_t CHECKPOINT_LOG_VERSION = 2;
+const std::size_t CHECKPOINT_LOG_HEADER_SIZE = 6;
+const std::size_t LOG_RECORD_HEADER_SIZE = 9;
+
+enum class RecordKind : std::uint8_t
+{
+    FULL,
+    DELTA
+};
+
+// how a genome is stored in a delta
+enum class GenomeEntry : std::uint8_t
+{
+    // known from the previous state, only the values that change between
+    // generations follow
+    RETAINED,
+    NEW,
+    // offspring of a genome of the previous state, stored as the edits that
+    // turn the genes of its parent into its own
+    DERIVED
+};
+
+// a retained genome is the smallest entry: the entry kind, the genome and
+// species ids and three doubles
+const std::size_t MIN_GENOME_ENTRY_SIZE = 33;
+
+// how a gene of an offspring is made from the genes of its parent
+enum class GeneEdit : std::uint8_t
+{
+    // a run of unchanged genes of the parent
+    COPY,
+    // a gene of the parent with a new weight or activation response
+    VALUE,
+    // a gene in full
+    GENE
+};
+
+// a copy is the smallest edit: the edit kind, the index and the length of the run
+const std::size_t MIN_GENE_EDIT_SIZE = 9;
+
+
+static bool same_bits(double lhs, double rhs)
+{
+    return std::memcmp(&lhs, &rhs, sizeof(double)) == 0;
+}
+
+
+// genes are matched to the genes of the parent by neuron and innovation ids
+static int gene_key(const NeuronGene& ng) { return ng.ID; }
+static int gene_key(const LinkGene& lg) { return lg.InnovID; }
+
+// the part of a gene mutated every generation
+static double gene_value(const NeuronGene& ng) { return ng.ActivationResponse; }
+static double gene_value(const LinkGene& lg) { return lg.Weight; }
+static void set_gene_value(NeuronGene& ng, double value) { ng.ActivationResponse = value; }
+static void set_gene_value(LinkGene& lg, double value) { lg.Weight = value; }
+
+
+// true if the genes only differ by their value
+static bool same_structure(const NeuronGene& lhs, const NeuronGene& rhs)
+{
+    return lhs.Type == rhs.Type && lhs.ID == rhs.ID && lhs.IsRecurrent == rhs.IsRecurrent &&
+           same_bits(lhs.SplitY, rhs.SplitY) && same_bits(lhs.SplitX, rhs.SplitX);
+}
+
+
+static bool same_structure(const LinkGene& lhs, const LinkGene& rhs)
+{
+    return lhs.FromNeuronID == rhs.FromNeuronID && lhs.ToNeuronID == rhs.ToNeuronID &&
+           lhs.IsEnabled == rhs.IsEnabled && lhs.IsRecurrent == rhs.IsRecurrent &&
+           lhs.InnovID == rhs.InnovID;
+}
+
+
+static void write_gene(BinaryWriter& writer, const NeuronGene& ng) { encode_neuron_gene(writer, ng); }
+static void write_gene(BinaryWriter& writer, const LinkGene& lg) { encode_link_gene(writer, lg); }
+static void read_gene(BinaryReader& reader, std::vector<NeuronGene>& genes) { genes.push_back(decode_neuron_gene(reader)); }
+static void read_gene(BinaryReader& reader, std::vector<LinkGene>& genes) { genes.push_back(decode_link_gene(reader)); }
+
+
+/**
+ * Writes the genes of an offspring as edits of the genes of its parent.
+ * Genes the offspring inherited unchanged only extend a run of copies.
+ */
+template <typename TGene>
+static void write_gene_edits(BinaryWriter& writer,
+                             const std::vector<TGene>& genes,
+                             const std::vector<TGene>& parent_genes)
+{
+    std::unordered_map<int, std::uint32_t> parent_index;
+    for(std::uint32_t i = 0; i < parent_genes.size(); ++i)
+    {
+        parent_index[gene_key(parent_genes[i])] = i;
+    }
+
+    struct Edit
+    {
+        GeneEdit Kind;
+        std::uint32_t Index;
+        std::uint32_t Count;
+        const TGene* Gene;
+    };
+    std::vector<Edit> edits;
+    for(auto& gene : genes)
+    {
+        auto found = parent_index.find(gene_key(gene));
+        if(found == parent_index.end() || !same_structure(gene, parent_genes[found->second]))
+        {
+            edits.push_back(Edit{GeneEdit::GENE, 0, 0, &gene});
+        }
+        else if(!same_bits(gene_value(gene), gene_value(parent_genes[found->second])))
+        {
+            edits.push_back(Edit{GeneEdit::VALUE, found->second, 0, &gene});
+        }
+        else if(!edits.empty() && edits.back().Kind == GeneEdit::COPY &&
+                edits.back().Index + edits.back().Count == found->second)
+        {
+            ++edits.back().Count;
+        }
+        else
+        {
+            edits.push_back(Edit{GeneEdit::COPY, found->second, 1, &gene});
+        }
+    }
+
+    writer.Write<std::uint32_t>(edits.size());
+    for(auto& edit : edits)
+    {
+        writer.Write(edit.Kind);
+        switch(edit.Kind)
+        {
+            case GeneEdit::COPY:
+                writer.Write(edit.Index);
+                writer.Write(edit.Count);
+                break;
+            case GeneEdit::VALUE:
+                writer.Write(edit.Index);
+                writer.Write(gene_value(*edit.Gene));
+                break;
+            case GeneEdit::GENE:
+                write_gene(writer, *edit.Gene);
+                break;
+        }
+    }
+}
+
+
+template <typename TGene>
+static std::vector<TGene> read_gene_edits(BinaryReader& reader, const std::vector<TGene>& parent_genes)
+{
+    auto num_edits = reader.Read<std::uint32_t>();
+    if(std::uint64_t(num_edits) * MIN_GENE_EDIT_SIZE > reader.Remaining())
+    {
+        throw std::runtime_error("read_checkpoint_log: gene edit count exceeds the data");
+    }
+
+    std::vector<TGene> genes;
+    for(std::uint32_t i = 0; i < num_edits; ++i)
+    {
+        auto edit = reader.Read<GeneEdit>();
+        if(edit == GeneEdit::GENE)
+        {
+            read_gene(reader, genes);
+            continue;
+        }
+        if(edit != GeneEdit::COPY && edit != GeneEdit::VALUE)
+        {
+            throw std::runtime_error("read_checkpoint_log: unknown gene edit");
+        }
+
+        auto index = reader.Read<std::uint32_t>();
+        if(index >= parent_genes.size())
+        {
+            throw std::runtime_error("read_checkpoint_log: delta refers to a gene the parent doesn't have");
+        }
+        if(edit == GeneEdit::COPY)
+        {
+            auto count = reader.Read<std::uint32_t>();
+            if(count > parent_genes.size() - index)
+            {
+                throw std::runtime_error("read_checkpoint_log: delta refers to a gene the parent doesn't have");
+            }
+            genes.insert(genes.end(), parent_genes.begin() + index, parent_genes.begin() + index + count);
+        }
+        else
+        {
+            genes.push_back(parent_genes[index]);
+            set_gene_value(genes.back(), reader.Read<double>());
+        }
+    }
+    return genes;
+}
+
+
+static void write_genome_values(BinaryWriter& writer, const Genome& g)
+{
+    writer.Write<std::int32_t>(g.GetSpeciesID());
+    writer.Write(g.Fitness());
+    writer.Write(g.GetAdjustedFitness());
+    writer.Write(g.AmountToSpawn());
+}
+
+
+static void read_genome_values(BinaryReader& reader, Genome& g)
+{
+    g.SetSpeciesID(reader.Read<std::int32_t>());
+    g.SetFitness(reader.Read<double>());
+    g.SetAjustedFitness(reader.Read<double>());
+    g.SetAmountToSpawn(reader.Read<double>());
+}
+
+
+static void write_genome_entry(BinaryWriter& writer, const Genome& g, const std::unordered_map<int, Genome>& known)
+{
+    auto parent = known.find(g.ParentID());
+    if(known.count(g.ID()))
+    {
+        writer.Write(GenomeEntry::RETAINED);
+        writer.Write<std::int32_t>(g.ID());
+        write_genome_values(writer, g);
+    }
+    else if(parent != known.end())
+    {
+        writer.Write(GenomeEntry::DERIVED);
+        writer.Write<std::int32_t>(g.ID());
+        writer.Write<std::int32_t>(g.ParentID());
+        write_gene_edits(writer, g.NeuronGenes(), parent->second.NeuronGenes());
+        write_gene_edits(writer, g.NeuronLinks(), parent->second.NeuronLinks());
+        write_genome_values(writer, g);
+    }
+    else
+    {
+        writer.Write(GenomeEntry::NEW);
+        encode_genome(writer, g);
+    }
+}
+
+
+static const Genome& find_known_genome(const std::unordered_map<int, const Genome*>& known, GenomeID id)
+{
+    auto found = known.find(id);
+    if(found == known.end())
+    {
+        throw std::runtime_error("read_checkpoint_log: delta refers to an unknown genome");
+    }
+    return *found->second;
+}
+
+
+static Genome read_genome_entry(BinaryReader& reader, const std::unordered_map<int, const Genome*>& known)
+{
+    auto entry = reader.Read<GenomeEntry>();
+    if(entry == GenomeEntry::NEW)
+    {
+        return decode_genome(reader, nullptr);
+    }
+    if(entry == GenomeEntry::RETAINED)
+    {
+        Genome g(find_known_genome(known, reader.Read<std::int32_t>()));
+        read_genome_values(reader, g);
+        return g;
+    }
+    if(entry != GenomeEntry::DERIVED)
+    {
+        throw std::runtime_error("read_checkpoint_log: unknown genome entry");
+    }
+
+    GenomeID id = reader.Read<std::int32_t>();
+    auto& parent = find_known_genome(known, reader.Read<std::int32_t>());
+    auto neuron_genes = read_gene_edits(reader, parent.NeuronGenes());
+    auto link_genes = read_gene_edits(reader, parent.NeuronLinks());
+
+    Genome g(id, neuron_genes, link_genes, parent.NumInputs(), parent.NumOutputs(), nullptr);
+    g.SetParentID(parent.ID());
+    read_genome_values(reader, g);
+    return g;
+}
+
+
+static void write_record(std::ofstream& out, RecordKind kind, const std::vector<std::uint8_t>& payload)
+{
+    std::vector<std::uint8_t> header;
+    BinaryWriter writer(header);
+    writer.Write(kind);
+    writer.Write<std::uint64_t>(payload.size());
+    out.write(reinterpret_cast<const char*>(header.data()), header.size());
+    out.write(reinterpret_cast<const char*>(payload.data()), payload.size());
+}
+
+
+/**
+ * Genomes a delta may refer to - every genome the state holds a copy of.
+ */
+template <typename TFunc>
+static void for_each_genome(const GenAlgState& state, TFunc func)
+{
+    for(auto& g : state.Genomes)
+    {
+        func(g);
+    }
+    for(auto& g : state.BestGenomes)
+    {
+        func(g);
+    }
+    for(auto& s : state.Species)
+    {
+        func(s.Leader);
+    }
+}
+
+
+static void apply_delta(GenAlgState& state, BinaryReader& reader)
+{
+    // the genomes of the new state are copied out of the old one, so the old
+    // one must stay untouched until the whole delta has been read
+    std::unordered_map<int, const Genome*> known;
+    for_each_genome(state, [&known](const Genome& g) { known[g.ID()] = &g; });
+
+    GenAlgState next;
+    next.Parameters = state.Parameters;
+    next.Generation = reader.Read<std::uint64_t>();
+    next.NextGenomeID = reader.Read<std::int32_t>();
+    next.NextSpeciesID = reader.Read<std::int32_t>();
+    next.BestEverFitness = reader.Read<double>();
+
+    for(auto genomes : {&next.Genomes, &next.BestGenomes})
+    {
+        auto num_genomes = reader.Read<std::uint32_t>();
+        if(std::uint64_t(num_genomes) * MIN_GENOME_ENTRY_SIZE > reader.Remaining())
+        {
+            throw std::runtime_error("read_checkpoint_log: genome count exceeds the data");
+        }
+        genomes->reserve(num_genomes);
+        for(std::uint32_t i = 0; i < num_genomes; ++i)
+        {
+            genomes->push_back(read_genome_entry(reader, known));
+        }
+    }
+
+    auto num_species = reader.Read<std::uint32_t>();
+    for(std::uint32_t i = 0; i < num_species; ++i)
+    {
+        SpeciesState s;
+        s.Leader = read_genome_entry(reader, known);
+        s.ID = reader.Read<std::int32_t>();
+        s.GensNoImprovement = reader.Read<std::uint64_t>();
+        s.Age = reader.Read<std::uint64_t>();
+        s.SpawnsRequired = reader.Read<double>();
+        next.Species.push_back(s);
+    }
+
+    auto next_neuron_id = reader.Read<std::int32_t>();
+    auto next_innovation_id = reader.Read<std::int32_t>();
+    auto num_old_innovations = reader.Read<std::uint32_t>();
+    if(num_old_innovations != state.Innovations.Innovations().size())
+    {
+        throw std::runtime_error("read_checkpoint_log: delta doesn't continue the innovation database");
+    }
+    auto innovations = state.Innovations.Innovations();
+    auto num_new_innovations = reader.Read<std::uint32_t>();
+    for(std::uint32_t i = 0; i < num_new_innovations; ++i)
+    {
+        innovations.push_back(decode_innovation(reader));
+    }
+    next.Innovations = InnovationDB(innovations, next_neuron_id, next_innovation_id);
+
+    next.NumSpeciesStat = read_stat(reader);
+    next.GenomeLinksStat = read_stat(reader);
+    next.GenomeNeuronStat = read_stat(reader);
+    next.FitnessStat = read_stat(reader);
+    next.RandomState = reader.ReadString();
+
+    state = std::move(next);
+}
+
+
+CheckpointLog::CheckpointLog(const std::string& path,
+                             std::size_t full_interval): m_path(path),
+                                                         m_full_interval(full_interval),
+                                                         m_num_deltas(0),
+                                                         m_last_write_size(0),
+                                                         m_written_genomes(),
+                                                         m_num_written_innovations(0)
+{}
+
+
+void CheckpointLog::Write(const GenAlgState& state)
+{
+    if(m_written_genomes.empty() || m_num_deltas >= m_full_interval)
+    {
+        WriteFull(state);
+    }
+    else
+    {
+        WriteDelta(state);
+    }
+    Remember(state);
+}
+
+
+void CheckpointLog::WriteFull(const GenAlgState& state)
+{
+    std::vector<std::uint8_t> header;
+    BinaryWriter writer(header);
+    writer.Write(CHECKPOINT_LOG_MAGIC);
+    writer.Write(CHECKPOINT_LOG_VERSION);
+
+    auto payload = encode_checkpoint(state);
+
+    // the new log replaces the old one only once it is complete
+    auto tmp_path = m_path + ".tmp";
+    std::ofstream out(tmp_path, std::ios::binary);
+    out.write(reinterpret_cast<const char*>(header.data()), header.size());
+    write_record(out, RecordKind::FULL, payload);
+    out.close();
+    if(!out || std::rename(tmp_path.c_str(), m_path.c_str()) != 0)
+    {
+        std::remove(tmp_path.c_str());
+        throw std::ios_base::failure("Can't write checkpoint log '" + m_path + "'");
+    }
+
+    m_num_deltas = 0;
+    m_last_write_size = header.size() + LOG_RECORD_HEADER_SIZE + payload.size();
+}
+
+
+void CheckpointLog::WriteDelta(const GenAlgState& state)
+{
+    std::vector<std::uint8_t> payload;
+    BinaryWriter writer(payload);
+
+    writer.Write<std::uint64_t>(state.Generation);
+    writer.Write<std::int32_t>(state.NextGenomeID);
+    writer.Write<std::int32_t>(state.NextSpeciesID);
+    writer.Write(state.BestEverFitness);
+
+    for(auto genomes : {&state.Genomes, &state.BestGenomes})
+    {
+        writer.Write<std::uint32_t>(genomes->size());
+        for(auto& g : *genomes)
+        {
+            write_genome_entry(writer, g, m_written_genomes);
+        }
+    }
+
+    writer.Write<std::uint32_t>(state.Species.size());
+    for(auto& s : state.Species)
+    {
+        write_genome_entry(writer, s.Leader, m_written_genomes);
+        writer.Write<std::int32_t>(s.ID);
+        writer.Write<std::uint64_t>(s.GensNoImprovement);
+        writer.Write<std::uint64_t>(s.Age);
+        writer.Write(s.SpawnsRequired);
+    }
+
+    const auto& innovations = state.Innovations.Innovations();
+    if(innovations.size() < m_num_written_innovations)
+    {
+        throw std::logic_error("CheckpointLog: innovation database shrank since the last checkpoint");
+    }
+    writer.Write<std::int32_t>(state.Innovations.NextNeuronID());
+    writer.Write<std::int32_t>(state.Innovations.NextInnovationID());
+    writer.Write<std::uint32_t>(m_num_written_innovations);
+    writer.Write<std::uint32_t>(innovations.size() - m_num_written_innovations);
+    for(auto i = m_num_written_innovations; i < innovations.size(); ++i)
+    {
+        encode_innovation(writer, innovations[i]);
+    }
+
+    write_stat(writer, state.NumSpeciesStat);
+    write_stat(writer, state.GenomeLinksStat);
+    write_stat(writer, state.GenomeNeuronStat);
+    write_stat(writer, state.FitnessStat);
+    writer.Write(state.RandomState);
+
+    std::ofstream out(m_path, std::ios::binary | std::ios::app);
+    write_record(out, RecordKind::DELTA, payload);
+    out.close();
+    if(!out)
+    {
+        throw std::ios_base::failure("Can't append to checkpoint log '" + m_path + "'");
+    }
+
+    ++m_num_deltas;
+    m_last_write_size = LOG_RECORD_HEADER_SIZE + payload.size();
+}
+
+
+void CheckpointLog::Remember(const GenAlgState& state)
+{
+    m_written_genomes.clear();
+    for_each_genome(state, [this](const Genome& g) { m_written_genomes.emplace(g.ID(), g); });
+    m_num_written_innovations = state.Innovations.Innovations().size();
+}
+
+
+GenAlgState read_checkpoint_log(const std::string& path)
+{
+    if(!Utils::is_file_exist(path))
+    {
+        throw std::ios_base::failure("Can't read checkpoint log - file '" + path + "' doesn't exist");
+    }
+
+    std::ifstream in(path, std::ios::binary);
+    std::vector<std::uint8_t> buffer((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    BinaryReader header(buffer);
+    if(header.Read<std::uint32_t>() != CHECKPOINT_LOG_MAGIC)
+    {
+        throw std::runtime_error("read_checkpoint_log: not a checkpoint log");
+    }
+    if(header.Read<std::uint16_t>() != CHECKPOINT_LOG_VERSION)
+    {
+        throw std::runtime_error("read_checkpoint_log: unsupported checkpoint log version");
+    }
+
+    // find the last full snapshot, every record before it is obsolete
+    struct Record
+    {
+        RecordKind Kind;
+        std::size_t Offset;
+        std::size_t Size;
+    };
+    std::vector<Record> records;
+    std::size_t pos = CHECKPOINT_LOG_HEADER_SIZE;
+    while(buffer.size() - pos >= LOG_RECORD_HEADER_SIZE)
+    {
+        BinaryReader record_header(buffer.data() + pos, LOG_RECORD_HEADER_SIZE);
+        auto kind = record_header.Read<RecordKind>();
+        auto size = record_header.Read<std::uint64_t>();
+        if(buffer.size() - pos - LOG_RECORD_HEADER_SIZE < size)
+        {
+            // cut short while being written
+            break;
+        }
+        if(kind == RecordKind::FULL)
+        {
+            records.clear();
+        }
+        records.push_back(Record{kind, pos + LOG_RECORD_HEADER_SIZE, size});
+        pos += LOG_RECORD_HEADER_SIZE + size;
+    }
+
+    if(records.empty() || records.front().Kind != RecordKind::FULL)
+    {
+        throw std::runtime_error("read_checkpoint_log: log doesn't contain a full snapshot");
+    }
+
+    auto state = decode_checkpoint(buffer.data() + records.front().Offset, records.front().Size);
+    for(std::size_t i = 1; i < records.size(); ++i)
+    {
+        BinaryReader reader(buffer.data() + records[i].Offset, records[i].Size);
+        apply_delta(state, reader);
+    }
+    return state;
+}
+
+
+void compact_checkpoint_log(const std::string& path)
+{
+    CheckpointLog log(path, 0);
+    log.Write(read_checkpoint_log(path));
+}
+
+
+};
@@ -0,0 +1,523 @@
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <utility>
+
+#include "binformat.h"
+#include "distributed.h"
+
+namespace neat
+{
+
+// jobs sent to a worker ahead of its results - one being evaluated and one
+// waiting in the socket, so workers never sit idle between jobs
+const std::size_t MAX_OUTSTANDING_PER_WORKER = 2;
+const int POLL_TIMEOUT_MS = 100;
+const std::size_t MESSAGE_HEADER_SIZE = 5;
+const std::size_t RECEIVE_CHUNK = 1 << 16;
+
+
+struct SocketAddress
+{
+    sockaddr_storage Storage;
+    socklen_t Length;
+    int Family;
+    std::string UnixPath;
+};
+
+
+static SocketAddress parse_address(const std::string& address)
+{
+    SocketAddress result;
+    std::memset(&result.Storage, 0, sizeof(result.Storage));
+
+    if(address.rfind("unix:", 0) == 0)
+    {
+        auto path = address.substr(5);
+        auto un = reinterpret_cast<sockaddr_un*>(&result.Storage);
+        if(path.empty() || path.size() >= sizeof(un->sun_path))
+        {
+            throw std::invalid_argument("Invalid Unix socket path: '" + path + "'");
+        }
+        un->sun_family = AF_UNIX;
+        std::memcpy(un->sun_path, path.c_str(), path.size() + 1);
+        result.Length = sizeof(sockaddr_un);
+        result.Family = AF_UNIX;
+        result.UnixPath = path;
+    }
+    else if(address.rfind("tcp:", 0) == 0)
+    {
+        auto host_port = address.substr(4);
+        auto colon = host_port.rfind(':');
+        if(colon == std::string::npos)
+        {
+            throw std::invalid_argument("TCP address must be tcp:<host>:<port>, got '" + address + "'");
+        }
+        auto in = reinterpret_cast<sockaddr_in*>(&result.Storage);
+        in->sin_family = AF_INET;
+        in->sin_port = htons(std::stoi(host_port.substr(colon + 1)));
+        if(inet_pton(AF_INET, host_port.substr(0, colon).c_str(), &in->sin_addr) != 1)
+        {
+            throw std::invalid_argument("Invalid IPv4 address in '" + address + "'");
+        }
+        result.Length = sizeof(sockaddr_in);
+        result.Family = AF_INET;
+    }
+    else
+    {
+        throw std::invalid_argument("Address must start with 'unix:' or 'tcp:', got '" + address + "'");
+    }
+    return result;
+}
+
+
+static int open_socket(const SocketAddress& address)
+{
+    int fd = socket(address.Family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if(fd < 0)
+    {
+        throw std::system_error(errno, std::generic_category(), "socket failed");
+    }
+    if(address.Family == AF_INET)
+    {
+        // results are tiny messages that must not wait for more data
+        int on = 1;
+        setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    }
+    return fd;
+}
+
+
+static bool send_all(int fd, const std::vector<std::uint8_t>& data)
+{
+    std::size_t sent = 0;
+    while(sent < data.size())
+    {
+        auto result = send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL);
+        if(result < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if(result <= 0)
+        {
+            return false;
+        }
+        sent += result;
+    }
+    return true;
+}
+
+
+static bool receive_all(int fd, std::uint8_t* data, std::size_t size)
+{
+    std::size_t received = 0;
+    while(received < size)
+    {
+        auto result = recv(fd, data + received, size - received, 0);
+        if(result < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if(result <= 0)
+        {
+            return false;
+        }
+        received += result;
+    }
+    return true;
+}
+
+
+/**
+ * Starts a message in buffer, the caller appends the payload and finishes it
+ * with end_message.
+ */
+static void begin_message(BinaryWriter& writer, MessageType type)
+{
+    writer.Write<std::uint32_t>(0);
+    writer.Write(type);
+}
+
+
+static void end_message(BinaryWriter& writer)
+{
+    writer.WriteAt<std::uint32_t>(0, writer.Size() - MESSAGE_HEADER_SIZE);
+}
+
+
+DistributedEvaluator::DistributedEvaluator(const std::string& address,
+                                           std::chrono::milliseconds worker_timeout): m_listen_fd(-1),
+                                                                                      m_address(address),
+                                                                                      m_unix_path(),
+                                                                                      m_workers(),
+                                                                                      m_worker_timeout(worker_timeout),
+                                                                                      m_num_requeued(0),
+                                                                                      m_next_job_id(0)
+{
+    auto bind_address = parse_address(address);
+    m_listen_fd = open_socket(bind_address);
+
+    if(bind_address.Family == AF_UNIX)
+    {
+        m_unix_path = bind_address.UnixPath;
+        unlink(m_unix_path.c_str());
+    }
+    else
+    {
+        int on = 1;
+        setsockopt(m_listen_fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    }
+
+    if(bind(m_listen_fd, reinterpret_cast<sockaddr*>(&bind_address.Storage), bind_address.Length) != 0 ||
+       listen(m_listen_fd, SOMAXCONN) != 0)
+    {
+        int error = errno;
+        close(m_listen_fd);
+        throw std::system_error(error, std::generic_category(), "DistributedEvaluator can't listen on " + address);
+    }
+
+    if(bind_address.Family == AF_INET)
+    {
+        sockaddr_in bound;
+        socklen_t length = sizeof(bound);
+        getsockname(m_listen_fd, reinterpret_cast<sockaddr*>(&bound), &length);
+        char host[INET_ADDRSTRLEN];
+        inet_ntop(AF_INET, &bound.sin_addr, host, sizeof(host));
+        m_address = "tcp:" + std::string(host) + ":" + std::to_string(ntohs(bound.sin_port));
+    }
+}
+
+
+DistributedEvaluator::~DistributedEvaluator()
+{
+    std::vector<std::uint8_t> shutdown;
+    BinaryWriter writer(shutdown);
+    begin_message(writer, MessageType::SHUTDOWN);
+    end_message(writer);
+
+    for(auto& worker : m_workers)
+    {
+        send_all(worker.Fd, shutdown);
+        close(worker.Fd);
+    }
+    close(m_listen_fd);
+    if(!m_unix_path.empty())
+    {
+        unlink(m_unix_path.c_str());
+    }
+}
+
+
+void DistributedEvaluator::Evaluate(const std::vector<SNeuralNetPtr>& brains, const FitnessReport& report)
+{
+    std::deque<std::size_t> pending;
+    for(std::size_t i = 0; i < brains.size(); ++i)
+    {
+        pending.push_back(i);
+    }
+
+    // network i goes out as job first_job + i; jobs below first_job are left
+    // over from an earlier call that threw and their results are dropped
+    const std::uint64_t first_job = m_next_job_id;
+    m_next_job_id += brains.size();
+
+    std::size_t num_reported = 0;
+    auto counted_report = [&](std::uint64_t job_id, double fitness)
+    {
+        if(job_id >= first_job)
+        {
+            report(job_id - first_job, fitness);
+            ++num_reported;
+        }
+    };
+
+    auto last_worker_seen = std::chrono::steady_clock::now();
+    while(num_reported < brains.size())
+    {
+        if(NumGreeted() > 0)
+        {
+            last_worker_seen = std::chrono::steady_clock::now();
+        }
+        else if(std::chrono::steady_clock::now() - last_worker_seen > m_worker_timeout)
+        {
+            throw std::runtime_error("DistributedEvaluator: no worker connected for "
+                                     + std::to_string(m_worker_timeout.count()) + " ms, "
+                                     + std::to_string(brains.size() - num_reported) + " networks left");
+        }
+
+        std::vector<bool> alive(m_workers.size(), true);
+        for(std::size_t i = 0; i < m_workers.size(); ++i)
+        {
+            auto& worker = m_workers[i];
+            while(worker.Greeted && !pending.empty() && worker.Outstanding.size() < MAX_OUTSTANDING_PER_WORKER)
+            {
+                auto idx = pending.front();
+                pending.pop_front();
+                if(!SendJob(worker, first_job + idx, *brains[idx]))
+                {
+                    alive[i] = false;
+                    break;
+                }
+            }
+        }
+
+        std::vector<pollfd> fds{pollfd{m_listen_fd, POLLIN, 0}};
+        for(auto& worker : m_workers)
+        {
+            fds.push_back(pollfd{worker.Fd, POLLIN, 0});
+        }
+        poll(fds.data(), fds.size(), POLL_TIMEOUT_MS);
+
+        for(std::size_t i = 0; i < m_workers.size(); ++i)
+        {
+            if(alive[i] && fds[i + 1].revents)
+            {
+                alive[i] = Receive(m_workers[i], counted_report);
+            }
+        }
+
+        // whatever a lost worker had not finished goes to the others
+        for(std::size_t i = m_workers.size(); i-- > 0;)
+        {
+            if(!alive[i])
+            {
+                auto& lost = m_workers[i];
+                for(auto job_id = lost.Outstanding.rbegin(); job_id != lost.Outstanding.rend(); ++job_id)
+                {
+                    if(*job_id >= first_job)
+                    {
+                        pending.push_front(*job_id - first_job);
+                        ++m_num_requeued;
+                    }
+                }
+                close(lost.Fd);
+                m_workers.erase(m_workers.begin() + i);
+            }
+        }
+
+        if(fds[0].revents & POLLIN)
+        {
+            Accept();
+        }
+    }
+}
+
+
+std::size_t DistributedEvaluator::WaitForWorkers(std::size_t num_workers, std::chrono::milliseconds timeout)
+{
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+    auto ignore_results = [](std::uint64_t, double) {};
+
+    while(NumGreeted() < num_workers)
+    {
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now());
+        if(remaining.count() <= 0)
+        {
+            break;
+        }
+
+        std::vector<pollfd> fds{pollfd{m_listen_fd, POLLIN, 0}};
+        for(auto& worker : m_workers)
+        {
+            fds.push_back(pollfd{worker.Fd, POLLIN, 0});
+        }
+        poll(fds.data(), fds.size(), std::min<long>(remaining.count(), POLL_TIMEOUT_MS));
+
+        for(std::size_t i = m_workers.size(); i-- > 0;)
+        {
+            if(fds[i + 1].revents && !Receive(m_workers[i], ignore_results))
+            {
+                close(m_workers[i].Fd);
+                m_workers.erase(m_workers.begin() + i);
+            }
+        }
+        if(fds[0].revents & POLLIN)
+        {
+            Accept();
+        }
+    }
+    return NumGreeted();
+}
+
+
+//=================================PRIVATE METHODS==============================
+
+void DistributedEvaluator::Accept()
+{
+    int fd = accept4(m_listen_fd, nullptr, nullptr, SOCK_CLOEXEC);
+    if(fd < 0)
+    {
+        return;
+    }
+
+    int on = 1;
+    setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    m_workers.push_back(Connection{fd, false, {}, {}});
+}
+
+
+/**
+ * Reads whatever the worker sent and handles all complete messages. Returns
+ * false once the connection is gone or the worker misbehaves.
+ */
+bool DistributedEvaluator::Receive(Connection& worker, const ResultReport& report)
+{
+    std::uint8_t chunk[RECEIVE_CHUNK];
+    auto result = recv(worker.Fd, chunk, sizeof(chunk), 0);
+    if(result < 0 && errno == EINTR)
+    {
+        return true;
+    }
+    if(result <= 0)
+    {
+        return false;
+    }
+    worker.Received.insert(worker.Received.end(), chunk, chunk + result);
+
+    // results are reported once the received messages are dealt with, so a
+    // throwing report leaves neither the buffer nor Outstanding behind
+    std::vector<std::pair<std::uint64_t, double>> results;
+    std::size_t consumed = 0;
+    bool well_behaved = true;
+    try
+    {
+        while(well_behaved && worker.Received.size() - consumed >= MESSAGE_HEADER_SIZE)
+        {
+            BinaryReader header(worker.Received.data() + consumed, MESSAGE_HEADER_SIZE);
+            auto size = header.Read<std::uint32_t>();
+            auto type = header.Read<MessageType>();
+            if(worker.Received.size() - consumed - MESSAGE_HEADER_SIZE < size)
+            {
+                break;
+            }
+
+            BinaryReader payload(worker.Received.data() + consumed + MESSAGE_HEADER_SIZE, size);
+            consumed += MESSAGE_HEADER_SIZE + size;
+
+            if(type == MessageType::HELLO)
+            {
+                well_behaved = payload.Read<std::uint32_t>() == PROTOCOL_VERSION;
+                worker.Greeted = well_behaved;
+            }
+            else if(type == MessageType::RESULT)
+            {
+                auto job_id = payload.Read<std::uint64_t>();
+                auto fitness = payload.Read<double>();
+                auto found = std::find(worker.Outstanding.begin(), worker.Outstanding.end(), job_id);
+                well_behaved = found != worker.Outstanding.end();
+                if(well_behaved)
+                {
+                    worker.Outstanding.erase(found);
+                    results.emplace_back(job_id, fitness);
+                }
+            }
+            else
+            {
+                well_behaved = false;
+            }
+        }
+    }
+    catch(const std::runtime_error&)
+    {
+        // truncated payload
+        well_behaved = false;
+    }
+
+    // results that arrived before the worker misbehaved still count
+    worker.Received.erase(worker.Received.begin(), worker.Received.begin() + consumed);
+    for(auto& [job_id, fitness] : results)
+    {
+        report(job_id, fitness);
+    }
+    return well_behaved;
+}
+
+
+bool DistributedEvaluator::SendJob(Connection& worker, std::uint64_t job_id, const NeuralNet& brain)
+{
+    std::vector<std::uint8_t> message;
+    BinaryWriter writer(message);
+    begin_message(writer, MessageType::JOB);
+    writer.Write(job_id);
+    encode_net(writer, brain);
+    end_message(writer);
+
+    // count the job as outstanding even if sending fails, so it gets requeued
+    worker.Outstanding.push_back(job_id);
+    return send_all(worker.Fd, message);
+}
+
+
+std::size_t DistributedEvaluator::NumGreeted() const
+{
+    return std::count_if(m_workers.begin(), m_workers.end(), [](const Connection& c) { return c.Greeted; });
+}
+
+
+std::size_t run_worker(const std::string& address, const FitnessFunc& fitness)
+{
+    auto coordinator = parse_address(address);
+    int fd = open_socket(coordinator);
+    if(connect(fd, reinterpret_cast<sockaddr*>(&coordinator.Storage), coordinator.Length) != 0)
+    {
+        int error = errno;
+        close(fd);
+        throw std::system_error(error, std::generic_category(), "run_worker can't connect to " + address);
+    }
+
+    std::vector<std::uint8_t> message;
+    BinaryWriter writer(message);
+    begin_message(writer, MessageType::HELLO);
+    writer.Write(PROTOCOL_VERSION);
+    end_message(writer);
+
+    std::size_t num_evaluated = 0;
+    std::vector<std::uint8_t> payload;
+    bool connected = send_all(fd, message);
+    while(connected)
+    {
+        std::uint8_t header_data[MESSAGE_HEADER_SIZE];
+        if(!receive_all(fd, header_data, MESSAGE_HEADER_SIZE))
+        {
+            break;
+        }
+        BinaryReader header(header_data, MESSAGE_HEADER_SIZE);
+        auto size = header.Read<std::uint32_t>();
+        auto type = header.Read<MessageType>();
+
+        payload.resize(size);
+        if(!receive_all(fd, payload.data(), size) || type != MessageType::JOB)
+        {
+            break;
+        }
+
+        BinaryReader reader(payload);
+        auto job_id = reader.Read<std::uint64_t>();
+        auto brain = std::make_shared<NeuralNet>(decode_net(reader));
+        double result = fitness(brain);
+        ++num_evaluated;
+
+        message.clear();
+        begin_message(writer, MessageType::RESULT);
+        writer.Write(job_id);
+        writer.Write(result);
+        end_message(writer);
+        connected = send_all(fd, message);
+    }
+
+    close(fd);
+    return num_evaluated;
+}
+
+
+};
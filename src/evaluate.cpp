@@ -0,0 +1,187 @@
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <list>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include "evaluate.h"
+
+namespace neat
+{
+
+// how long AsyncEvaluator sleeps before checking all outstanding futures again
+const std::chrono::milliseconds POLL_INTERVAL(1);
+
+
+ThreadPoolEvaluator::ThreadPoolEvaluator(FitnessFunc fitness,
+                                         std::size_t num_threads): m_fitness(fitness),
+                                                                   m_num_threads(num_threads)
+{
+    if(m_num_threads == 0)
+    {
+        throw std::invalid_argument("ThreadPoolEvaluator needs at least one thread");
+    }
+}
+
+
+void ThreadPoolEvaluator::Evaluate(const std::vector<SNeuralNetPtr>& brains, const FitnessReport& report)
+{
+    std::atomic<std::size_t> next(0);
+    std::mutex report_mutex;
+    std::exception_ptr error;
+
+    auto worker = [&]()
+    {
+        try
+        {
+            for(std::size_t idx = next++; idx < brains.size(); idx = next++)
+            {
+                double fitness = m_fitness(brains[idx]);
+
+                std::lock_guard<std::mutex> lock(report_mutex);
+                report(idx, fitness);
+            }
+        }
+        catch(...)
+        {
+            std::lock_guard<std::mutex> lock(report_mutex);
+            error = std::current_exception();
+            // stop the other workers from picking up more work
+            next = brains.size();
+        }
+    };
+
+    {
+        std::vector<std::jthread> workers;
+        auto num_workers = std::min(m_num_threads, brains.size());
+        for(std::size_t i = 0; i < num_workers; ++i)
+        {
+            workers.emplace_back(worker);
+        }
+    }
+
+    if(error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+
+AsyncEvaluator::AsyncEvaluator(AsyncFitnessFunc fitness,
+                               std::size_t max_in_flight,
+                               std::chrono::milliseconds timeout,
+                               double penalty): m_fitness(fitness),
+                                                m_max_in_flight(max_in_flight),
+                                                m_timeout(timeout),
+                                                m_penalty(penalty),
+                                                m_num_timeouts(0)
+{
+    if(m_max_in_flight == 0)
+    {
+        throw std::invalid_argument("AsyncEvaluator needs to allow at least one evaluation in flight");
+    }
+}
+
+
+void AsyncEvaluator::Evaluate(const std::vector<SNeuralNetPtr>& brains, const FitnessReport& report)
+{
+    using clock = std::chrono::steady_clock;
+
+    struct InFlight
+    {
+        std::size_t Index;
+        std::future<double> Fitness;
+        std::stop_source Stop;
+        clock::time_point Deadline;
+    };
+
+    // The future of a straggler may block in its destructor (std::async), so
+    // it gets waited out on a detached thread instead of stalling the epoch.
+    auto abandon = [](std::future<double>&& fitness)
+    {
+        if(fitness.valid())
+        {
+            std::thread([fitness = std::move(fitness)]() mutable { fitness.wait(); }).detach();
+        }
+    };
+
+    std::list<InFlight> in_flight;
+    std::size_t next = 0;
+
+    try
+    {
+        while(next < brains.size() || !in_flight.empty())
+        {
+            while(in_flight.size() < m_max_in_flight && next < brains.size())
+            {
+                std::stop_source stop;
+                auto fitness = m_fitness(brains[next], stop.get_token());
+
+                // a deferred future would only run inline when asked for its
+                // value, out of reach of the deadline
+                if(fitness.wait_for(std::chrono::seconds(0)) == std::future_status::deferred)
+                {
+                    fitness = std::async(std::launch::async, [fitness = std::move(fitness)]() mutable
+                        {
+                            return fitness.get();
+                        });
+                }
+                in_flight.push_back(InFlight{next, std::move(fitness), std::move(stop), clock::now() + m_timeout});
+                ++next;
+            }
+
+            auto earliest = std::min_element(in_flight.begin(), in_flight.end(),
+                [](const InFlight& lhs, const InFlight& rhs)
+                {
+                    return lhs.Deadline < rhs.Deadline;
+                });
+            earliest->Fitness.wait_until(std::min(earliest->Deadline, clock::now() + POLL_INTERVAL));
+
+            auto now = clock::now();
+            auto current = in_flight.begin();
+            while(current != in_flight.end())
+            {
+                if(current->Fitness.wait_for(std::chrono::seconds(0)) == std::future_status::ready)
+                {
+                    report(current->Index, current->Fitness.get());
+                    current = in_flight.erase(current);
+                }
+                else if(now >= current->Deadline)
+                {
+                    current->Stop.request_stop();
+                    ++m_num_timeouts;
+                    report(current->Index, m_penalty);
+                    abandon(std::move(current->Fitness));
+                    current = in_flight.erase(current);
+                }
+                else
+                {
+                    ++current;
+                }
+            }
+        }
+    }
+    catch(...)
+    {
+        // Stop whatever is still running and give it until its deadline to
+        // notice before passing the error on; the scores reported so far stay.
+        for(auto& flight : in_flight)
+        {
+            flight.Stop.request_stop();
+        }
+        for(auto& flight : in_flight)
+        {
+            if(flight.Fitness.valid() &&
+               flight.Fitness.wait_until(flight.Deadline) != std::future_status::ready)
+            {
+                abandon(std::move(flight.Fitness));
+            }
+        }
+        throw;
+    }
+}
+
+
+};
@@ -1,5 +1,7 @@
+#include <algorithm>
 #include <cassert>
 #include <stdexcept>
+#include <unordered_set>
 
 #include "cpplinq.hpp"
 
@@ -20,12 +22,28 @@ using namespace cpplinq;
  */
 GenAlg::GenAlg(std::size_t num_inputs,
                std::size_t num_outputs,
-               const Params& params): m_generation_count(0),
-                                         m_next_genome_id(0),
-                                         m_next_species_id(0),
-                                         m_best_genomes(),
-                                         m_best_ever_fitness(0.0),
-                                         m_params(params)
+               const Params& params): GenAlg(num_inputs,
+                                             num_outputs,
+                                             params,
+                                             CreateInnovationDB(num_inputs, num_outputs, params))
+{}
+
+GenAlg::GenAlg(std::size_t num_inputs,
+               std::size_t num_outputs): GenAlg(num_inputs, num_outputs, Params())
+{}
+
+GenAlg::GenAlg(std::size_t num_inputs,
+               std::size_t num_outputs,
+               const Params& params,
+               std::shared_ptr<InnovationDB> inno_db): m_inno_db(inno_db),
+                                                       m_generation_count(0),
+                                                       m_next_genome_id(0),
+                                                       m_next_species_id(0),
+                                                       m_best_genomes(),
+                                                       m_best_ever_fitness(0.0),
+                                                       m_params(params),
+                                                       m_fitness_cache(m_params.FitnessCacheSize()),
+                                                       m_num_scored(0)
 {
     m_genomes = range(0, m_params.PopulationSize()) >> select(
         [&](int _)
@@ -33,13 +51,96 @@ GenAlg::GenAlg(std::size_t num_inputs,
                 return Genome(m_next_genome_id++, num_inputs, num_outputs, &m_params);
             })
         >> to_vector();
-    Genome tmp(1, num_inputs, num_outputs, &m_params);
-    m_inno_db = InnovationDB(tmp.NeuronGenes(), tmp.NeuronLinks());
+    IndexGenomes();
 }
 
-GenAlg::GenAlg(std::size_t num_inputs,
-               std::size_t num_outputs): GenAlg(num_inputs, num_outputs, Params())
-{}
+
+GenAlg::GenAlg(const std::vector<Genome>& seeds,
+               const Params& params,
+               const InnovationDB& inno_db): m_inno_db(std::make_shared<InnovationDB>(inno_db)),
+                                             m_generation_count(0),
+                                             m_next_genome_id(0),
+                                             m_next_species_id(0),
+                                             m_best_genomes(),
+                                             m_best_ever_fitness(0.0),
+                                             m_params(params),
+                                             m_fitness_cache(m_params.FitnessCacheSize()),
+                                             m_num_scored(0)
+{
+    if(seeds.empty())
+    {
+        throw std::invalid_argument("GenAlg needs at least one seed genome");
+    }
+    for(auto& seed : seeds)
+    {
+        if(seed.NumInputs() != seeds[0].NumInputs() || seed.NumOutputs() != seeds[0].NumOutputs())
+        {
+            throw std::invalid_argument("GenAlg seed genomes must have the same inputs and outputs");
+        }
+    }
+
+    m_genomes.reserve(m_params.PopulationSize());
+    for(std::size_t i = 0; i < m_params.PopulationSize(); ++i)
+    {
+        auto& seed = seeds[i % seeds.size()];
+        m_genomes.push_back(Genome(m_next_genome_id++,
+                                   seed.NeuronGenes(),
+                                   seed.NeuronLinks(),
+                                   seed.NumInputs(),
+                                   seed.NumOutputs(),
+                                   &m_params));
+    }
+    IndexGenomes();
+}
+
+
+GenAlg::GenAlg(const GenAlgState& state): m_inno_db(std::make_shared<InnovationDB>(state.Innovations)),
+                                          m_generation_count(state.Generation),
+                                          m_next_genome_id(state.NextGenomeID),
+                                          m_next_species_id(state.NextSpeciesID),
+                                          m_best_genomes(),
+                                          m_best_ever_fitness(state.BestEverFitness),
+                                          m_params(state.Parameters),
+                                          m_fitness_cache(m_params.FitnessCacheSize()),
+                                          m_num_scored(0)
+{
+    // genomes in the snapshot point at the parameters of the original GenAlg
+    auto adopt = [this](const Genome& g)
+    {
+        Genome adopted(g.ID(), g.NeuronGenes(), g.NeuronLinks(), g.NumInputs(), g.NumOutputs(), &m_params);
+        adopted.SetParentID(g.ParentID());
+        adopted.SetSpeciesID(g.GetSpeciesID());
+        adopted.SetFitness(g.Fitness());
+        adopted.SetAjustedFitness(g.GetAdjustedFitness());
+        adopted.SetAmountToSpawn(g.AmountToSpawn());
+        return adopted;
+    };
+
+    m_genomes = from(state.Genomes) >> select(adopt) >> to_vector();
+    m_best_genomes = from(state.BestGenomes) >> select(adopt) >> to_vector();
+    for(auto& s : state.Species)
+    {
+        m_species.emplace_back(adopt(s.Leader), s.ID, s.GensNoImprovement, s.Age, s.SpawnsRequired, &m_genomes, &m_params);
+    }
+
+    m_num_species_stat.SetState(state.NumSpeciesStat);
+    m_genome_links_stat.SetState(state.GenomeLinksStat);
+    m_genome_neuron_stat.SetState(state.GenomeNeuronStat);
+    m_fitness_stat.SetState(state.FitnessStat);
+    Utils::DefaultRandom::Instance().SetState(state.RandomState);
+
+    IndexGenomes();
+}
+
+
+std::shared_ptr<InnovationDB> GenAlg::CreateInnovationDB(std::size_t num_inputs,
+                                                         std::size_t num_outputs,
+                                                         const Params& params)
+{
+    Params tmp_params(params);
+    Genome tmp(1, num_inputs, num_outputs, &tmp_params);
+    return std::make_shared<InnovationDB>(tmp.NeuronGenes(), tmp.NeuronLinks());
+}
 
 
 std::vector<SNeuralNetPtr> GenAlg::Epoch(const std::vector<double>& fitness_scores)
@@ -50,29 +151,140 @@ std::vector<SNeuralNetPtr> GenAlg::Epoch(const std::vector<double>& fitness_scor
       throw std::invalid_argument("GenAlg::Epoch number of scores doesn't match number of genomes");
     }
 
+    std::lock_guard<std::mutex> lock(m_submit_mutex);
+    if(m_num_scored > 0)
+    {
+        throw std::logic_error("GenAlg::Epoch can't mix a batch of scores with SubmitFitness");
+    }
+
     // Remove species that have not been improving for configured number of
     // generations
-    PurgeSpecies();
-    UpdateGenomeScores(fitness_scores);
-    // keep in mind the m_genomes vector will be sorted ascendingly after the next
-    // step
-    UpdateBestGenomes();
-    SpeciateGenomes();
-
-    UpdateSpeciesFitness();
-    CalculateSpeciesSpawnAmounts();
-    m_genomes = CreateNewPopulation();
-
-    RunEpochStatistics();
-    RunLongTermStatistics();
-    ++m_generation_count;
+    {
+        PhaseTimer timer(m_profile, EpochPhase::PURGE_SPECIES);
+        PurgeSpecies();
+    }
+    {
+        PhaseTimer timer(m_profile, EpochPhase::UPDATE_GENOME_SCORES);
+        UpdateGenomeScores(fitness_scores);
+    }
+    {
+        PhaseTimer timer(m_profile, EpochPhase::SPECIATE_GENOMES);
+        SpeciateGenomes();
+    }
 
-    return CreateNeuralNetworks();
+    return FinishEpoch();
+}
+
+
+void GenAlg::SubmitFitness(GenomeID id, double fitness)
+{
+    std::lock_guard<std::mutex> lock(m_submit_mutex);
+
+    auto found = m_genome_index.find(id);
+    if(found == m_genome_index.end())
+    {
+        throw std::invalid_argument("GenAlg::SubmitFitness unknown GenomeID: " + std::to_string(id));
+    }
+    if(m_scored[found->second])
+    {
+        throw std::invalid_argument("GenAlg::SubmitFitness genome already scored: " + std::to_string(id));
+    }
+    if(fitness < 0)
+    {
+        throw std::invalid_argument("GenAlg::SubmitFitness fitness must not be negative");
+    }
+
+    // first score of the generation - species get emptied before anybody
+    // joins them, same as in the batch Epoch. Unlike there, genomes join in
+    // the order they are scored rather than fittest first.
+    if(m_num_scored == 0)
+    {
+        PhaseTimer timer(m_profile, EpochPhase::PURGE_SPECIES);
+        PurgeSpecies();
+        m_fitness_stat.Clear();
+    }
+
+    Genome& genome = m_genomes[found->second];
+    genome.SetFitness(fitness);
+    m_fitness_stat.Push(fitness);
+    if(m_fitness_cache.IsEnabled())
+    {
+        m_fitness_cache.Insert(genome.Fingerprint(), fitness);
+    }
+    m_scored[found->second] = true;
+    ++m_num_scored;
+
+    PhaseTimer timer(m_profile, EpochPhase::SPECIATE_GENOMES, true);
+    SpeciateGenome(found->second);
+}
+
+
+std::vector<SNeuralNetPtr> GenAlg::Epoch()
+{
+    std::lock_guard<std::mutex> lock(m_submit_mutex);
+    if(m_num_scored != m_genomes.size())
+    {
+        throw std::logic_error("GenAlg::Epoch " + std::to_string(m_genomes.size() - m_num_scored)
+                               + " genomes have not been scored yet");
+    }
+    return FinishEpoch();
+}
+
+
+std::vector<SNeuralNetPtr> GenAlg::Epoch(const std::vector<SNeuralNetPtr>& brains, IEvaluator& evaluator)
+{
+    if(m_genomes.size() != brains.size())
+    {
+        throw std::invalid_argument("GenAlg::Epoch number of networks doesn't match number of genomes");
+    }
+
+    // genomes found in the cache are scored right away, only the rest is
+    // handed to the evaluator; ones scored by an earlier, failed call are
+    // skipped so a retry carries on from there
+    std::vector<bool> scored;
+    {
+        std::lock_guard<std::mutex> lock(m_submit_mutex);
+        scored = m_scored;
+    }
+    std::vector<GenomeID> ids;
+    std::vector<SNeuralNetPtr> to_evaluate;
+    std::vector<std::pair<GenomeID, double>> cached;
+    for(std::size_t i = 0; i < m_genomes.size(); ++i)
+    {
+        double fitness = 0.0;
+        if(scored[i])
+        {
+            continue;
+        }
+        if(m_fitness_cache.IsEnabled() && m_fitness_cache.Find(m_genomes[i].Fingerprint(), fitness))
+        {
+            cached.emplace_back(m_genomes[i].ID(), fitness);
+        }
+        else
+        {
+            ids.push_back(m_genomes[i].ID());
+            to_evaluate.push_back(brains[i]);
+        }
+    }
+
+    for(auto& [id, fitness] : cached)
+    {
+        SubmitFitness(id, fitness);
+    }
+    if(!to_evaluate.empty())
+    {
+        evaluator.Evaluate(to_evaluate, [&](std::size_t idx, double fitness)
+            {
+                SubmitFitness(ids[idx], fitness);
+            });
+    }
+    return Epoch();
 }
 
 
 std::vector<SNeuralNetPtr> GenAlg::CreateNeuralNetworks()
 {
+    PhaseTimer timer(m_profile, EpochPhase::CREATE_PHENOTYPES);
     return from(m_genomes) >> select([](const Genome& g)
         {
             return std::make_shared<NeuralNet>(g.NeuronGenes(), g.NeuronLinks());
@@ -95,6 +307,80 @@ SNeuralNetPtr GenAlg::BestNN() const
 }
 
 
+void GenAlg::ImportGenomes(const std::vector<Genome>& migrants)
+{
+    std::lock_guard<std::mutex> lock(m_submit_mutex);
+    if(m_num_scored > 0)
+    {
+        throw std::logic_error("GenAlg::ImportGenomes can't replace genomes of a generation being scored");
+    }
+    if(migrants.size() > m_genomes.size())
+    {
+        throw std::invalid_argument("GenAlg::ImportGenomes more migrants than genomes in the population");
+    }
+
+    auto replaced = m_genomes.end() - migrants.size();
+    for(auto& migrant : migrants)
+    {
+        *replaced++ = Genome(m_next_genome_id++,
+                             migrant.NeuronGenes(),
+                             migrant.NeuronLinks(),
+                             migrant.NumInputs(),
+                             migrant.NumOutputs(),
+                             &m_params);
+    }
+    IndexGenomes();
+}
+
+
+GenAlgState GenAlg::Snapshot()
+{
+    std::lock_guard<std::mutex> lock(m_submit_mutex);
+    if(m_num_scored > 0)
+    {
+        throw std::logic_error("GenAlg::Snapshot can't capture a generation being scored");
+    }
+
+    GenAlgState state;
+    state.Parameters = m_params;
+    state.Generation = m_generation_count;
+    state.NextGenomeID = m_next_genome_id;
+    state.NextSpeciesID = m_next_species_id;
+    state.BestEverFitness = m_best_ever_fitness;
+    state.Genomes = m_genomes;
+    state.BestGenomes = m_best_genomes;
+    for(auto& s : m_species)
+    {
+        state.Species.push_back(SpeciesState{s.Leader(), s.ID(), s.GensNoImprovement(), s.Age(), s.SpawnsRequired()});
+    }
+    {
+        std::lock_guard<InnovationDB> inno_lock(*m_inno_db);
+        state.Innovations = *m_inno_db;
+    }
+    state.NumSpeciesStat = m_num_species_stat.GetState();
+    state.GenomeLinksStat = m_genome_links_stat.GetState();
+    state.GenomeNeuronStat = m_genome_neuron_stat.GetState();
+    state.FitnessStat = m_fitness_stat.GetState();
+    state.RandomState = Utils::DefaultRandom::Instance().GetState();
+    return state;
+}
+
+
+void GenAlg::SaveCheckpoint(const std::string& path)
+{
+    write_checkpoint(path, Snapshot());
+}
+
+
+std::future<void> GenAlg::SaveCheckpointAsync(const std::string& path)
+{
+    return std::async(std::launch::async, [state = Snapshot(), path]()
+        {
+            write_checkpoint(path, state);
+        });
+}
+
+
 const Species* const GenAlg::GetSpecie(SpeciesID id) const
 {
     for(auto& s : m_species)
@@ -110,6 +396,61 @@ const Species* const GenAlg::GetSpecie(SpeciesID id) const
 
 //=================================PRIVATE METHODS==============================
 
+/**
+ * Everything Epoch has to do once all genomes have a score and belong to a
+ * species.
+ */
+std::vector<SNeuralNetPtr> GenAlg::FinishEpoch()
+{
+    {
+        PhaseTimer timer(m_profile, EpochPhase::UPDATE_BEST_GENOMES);
+        UpdateBestGenomes();
+    }
+
+    {
+        PhaseTimer timer(m_profile, EpochPhase::UPDATE_SPECIES_FITNESS);
+        PartitionSpecies();
+        UpdateSpeciesFitness();
+    }
+    {
+        PhaseTimer timer(m_profile, EpochPhase::CALCULATE_SPAWN_AMOUNTS);
+        CalculateSpeciesSpawnAmounts();
+    }
+    {
+        PhaseTimer timer(m_profile, EpochPhase::CREATE_NEW_POPULATION);
+        auto new_population = CreateNewPopulation();
+        // the leaders are still part of the old population
+        for(auto& s : m_species)
+        {
+            s.KeepLeader();
+        }
+        m_genomes = std::move(new_population);
+        IndexGenomes();
+    }
+    {
+        PhaseTimer timer(m_profile, EpochPhase::STATISTICS);
+        RunEpochStatistics();
+        RunLongTermStatistics();
+    }
+    ++m_generation_count;
+
+    auto brains = CreateNeuralNetworks();
+    m_profile.FinishEpoch();
+    return brains;
+}
+
+void GenAlg::IndexGenomes()
+{
+    m_genome_index.clear();
+    for(std::size_t i = 0; i < m_genomes.size(); ++i)
+    {
+        m_genome_index[m_genomes[i].ID()] = i;
+    }
+    m_scored.assign(m_genomes.size(), false);
+    m_num_scored = 0;
+}
+
+
 void GenAlg::RunEpochStatistics()
 {
     m_genome_links_stat.Clear();
@@ -148,51 +489,139 @@ void GenAlg::PurgeSpecies()
 
 void GenAlg::UpdateGenomeScores(const std::vector<double>& fitness_scores)
 {
+    m_fitness_stat.Clear();
     for(int i = 0; i < m_genomes.size(); ++i)
     {
         assert(fitness_scores[i] >= 0);
         m_genomes[i].SetFitness(fitness_scores[i]);
+        m_fitness_stat.Push(fitness_scores[i]);
+        if(m_fitness_cache.IsEnabled())
+        {
+            m_fitness_cache.Insert(m_genomes[i].Fingerprint(), fitness_scores[i]);
+        }
     }
-    std::sort(m_genomes.begin(), m_genomes.end());
+    m_scored.assign(m_genomes.size(), true);
+    m_num_scored = m_genomes.size();
 }
 
+/**
+ * Genomes stay in the order they were created in, only the elites are
+ * selected by fitness.
+ */
 void GenAlg::UpdateBestGenomes()
 {
-    m_best_genomes.clear();
-    m_best_ever_fitness = std::max(m_best_ever_fitness, m_genomes[0].Fitness());
+    std::vector<const Genome*> ranked = from(m_genomes)
+        >> select([](const Genome& g) { return &g; })
+        >> to_vector();
+
+    auto num_best_genomes = std::min<std::size_t>(m_params.NumBestGenomes(), ranked.size());
+    std::partial_sort(ranked.begin(),
+                      ranked.begin() + num_best_genomes,
+                      ranked.end(),
+                      [](const Genome* lhs, const Genome* rhs) { return *lhs < *rhs; });
 
-    auto num_best_genomes = m_params.NumBestGenomes();
+    m_best_genomes.clear();
+    m_best_ever_fitness = std::max(m_best_ever_fitness, ranked[0]->Fitness());
     for(int i = 0; i < num_best_genomes; ++i)
     {
-        m_best_genomes.push_back(m_genomes[i]);
+        m_best_genomes.push_back(*ranked[i]);
     }
 }
 
+/**
+ * Genomes join species from fittest to weakest, so the fittest genomes found
+ * the new species. Only their order is sorted, the genomes stay in place.
+ */
 void GenAlg::SpeciateGenomes()
 {
-    bool added = false;
+    std::vector<std::size_t> order(m_genomes.size());
+    for(std::size_t i = 0; i < order.size(); ++i)
+    {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [this](std::size_t lhs, std::size_t rhs)
+        {
+            return m_genomes[lhs] < m_genomes[rhs];
+        });
+
+    for(auto idx : order)
+    {
+        SpeciateGenome(idx);
+    }
+}
+
+void GenAlg::SpeciateGenome(std::size_t idx)
+{
+    Genome& genome = m_genomes[idx];
     auto compatibility_threshold = m_params.CompatibilityThreshold();
-    for(auto& genome : m_genomes)
+    for(auto& species : m_species)
     {
-        for(auto& species : m_species)
+        double diff_score = genome.CalculateDifferenceScore(species.Leader());
+        if(diff_score <= compatibility_threshold)
         {
-            double diff_score = genome.CalculateDifferenceScore(species.Leader());
-            if(diff_score <= compatibility_threshold)
-            {
-                species.AddMember(genome);
-                genome.SetSpeciesID(species.ID());
-                added = true;
-                break;
-            }
+            species.AddMember(idx);
+            genome.SetSpeciesID(species.ID());
+            return;
         }
+    }
+
+    Species new_species(idx, &m_genomes, m_next_species_id++, &m_params);
+    genome.SetSpeciesID(new_species.ID());
+    m_species.push_back(new_species);
+}
+
+/**
+ * Reorders the population so the members of every species are next to each
+ * other, in the order of m_species and from fittest to weakest within a
+ * species, as Species::Spawn expects. Equally fit members keep the order
+ * they joined in. Genomes are moved, not copied.
+ */
+void GenAlg::PartitionSpecies()
+{
+    std::unordered_map<int, std::size_t> species_position;
+    for(std::size_t i = 0; i < m_species.size(); ++i)
+    {
+        species_position[m_species[i].ID()] = i;
+    }
+    std::vector<std::size_t> group(m_genomes.size());
+    for(std::size_t i = 0; i < m_genomes.size(); ++i)
+    {
+        group[i] = species_position.at(m_genomes[i].GetSpeciesID());
+    }
 
-        if(!added)
+    std::vector<std::size_t> order(m_genomes.size());
+    for(std::size_t i = 0; i < order.size(); ++i)
+    {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](std::size_t lhs, std::size_t rhs)
         {
-            Species new_species(genome, m_next_species_id++, &m_params);
-            genome.SetSpeciesID(new_species.ID());
-            m_species.push_back(new_species);
-        }
-        added = false;
+            if(group[lhs] != group[rhs])
+            {
+                return group[lhs] < group[rhs];
+            }
+            return m_genomes[lhs] < m_genomes[rhs];
+        });
+
+    std::vector<Genome> partitioned;
+    partitioned.reserve(m_genomes.size());
+    std::vector<std::size_t> new_positions(m_genomes.size());
+    for(auto idx : order)
+    {
+        new_positions[idx] = partitioned.size();
+        partitioned.push_back(std::move(m_genomes[idx]));
+    }
+    m_genomes = std::move(partitioned);
+
+    std::size_t first = 0;
+    for(auto& s : m_species)
+    {
+        s.SetMembers(first, new_positions);
+        first += s.Size();
+    }
+    for(std::size_t i = 0; i < m_genomes.size(); ++i)
+    {
+        m_genome_index[m_genomes[i].ID()] = i;
     }
 }
 
@@ -207,13 +636,13 @@ void GenAlg::UpdateSpeciesFitness()
 /**
  * This method depends on UpdateSpeciesFitness implicitly. Updating species
  * fitness actually adjusts the fitness of each member genome. Class Species
- * holds a vector of POINTERS to genomes within GenAlg, so by the time this
+ * holds the INDICES of its members within m_genomes, so by the time this
  * method should be called all genomes must contain their new adjusted fitness.
  */
 void GenAlg::CalculateSpeciesSpawnAmounts()
 {
     Utils::RunningStat rs;
-    from(m_genomes) >> for_each( [&rs](const Genome g) { rs.Push(g.GetAdjustedFitness()); });
+    from(m_genomes) >> for_each( [&rs](const Genome& g) { rs.Push(g.GetAdjustedFitness()); });
 
     for(auto& g : m_genomes)
     {
@@ -224,6 +653,7 @@ void GenAlg::CalculateSpeciesSpawnAmounts()
     for(auto& s : m_species)
     {
         s.CalculateSpawnAmount();
+        s.PrepareSelection();
     }
 }
 
@@ -244,6 +674,9 @@ std::vector<Genome> GenAlg::CreateNewPopulation()
 
     Genome baby;
     auto total_num_spawned = new_pop.size();
+    // a genome may have become the leader of two species, only one of its
+    // copies keeps the ID
+    std::unordered_set<int> leader_ids;
     for(auto& species : m_species)
     {
         // break out if the population is large enough
@@ -256,13 +689,22 @@ std::vector<Genome> GenAlg::CreateNewPopulation()
             if(!leader_taken)
             {
                 baby = species.Leader();
+                if(!leader_ids.insert(baby.ID()).second)
+                {
+                    baby.SetParentID(baby.ID());
+                    baby.SetID(m_next_genome_id++);
+                }
                 leader_taken = true;
             }
             else
             {
+                // the database may be shared with GenAlgs on other threads
+                std::lock_guard<InnovationDB> inno_lock(*m_inno_db);
+
                 if(species.Size() == 1)
                 {
                     baby = *species.Spawn();
+                    baby.SetParentID(baby.ID());
                     baby.SetID(m_next_genome_id++);
                 }
                 else if(species.Size() > 1)
@@ -272,27 +714,33 @@ std::vector<Genome> GenAlg::CreateNewPopulation()
                 else
                 {
                     baby = *species.Spawn();
+                    baby.SetParentID(baby.ID());
                     baby.SetID(m_next_genome_id++);
                 }
 
                 if(baby.NumHiddenNeurons() < m_params.MaxNeurons())
                 {
                     baby.AddNeuron(m_params.AddNeuronChance(),
-                                   m_inno_db,
+                                   *m_inno_db,
                                    m_params.NumFindOldLinkAttempts());
                 }
 
                 baby.AddLink(m_params.AddLinkChance(),
                              m_params.AddRecurLinkChance(),
-                             m_inno_db,
+                             *m_inno_db,
                              m_params.NumAddRecurLinkAttempts(),
                              m_params.NumAddLinkAttempts());
 
-                baby.MutateWeights(m_params.MutationChance(),
-                                   m_params.NewWeightChance(),
-                                   m_params.MaxPerturbation());
-                baby.MutateActivationResponse(m_params.ActivationMutationChance(),
-                                              m_params.MaxActivationPerturbation());
+                baby.MutateWeights(MutationSpec{m_params.MutationChance(),
+                                                m_params.NewWeightChance(),
+                                                m_params.MaxPerturbation(),
+                                                m_params.Perturbation(),
+                                                m_params.WeightLimit()});
+                baby.MutateActivationResponse(MutationSpec{m_params.ActivationMutationChance(),
+                                                           0.0,
+                                                           m_params.MaxActivationPerturbation(),
+                                                           m_params.Perturbation(),
+                                                           0.0});
             }
             baby.SortLinks();
 
@@ -308,10 +756,38 @@ std::vector<Genome> GenAlg::CreateNewPopulation()
 
     if(new_pop.size() < population_size)
     {
+        // the rest is picked from the whole population, by tournament or by
+        // the configured selection
+        std::vector<std::size_t> ranked;
+        Utils::AliasTable parents;
+        if(m_params.Selection() != SelectionType::TRUNCATION)
+        {
+            ranked.resize(m_genomes.size());
+            for(std::size_t i = 0; i < ranked.size(); ++i)
+            {
+                ranked[i] = i;
+            }
+            std::stable_sort(ranked.begin(), ranked.end(), [this](std::size_t lhs, std::size_t rhs)
+                {
+                    return m_genomes[lhs] < m_genomes[rhs];
+                });
+            std::vector<double> fitness = from(ranked)
+                >> select([this](std::size_t idx) { return m_genomes[idx].Fitness(); })
+                >> to_vector();
+            parents.Build(selection_weights(m_params, fitness));
+        }
+
         auto rqrd = population_size - new_pop.size();
         while(rqrd > 0)
         {
-            new_pop.push_back(TournamentSelect(m_genomes.size() / 5));
+            // every genome of a generation must have a unique ID for
+            // SubmitFitness, so the winner can't keep the one it had
+            Genome winner = parents.Empty()
+                ? TournamentSelect(m_genomes.size() / 5)
+                : m_genomes[ranked[parents.Sample(Utils::DefaultRandom::Instance())]];
+            winner.SetParentID(winner.ID());
+            winner.SetID(m_next_genome_id++);
+            new_pop.push_back(winner);
             --rqrd;
         }
     }
@@ -336,7 +812,7 @@ Genome GenAlg::MakeCrossoverBaby(Species& species, GenomeID next_id, Genome& pre
 
         if(dad->ID() != mom->ID())
         {
-            baby = dad->Crossover(*mom, m_inno_db, next_id);
+            baby = dad->Crossover(*mom, *m_inno_db, next_id);
         }
         else
         {
@@ -346,6 +822,7 @@ Genome GenAlg::MakeCrossoverBaby(Species& species, GenomeID next_id, Genome& pre
     else
     {
         baby = *mom;
+        baby.SetParentID(mom->ID());
     }
 
     baby.SetID(next_id);
@@ -43,4 +43,29 @@ std::string to_string(const NeuronType& nt)
     }
 }
 
+
+NeuronType neuron_type_from_string(const std::string& type)
+{
+    if(type == "BIAS")
+    {
+        return NeuronType::BIAS;
+    }
+    else if(type == "HIDDEN")
+    {
+        return NeuronType::HIDDEN;
+    }
+    else if(type == "INPUT")
+    {
+        return NeuronType::INPUT;
+    }
+    else if(type == "OUTPUT")
+    {
+        return NeuronType::OUTPUT;
+    }
+    else
+    {
+        return NeuronType::NONE;
+    }
+}
+
 };
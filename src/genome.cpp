@@ -1,4 +1,6 @@
 #include <cassert>
+#include <cstdint>
+#include <cstring>
 #include <set>
 
 #include "cpplinq.hpp"
@@ -11,6 +13,7 @@ namespace neat
 
 //=========================== Constructors ===================================
 Genome::Genome(GenomeID id, std::size_t inputs, std::size_t outputs, Params* params):m_genome_id(id),
+                                               m_parent_id(-1),
                                                m_fitness(0),
                                                m_adjusted_fitness(0),
                                                m_num_inputs(inputs),
@@ -64,6 +67,7 @@ Genome::Genome(GenomeID id,
                std::size_t num_inputs,
                std::size_t num_outputs,
                Params* params):m_genome_id(id),
+                               m_parent_id(-1),
                                m_neuron_genes(neuron_genes),
                                m_link_genes(link_genes),
                                m_fitness(0),
@@ -76,7 +80,83 @@ Genome::Genome(GenomeID id,
 {}
 
 
+Genome::Genome(const nlohmann::json& object, Params* params): m_genome_id(object.at("ID").get<int>()),
+                                                             m_parent_id(-1),
+                                                             m_fitness(object.at("Fitness").get<double>()),
+                                                             m_adjusted_fitness(object.at("AdjustedFitness").get<double>()),
+                                                             m_amount_to_spawn(object.at("AmountToSpawn").get<double>()),
+                                                             m_num_inputs(object.at("NumInputs").get<std::size_t>()),
+                                                             m_num_outputs(object.at("NumOutputs").get<std::size_t>()),
+                                                             m_species_id(object.at("SpeciesID").get<int>()),
+                                                             m_params(params)
+{
+    for(const auto& j : object.at("Neurons"))
+    {
+        NeuronGene ng(neuron_type_from_string(j.at("Type").get_ref<const std::string&>()),
+                      j.at("ID").get<int>(),
+                      j.at("SplitY").get<double>(),
+                      j.at("SplitX").get<double>(),
+                      j.at("IsRecurrent").get<bool>());
+        ng.ActivationResponse = j.at("ActivationResponse").get<double>();
+        m_neuron_genes.push_back(ng);
+    }
+
+    for(const auto& j : object.at("Links"))
+    {
+        m_link_genes.push_back(LinkGene(j.at("FromID").get<int>(),
+                                        j.at("ToID").get<int>(),
+                                        j.at("Weight").get<double>(),
+                                        j.at("IsEnabled").get<bool>(),
+                                        j.at("InnovationID").get<int>(),
+                                        j.at("IsRecurrent").get<bool>()));
+    }
+}
+
+
 //================================ PUBLIC METHODS =================================
+nlohmann::json Genome::serialize() const
+{
+    nlohmann::json neurons = nlohmann::json::array();
+    for(const auto& ng : m_neuron_genes)
+    {
+        neurons.push_back({
+            {"Type", to_string(ng.Type)},
+            {"ID", (int)ng.ID},
+            {"IsRecurrent", ng.IsRecurrent},
+            {"ActivationResponse", ng.ActivationResponse},
+            {"SplitX", ng.SplitX},
+            {"SplitY", ng.SplitY}
+        });
+    }
+
+    nlohmann::json links = nlohmann::json::array();
+    for(const auto& lg : m_link_genes)
+    {
+        links.push_back({
+            {"FromID", (int)lg.FromNeuronID},
+            {"ToID", (int)lg.ToNeuronID},
+            {"Weight", lg.Weight},
+            {"IsEnabled", lg.IsEnabled},
+            {"IsRecurrent", lg.IsRecurrent},
+            {"InnovationID", (int)lg.InnovID}
+        });
+    }
+
+    nlohmann::json object = {
+        {"ID", (int)m_genome_id},
+        {"NumInputs", m_num_inputs},
+        {"NumOutputs", m_num_outputs},
+        {"SpeciesID", (int)m_species_id},
+        {"Fitness", m_fitness},
+        {"AdjustedFitness", m_adjusted_fitness},
+        {"AmountToSpawn", m_amount_to_spawn},
+        {"Neurons", neurons},
+        {"Links", links}
+    };
+    return object;
+}
+
+
 bool Genome::AddNeuron(double mutation_prob,
                        InnovationDB& inno_db,
                        int num_trys_to_find_old_link)
@@ -328,34 +408,49 @@ void Genome::ConnectNeurons(NeuronID neuron_id_from, NeuronID neuron_id_to, Inno
 
 void Genome::MutateWeights(double mutation_prob, double prob_new_weight, double max_perturbation)
 {
-    auto& random = Utils::DefaultRandom::Instance();
-    for(auto& link_gene : m_link_genes)
+    MutateWeights(MutationSpec{mutation_prob, prob_new_weight, max_perturbation, PerturbationType::UNIFORM, 0.0});
+}
+
+
+void Genome::MutateWeights(const MutationSpec& spec)
+{
+    // the genes hold more than the weights, so they are gathered for the
+    // kernel and written back
+    thread_local std::vector<double> weights;
+    weights.resize(m_link_genes.size());
+    for(std::size_t i = 0; i < m_link_genes.size(); ++i)
     {
-        if(random.RandomDouble() < mutation_prob)
-        {
-            if(random.RandomDouble() < prob_new_weight)
-            {
-                link_gene.Weight = random.RandomClamped(-1.0, 1.0);
-            }
-            else
-            {
-                double perturbation = random.RandomClamped(-1.0, 1.0) * max_perturbation;
-                link_gene.Weight += perturbation;
-            }
-        }
+        weights[i] = m_link_genes[i].Weight;
+    }
+    mutate_values(weights.data(), weights.size(), spec);
+    for(std::size_t i = 0; i < m_link_genes.size(); ++i)
+    {
+        m_link_genes[i].Weight = weights[i];
     }
 }
 
 
 void Genome::MutateActivationResponse(double mutation_prob, double max_perturbation)
 {
-    auto& random = Utils::DefaultRandom::Instance();
-    for(auto& neuron_gene : m_neuron_genes)
+    MutateActivationResponse(MutationSpec{mutation_prob, 0.0, max_perturbation, PerturbationType::UNIFORM, 0.0});
+}
+
+
+void Genome::MutateActivationResponse(const MutationSpec& spec)
+{
+    MutationSpec perturb_only = spec;
+    perturb_only.ReplaceProb = 0.0;
+
+    thread_local std::vector<double> responses;
+    responses.resize(m_neuron_genes.size());
+    for(std::size_t i = 0; i < m_neuron_genes.size(); ++i)
     {
-        if(random.RandomDouble() < mutation_prob)
-        {
-            neuron_gene.ActivationResponse += random.RandomClamped(-1.0, 1.0) * max_perturbation;
-        }
+        responses[i] = m_neuron_genes[i].ActivationResponse;
+    }
+    mutate_values(responses.data(), responses.size(), perturb_only);
+    for(std::size_t i = 0; i < m_neuron_genes.size(); ++i)
+    {
+        m_neuron_genes[i].ActivationResponse = responses[i];
     }
 }
 
@@ -561,6 +656,7 @@ Genome Genome::Crossover(const Genome& mom, const InnovationDB& inno_db, GenomeI
                 m_params);
 
     baby.SetSpeciesID(best == MOM ? mom.GetSpeciesID() : dad.GetSpeciesID());
+    baby.SetParentID(best == MOM ? mom.ID() : dad.ID());
     return baby;
 }
 
@@ -570,6 +666,59 @@ void Genome::SortLinks()
 }
 
 
+namespace
+{
+    // splitmix64 finalizer, mixes every bit of value into the hash
+    std::uint64_t hash_combine(std::uint64_t hash, std::uint64_t value)
+    {
+        std::uint64_t z = hash ^ (value + 0x9E3779B97F4A7C15ULL + (hash << 6) + (hash >> 2));
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    std::uint64_t double_bits(double value)
+    {
+        // -0.0 and 0.0 give the same network
+        value = value == 0.0 ? 0.0 : value;
+        std::uint64_t bits;
+        std::memcpy(&bits, &value, sizeof(bits));
+        return bits;
+    }
+}
+
+
+std::uint64_t Genome::Fingerprint() const
+{
+    std::uint64_t hash = hash_combine(m_num_inputs, m_num_outputs);
+
+    // neurons are activated in the order of their genes, so the order counts
+    for(auto& neuron : m_neuron_genes)
+    {
+        hash = hash_combine(hash, static_cast<int>(neuron.ID));
+        hash = hash_combine(hash, double_bits(neuron.ActivationResponse));
+    }
+
+    std::vector<const LinkGene*> enabled;
+    enabled.reserve(m_link_genes.size());
+    for(auto& link : m_link_genes)
+    {
+        if(link.IsEnabled)
+        {
+            enabled.push_back(&link);
+        }
+    }
+    std::sort(enabled.begin(), enabled.end(), [](const LinkGene* lhs, const LinkGene* rhs) { return *lhs < *rhs; });
+
+    for(auto link : enabled)
+    {
+        hash = hash_combine(hash, static_cast<int>(link->InnovID));
+        hash = hash_combine(hash, double_bits(link->Weight));
+    }
+    return hash;
+}
+
+
 std::string to_string(const Genome& genome)
 {
     using std::to_string;
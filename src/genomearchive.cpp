@@ -0,0 +1,123 @@
+#include <fstream>
+#include <stdexcept>
+
+#include "binary.h"
+#include "binformat.h"
+#include "genomearchive.h"
+
+namespace neat
+{
+
+const std::size_t GENOME_INDEX_ENTRY_SIZE = 32;
+
+
+void write_genome_archive(const std::string& path,
+                          const std::vector<Genome>& genomes,
+                          const InnovationDB& inno_db)
+{
+    std::ofstream out(path, std::ios::binary);
+    std::vector<std::uint8_t> buffer(ARCHIVE_HEADER_SIZE, 0);
+    BinaryWriter innovations(buffer);
+    encode_innovations(innovations, inno_db);
+    out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+
+    std::vector<std::uint8_t> index;
+    BinaryWriter index_writer(index);
+    std::uint64_t offset = buffer.size();
+    for(auto& g : genomes)
+    {
+        buffer.clear();
+        BinaryWriter writer(buffer);
+        encode_genome(writer, g);
+        out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+
+        index_writer.Write(offset);
+        index_writer.Write<std::uint64_t>(buffer.size());
+        index_writer.Write<std::int32_t>(g.ID());
+        index_writer.Write<std::int32_t>(g.GetSpeciesID());
+        index_writer.Write(g.Fitness());
+        offset += buffer.size();
+    }
+    out.write(reinterpret_cast<const char*>(index.data()), index.size());
+
+    buffer.clear();
+    BinaryWriter header(buffer);
+    header.Write(GENOME_ARCHIVE_MAGIC);
+    header.Write(GENOME_ARCHIVE_VERSION);
+    header.Write<std::uint16_t>(0);
+    header.Write<std::uint64_t>(genomes.size());
+    header.Write(offset);
+    header.Write<std::uint64_t>(offset + index.size());
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+
+    out.close();
+    if(!out)
+    {
+        throw std::ios_base::failure("Can't write genome archive '" + path + "'");
+    }
+}
+
+
+GenomeArchive::GenomeArchive(const std::string& path): m_file(path, GENOME_ARCHIVE_MAGIC, GENOME_ARCHIVE_VERSION,
+                                                               GENOME_INDEX_ENTRY_SIZE, "GenomeArchive", "genome")
+{
+}
+
+
+GenomeID GenomeArchive::ID(std::size_t idx) const
+{
+    BinaryReader entry(m_file.Entry(idx) + 16, 4);
+    return entry.Read<std::int32_t>();
+}
+
+
+SpeciesID GenomeArchive::GetSpeciesID(std::size_t idx) const
+{
+    BinaryReader entry(m_file.Entry(idx) + 20, 4);
+    return entry.Read<std::int32_t>();
+}
+
+
+double GenomeArchive::Fitness(std::size_t idx) const
+{
+    BinaryReader entry(m_file.Entry(idx) + 24, 8);
+    return entry.Read<double>();
+}
+
+
+Genome GenomeArchive::Load(std::size_t idx, Params* params) const
+{
+    BinaryReader entry(m_file.Entry(idx), 16);
+    auto offset = entry.Read<std::uint64_t>();
+    auto size = entry.Read<std::uint64_t>();
+    if(offset < ARCHIVE_HEADER_SIZE || offset > m_file.Size() || size > m_file.Size() - offset)
+    {
+        throw std::runtime_error("GenomeArchive: corrupt index entry");
+    }
+
+    BinaryReader reader(m_file.Data() + offset, size);
+    return decode_genome(reader, params);
+}
+
+
+std::vector<Genome> GenomeArchive::LoadAll(Params* params) const
+{
+    std::vector<Genome> genomes;
+    genomes.reserve(m_file.NumEntries());
+    for(std::size_t i = 0; i < m_file.NumEntries(); ++i)
+    {
+        genomes.push_back(Load(i, params));
+    }
+    return genomes;
+}
+
+
+InnovationDB GenomeArchive::Innovations() const
+{
+    BinaryReader reader(m_file.Data() + ARCHIVE_HEADER_SIZE, m_file.Size() - ARCHIVE_HEADER_SIZE);
+    return decode_innovations(reader);
+}
+
+
+};
@@ -0,0 +1,196 @@
+#include <atomic>
+#include <barrier>
+#include <exception>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+
+#include "cpplinq.hpp"
+
+#include "island.h"
+
+namespace neat
+{
+
+using namespace cpplinq;
+
+
+IslandGenAlg::IslandGenAlg(std::size_t num_inputs,
+                           std::size_t num_outputs,
+                           const Params& params,
+                           std::size_t num_islands,
+                           std::size_t migration_interval,
+                           std::size_t num_migrants,
+                           MigrationTopology topology): m_islands(),
+                                                        m_brains(),
+                                                        m_migration_interval(migration_interval),
+                                                        m_num_migrants(num_migrants),
+                                                        m_topology(topology),
+                                                        m_num_migrations(0)
+{
+    if(num_islands == 0)
+    {
+        throw std::invalid_argument("IslandGenAlg needs at least one island");
+    }
+    if(migration_interval == 0)
+    {
+        throw std::invalid_argument("IslandGenAlg migration interval must be at least one generation");
+    }
+
+    // all islands describe their genes through the same innovations, so a
+    // migrant means the same thing on every island
+    m_inno_db = GenAlg::CreateInnovationDB(num_inputs, num_outputs, params);
+
+    for(std::size_t i = 0; i < num_islands; ++i)
+    {
+        m_islands.push_back(std::make_unique<GenAlg>(num_inputs, num_outputs, params, m_inno_db));
+        m_brains.push_back(m_islands.back()->CreateNeuralNetworks());
+    }
+}
+
+
+void IslandGenAlg::Evolve(std::size_t num_generations, const FitnessFunc& fitness)
+{
+    std::atomic<bool> failed(false);
+    std::exception_ptr error;
+    std::mutex error_mutex;
+
+    // runs on one of the island threads while all others wait at the
+    // barrier, which must not throw; a failed migration ends the evolution
+    auto end_of_generation = [this, &failed, &error, &error_mutex]() noexcept
+    {
+        try
+        {
+            if(!failed && Generation() % m_migration_interval == 0)
+            {
+                Migrate();
+            }
+        }
+        catch(...)
+        {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            error = std::current_exception();
+            failed = true;
+        }
+    };
+    std::barrier sync(m_islands.size(), end_of_generation);
+
+    auto evolve_island = [&](std::size_t idx)
+    {
+        GenAlg& island = *m_islands[idx];
+        try
+        {
+            for(std::size_t gen = 0; gen < num_generations && !failed; ++gen)
+            {
+                std::vector<double> scores = from(m_brains[idx])
+                    >> select([&fitness](SNeuralNetPtr brain) { return fitness(brain); })
+                    >> to_vector();
+                m_brains[idx] = island.Epoch(scores);
+                sync.arrive_and_wait();
+            }
+        }
+        catch(...)
+        {
+            std::lock_guard<std::mutex> lock(error_mutex);
+            error = std::current_exception();
+            failed = true;
+            sync.arrive_and_drop();
+        }
+    };
+
+    {
+        std::vector<std::jthread> threads;
+        for(std::size_t i = 0; i < m_islands.size(); ++i)
+        {
+            threads.emplace_back(evolve_island, i);
+        }
+    }
+
+    if(error)
+    {
+        std::rethrow_exception(error);
+    }
+}
+
+
+double IslandGenAlg::BestEverFitness() const
+{
+    return from(m_islands)
+        >> select([](const std::unique_ptr<GenAlg>& island) { return island->BestEverFitness(); })
+        >> max();
+}
+
+
+Genome IslandGenAlg::BestGenome() const
+{
+    const Genome* best = nullptr;
+    for(auto& island : m_islands)
+    {
+        auto& candidates = island->BestGenomes();
+        if(!candidates.empty() && (!best || candidates[0] < *best))
+        {
+            best = &candidates[0];
+        }
+    }
+
+    if(!best)
+    {
+        throw std::logic_error("IslandGenAlg::BestGenome no generation has been evolved yet");
+    }
+    return *best;
+}
+
+
+//=================================PRIVATE METHODS==============================
+
+void IslandGenAlg::Migrate()
+{
+    auto num_islands = m_islands.size();
+    if(num_islands < 2 || m_num_migrants == 0)
+    {
+        return;
+    }
+
+    // collect all migrants up front, so an island never forwards a genome it
+    // just received
+    std::vector<std::vector<Genome>> emigrants;
+    for(auto& island : m_islands)
+    {
+        auto& best = island->BestGenomes();
+        auto num_migrants = std::min(m_num_migrants, best.size());
+        emigrants.emplace_back(best.begin(), best.begin() + num_migrants);
+    }
+
+    for(std::size_t dest = 0; dest < num_islands; ++dest)
+    {
+        std::vector<Genome> immigrants;
+        if(m_topology == MigrationTopology::RING)
+        {
+            immigrants = emigrants[(dest + num_islands - 1) % num_islands];
+        }
+        else
+        {
+            for(std::size_t src = 0; src < num_islands; ++src)
+            {
+                if(src != dest)
+                {
+                    immigrants.insert(immigrants.end(), emigrants[src].begin(), emigrants[src].end());
+                }
+            }
+        }
+
+        // never replace more than half of an island's population
+        auto max_immigrants = m_islands[dest]->GetGenomes().size() / 2;
+        if(immigrants.size() > max_immigrants)
+        {
+            immigrants.resize(max_immigrants);
+        }
+
+        m_islands[dest]->ImportGenomes(immigrants);
+        m_brains[dest] = m_islands[dest]->CreateNeuralNetworks();
+    }
+    ++m_num_migrations;
+}
+
+
+};
@@ -0,0 +1,88 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cerrno>
+#include <stdexcept>
+#include <system_error>
+
+#include "binary.h"
+#include "mappedfile.h"
+
+namespace neat
+{
+
+
+MappedFile::MappedFile(const std::string& path,
+                       std::uint32_t magic,
+                       std::uint16_t version,
+                       std::size_t entry_size,
+                       const std::string& owner,
+                       const std::string& kind): m_data(nullptr),
+                                                 m_size(0),
+                                                 m_num_entries(0),
+                                                 m_index(nullptr),
+                                                 m_entry_size(entry_size),
+                                                 m_owner(owner),
+                                                 m_kind(kind)
+{
+    int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if(fd < 0)
+    {
+        throw std::system_error(errno, std::generic_category(), m_owner + " can't open '" + path + "'");
+    }
+
+    struct stat info;
+    if(fstat(fd, &info) != 0 || static_cast<std::size_t>(info.st_size) < ARCHIVE_HEADER_SIZE)
+    {
+        close(fd);
+        throw std::runtime_error(m_owner + ": '" + path + "' is not a " + m_kind + " archive");
+    }
+
+    m_size = info.st_size;
+    void* memory = mmap(nullptr, m_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if(memory == MAP_FAILED)
+    {
+        throw std::system_error(errno, std::generic_category(), m_owner + " can't map '" + path + "'");
+    }
+    m_data = static_cast<const std::uint8_t*>(memory);
+
+    BinaryReader header(m_data, ARCHIVE_HEADER_SIZE);
+    auto file_magic = header.Read<std::uint32_t>();
+    auto file_version = header.Read<std::uint16_t>();
+    header.Skip(2);
+    auto num_entries = header.Read<std::uint64_t>();
+    auto index_offset = header.Read<std::uint64_t>();
+    auto file_size = header.Read<std::uint64_t>();
+
+    if(file_magic != magic || file_version != version || file_size != m_size ||
+       index_offset < ARCHIVE_HEADER_SIZE || index_offset > m_size ||
+       (m_size - index_offset) / m_entry_size < num_entries)
+    {
+        munmap(memory, m_size);
+        throw std::runtime_error(m_owner + ": '" + path + "' is not a valid " + m_kind + " archive");
+    }
+    m_num_entries = num_entries;
+    m_index = m_data + index_offset;
+}
+
+
+MappedFile::~MappedFile()
+{
+    munmap(const_cast<std::uint8_t*>(m_data), m_size);
+}
+
+
+const std::uint8_t* MappedFile::Entry(std::size_t idx) const
+{
+    if(idx >= m_num_entries)
+    {
+        throw std::out_of_range(m_owner + ": no " + m_kind + " " + std::to_string(idx));
+    }
+    return m_index + idx * m_entry_size;
+}
+
+
+};
@@ -0,0 +1,307 @@
+#include <algorithm>
+#include <bit>
+#include <cmath>
+#include <fstream>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "binary.h"
+#include "netarchive.h"
+
+namespace neat
+{
+
+static_assert(std::endian::native == std::endian::little,
+              "Archived networks are evaluated in place and must match the byte order of the machine.");
+
+const std::size_t INDEX_ENTRY_SIZE = 24;
+const std::size_t NET_HEADER_SIZE = 16;
+
+
+static std::size_t padded(std::size_t size)
+{
+    return (size + 7) & ~std::size_t(7);
+}
+
+
+static std::size_t net_block_size(std::size_t num_neurons, std::size_t num_links)
+{
+    return padded(NET_HEADER_SIZE + 8 * num_neurons + 8 * num_links +
+                  4 * (num_neurons + 1) + 4 * num_links + num_neurons);
+}
+
+
+static void compile_net(BinaryWriter& writer, const NeuralNet& nn)
+{
+    const auto& neurons = nn.GetNeurons();
+
+    std::unordered_map<const Neuron*, std::uint32_t> positions;
+    std::uint32_t num_links = 0;
+    std::uint32_t num_inputs = 0;
+    std::uint32_t num_outputs = 0;
+    for(std::size_t i = 0; i < neurons.size(); ++i)
+    {
+        positions[&neurons[i]] = i;
+        num_links += neurons[i].InLinks.size();
+        num_inputs += neurons[i].Type == NeuronType::INPUT;
+        num_outputs += neurons[i].Type == NeuronType::OUTPUT;
+    }
+
+    auto start = writer.Size();
+    writer.Write<std::uint32_t>(neurons.size());
+    writer.Write(num_links);
+    writer.Write(num_inputs);
+    writer.Write(num_outputs);
+
+    for(auto& n : neurons)
+    {
+        writer.Write(n.ActivationResponse);
+    }
+    for(auto& n : neurons)
+    {
+        for(auto& link : n.InLinks)
+        {
+            writer.Write(link.Weight);
+        }
+    }
+
+    std::uint32_t offset = 0;
+    writer.Write(offset);
+    for(auto& n : neurons)
+    {
+        offset += n.InLinks.size();
+        writer.Write(offset);
+    }
+    for(auto& n : neurons)
+    {
+        for(auto& link : n.InLinks)
+        {
+            writer.Write(positions.at(link.In));
+        }
+    }
+    for(auto& n : neurons)
+    {
+        writer.Write<std::uint8_t>(static_cast<std::uint8_t>(n.Type));
+    }
+
+    while(writer.Size() - start < net_block_size(neurons.size(), num_links))
+    {
+        writer.Write<std::uint8_t>(0);
+    }
+}
+
+
+template <typename TNetFunc>
+static void write_archive(const std::string& path, std::size_t num_nets, TNetFunc get_net)
+{
+    std::ofstream out(path, std::ios::binary);
+    std::vector<std::uint8_t> buffer(ARCHIVE_HEADER_SIZE, 0);
+    out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+
+    std::vector<std::uint8_t> index;
+    BinaryWriter index_writer(index);
+    std::uint64_t offset = ARCHIVE_HEADER_SIZE;
+    for(std::size_t i = 0; i < num_nets; ++i)
+    {
+        std::int64_t id = 0;
+        double fitness = 0;
+        auto nn = get_net(i, id, fitness);
+
+        buffer.clear();
+        BinaryWriter writer(buffer);
+        compile_net(writer, *nn);
+        out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+
+        index_writer.Write(offset);
+        index_writer.Write(id);
+        index_writer.Write(fitness);
+        offset += buffer.size();
+    }
+    out.write(reinterpret_cast<const char*>(index.data()), index.size());
+
+    buffer.clear();
+    BinaryWriter header(buffer);
+    header.Write(NET_ARCHIVE_MAGIC);
+    header.Write(NET_ARCHIVE_VERSION);
+    header.Write<std::uint16_t>(0);
+    header.Write<std::uint64_t>(num_nets);
+    header.Write(offset);
+    header.Write<std::uint64_t>(offset + index.size());
+    out.seekp(0);
+    out.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+
+    out.close();
+    if(!out)
+    {
+        throw std::ios_base::failure("Can't write network archive '" + path + "'");
+    }
+}
+
+
+void write_net_archive(const std::string& path, const std::vector<Genome>& genomes)
+{
+    write_archive(path, genomes.size(), [&genomes](std::size_t i, std::int64_t& id, double& fitness)
+        {
+            id = genomes[i].ID();
+            fitness = genomes[i].Fitness();
+            return std::make_unique<NeuralNet>(genomes[i]);
+        });
+}
+
+
+void write_net_archive(const std::string& path, const std::vector<SNeuralNetPtr>& nets)
+{
+    write_archive(path, nets.size(), [&nets](std::size_t i, std::int64_t& id, double&)
+        {
+            id = i;
+            return nets[i];
+        });
+}
+
+
+NetView::NetView(const std::uint8_t* block, std::size_t size): m_settle_tolerance(DEFAULT_SETTLE_TOLERANCE),
+                                                               m_max_ticks(DEFAULT_MAX_TICKS),
+                                                               m_num_ticks(0),
+                                                               m_settled(false)
+{
+    if(size < NET_HEADER_SIZE)
+    {
+        throw std::runtime_error("NetView: network is cut short");
+    }
+    auto header = reinterpret_cast<const std::uint32_t*>(block);
+    m_num_neurons = header[0];
+    std::uint32_t num_links = header[1];
+    m_num_inputs = header[2];
+    m_num_outputs = header[3];
+    if(net_block_size(m_num_neurons, num_links) > size || m_num_neurons <= m_num_inputs)
+    {
+        throw std::runtime_error("NetView: network is cut short");
+    }
+
+    auto pos = block + NET_HEADER_SIZE;
+    m_activation_responses = reinterpret_cast<const double*>(pos);
+    pos += 8 * m_num_neurons;
+    m_weights = reinterpret_cast<const double*>(pos);
+    pos += 8 * num_links;
+    m_link_offsets = reinterpret_cast<const std::uint32_t*>(pos);
+    pos += 4 * (m_num_neurons + 1);
+    m_sources = reinterpret_cast<const std::uint32_t*>(pos);
+    pos += 4 * num_links;
+    m_types = pos;
+
+    if(m_link_offsets[0] != 0 || m_link_offsets[m_num_neurons] != num_links)
+    {
+        throw std::runtime_error("NetView: corrupt link offsets");
+    }
+    for(std::uint32_t i = 0; i < m_num_neurons; ++i)
+    {
+        if(m_link_offsets[i] > m_link_offsets[i + 1])
+        {
+            throw std::runtime_error("NetView: corrupt link offsets");
+        }
+    }
+    for(std::uint32_t i = 0; i < num_links; ++i)
+    {
+        if(m_sources[i] >= m_num_neurons)
+        {
+            throw std::runtime_error("NetView: link refers to a neuron that doesn't exist");
+        }
+    }
+
+    m_signals.assign(m_num_neurons, 0.0);
+}
+
+
+std::vector<double> NetView::Update(const std::vector<double>& inputs, const UPDATE_TYPE update_type)
+{
+    std::vector<double> outputs;
+    outputs.reserve(m_num_outputs);
+
+    std::size_t max_ticks = update_type == UPDATE_TYPE::SETTLE ? std::max<std::size_t>(m_max_ticks, 1) : 1;
+    double max_change = 0.0;
+    m_num_ticks = 0;
+
+    do
+    {
+        outputs.clear();
+        max_change = 0.0;
+
+        // INPUT .. INPUT, BIAS, everything else - same as NeuralNet::Update
+        std::uint32_t neuron_idx = 0;
+        while(neuron_idx + 1 < m_num_neurons && static_cast<NeuronType>(m_types[neuron_idx]) == NeuronType::INPUT)
+        {
+            m_signals[neuron_idx] = inputs[neuron_idx];
+            ++neuron_idx;
+        }
+        m_signals[neuron_idx++] = 1;
+
+        for(; neuron_idx < m_num_neurons; ++neuron_idx)
+        {
+            double sum = 0.0;
+            for(auto link = m_link_offsets[neuron_idx]; link < m_link_offsets[neuron_idx + 1]; ++link)
+            {
+                sum += m_weights[link] * m_signals[m_sources[link]];
+            }
+            double signal = sigmoid(sum, m_activation_responses[neuron_idx]);
+            max_change = std::max(max_change, std::fabs(signal - m_signals[neuron_idx]));
+            m_signals[neuron_idx] = signal;
+
+            if(static_cast<NeuronType>(m_types[neuron_idx]) == NeuronType::OUTPUT)
+            {
+                outputs.push_back(m_signals[neuron_idx]);
+            }
+        }
+        ++m_num_ticks;
+    }
+    while(m_num_ticks < max_ticks && max_change >= m_settle_tolerance);
+
+    m_settled = max_change < m_settle_tolerance;
+
+    if(update_type == UPDATE_TYPE::SNAPSHOT)
+    {
+        std::fill(m_signals.begin(), m_signals.end(), 0.0);
+    }
+    return outputs;
+}
+
+
+void NetView::SetSettling(double tolerance, std::size_t max_ticks)
+{
+    m_settle_tolerance = tolerance;
+    m_max_ticks = max_ticks;
+}
+
+
+NetArchive::NetArchive(const std::string& path): m_file(path, NET_ARCHIVE_MAGIC, NET_ARCHIVE_VERSION,
+                                                         INDEX_ENTRY_SIZE, "NetArchive", "network")
+{
+}
+
+
+std::int64_t NetArchive::ID(std::size_t idx) const
+{
+    BinaryReader entry(m_file.Entry(idx) + 8, 8);
+    return entry.Read<std::int64_t>();
+}
+
+
+double NetArchive::Fitness(std::size_t idx) const
+{
+    BinaryReader entry(m_file.Entry(idx) + 16, 8);
+    return entry.Read<double>();
+}
+
+
+NetView NetArchive::Net(std::size_t idx) const
+{
+    BinaryReader entry(m_file.Entry(idx), 8);
+    auto offset = entry.Read<std::uint64_t>();
+    if(offset % 8 != 0 || offset >= m_file.Size())
+    {
+        throw std::runtime_error("NetArchive: corrupt index entry");
+    }
+    return NetView(m_file.Data() + offset, m_file.Size() - offset);
+}
+
+
+};
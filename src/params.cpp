@@ -1,6 +1,7 @@
 #include <string>
 #include <iostream>
 #include <fstream>
+#include <stdexcept>
 
 #include "params.h"
 #include "utils.h"
@@ -9,6 +10,52 @@
 namespace neat
 {
 
+std::string to_string(SelectionType type)
+{
+    switch(type)
+    {
+        case SelectionType::FITNESS_PROPORTIONAL:
+            return "FitnessProportional";
+        case SelectionType::RANK:
+            return "Rank";
+        default:
+            return "Truncation";
+    }
+}
+
+
+SelectionType selection_type_from_string(const std::string& type)
+{
+    for(auto candidate : {SelectionType::TRUNCATION, SelectionType::FITNESS_PROPORTIONAL, SelectionType::RANK})
+    {
+        if(to_string(candidate) == type)
+        {
+            return candidate;
+        }
+    }
+    throw std::invalid_argument("Unknown ParentSelection: " + type);
+}
+
+
+std::string to_string(PerturbationType type)
+{
+    return type == PerturbationType::GAUSSIAN ? "Gaussian" : "Uniform";
+}
+
+
+PerturbationType perturbation_type_from_string(const std::string& type)
+{
+    for(auto candidate : {PerturbationType::UNIFORM, PerturbationType::GAUSSIAN})
+    {
+        if(to_string(candidate) == type)
+        {
+            return candidate;
+        }
+    }
+    throw std::invalid_argument("Unknown PerturbationDistribution: " + type);
+}
+
+
 /**
  * Default constructor sets values that will work well for XOR-problem.
  */
@@ -22,6 +69,7 @@ Params::Params()
     m_crossover_chance = 0.75;
     m_disjoint_scaler = 1.0;
     m_excess_scaler = 1.0;
+    m_fitness_cache_size = 0;
     m_match_scaler = 0.4;
     m_max_activation_perturbation = 0.1;
     m_max_neurons = 100;
@@ -39,38 +87,12 @@ Params::Params()
     m_survival_rate = 0.5;
     m_young_bonus_scaler = 1.3;
     m_young_bonus_threshold = 5;
+    m_selection = SelectionType::TRUNCATION;
+    m_selection_pressure = 1.5;
+    m_perturbation = PerturbationType::UNIFORM;
+    m_weight_limit = 0.0;
 }
 
-Params::Params(const Params& params)
-{
-    m_activation_mutation_chance = params.m_activation_mutation_chance;
-    m_add_link_chance = params.m_add_link_chance;
-    m_add_neuron_chance = params.m_add_neuron_chance;
-    m_add_recur_link_chance = params.m_add_recur_link_chance;
-    m_compatibility_threshold = params.m_compatibility_threshold;
-    m_crossover_chance = params.m_crossover_chance;
-    m_disjoint_scaler = params.m_disjoint_scaler;
-    m_excess_scaler = params.m_excess_scaler;
-    m_match_scaler = params.m_match_scaler;
-    m_max_activation_perturbation = params.m_activation_mutation_chance;
-    m_max_neurons = params.m_max_neurons;
-    m_max_perturbation = params.m_max_perturbation;
-    m_mutation_chance = params.m_mutation_chance;
-    m_new_weight_chance = params.m_new_weight_chance;
-    m_num_add_link_attempts = params.m_num_add_link_attempts;
-    m_num_add_recur_link_attempts = params.m_num_add_recur_link_attempts;
-    m_num_best_genomes = params.m_num_best_genomes;
-    m_num_find_old_link_attempts = params.m_num_find_old_link_attempts;
-    m_num_gens_allowed_no_improv = params.m_num_gens_allowed_no_improv;
-    m_old_penalty_scaler = params.m_old_penalty_scaler;
-    m_old_penalty_threshold = params.m_old_penalty_threshold;
-    m_population_size = params.m_population_size;
-    m_survival_rate = params.m_survival_rate;
-    m_young_bonus_scaler = params.m_young_bonus_scaler;
-    m_young_bonus_threshold = params.m_young_bonus_threshold;
-}
-
-
 template <typename T>
 void set_value(const nlohmann::json& config, std::string name, T& value)
 {
@@ -116,6 +138,44 @@ Params Params::FromString(std::string params)
 }
 
 
+nlohmann::json Params::serialize() const
+{
+    nlohmann::json object = {
+        {"ActivationMutationRate", m_activation_mutation_chance},
+        {"ChanceAddLink", m_add_link_chance},
+        {"ChanceAddNeuron", m_add_neuron_chance},
+        {"ChanceAddRecurrentLink", m_add_recur_link_chance},
+        {"CompatibilityThreshold", m_compatibility_threshold},
+        {"CrossoverRate", m_crossover_chance},
+        {"DisjointScaler", m_disjoint_scaler},
+        {"ExcessScaler", m_excess_scaler},
+        {"FitnessCacheSize", m_fitness_cache_size},
+        {"MatchScaler", m_match_scaler},
+        {"MaxActivationPerturbation", m_max_activation_perturbation},
+        {"MaxPermittedNeurons", m_max_neurons},
+        {"MaxWeightPerturbation", m_max_perturbation},
+        {"MutationProbability", m_mutation_chance},
+        {"NumAddLinkAttempts", m_num_add_link_attempts},
+        {"NumAddRecurLinkAttempts", m_num_add_recur_link_attempts},
+        {"NumBestGenomes", m_num_best_genomes},
+        {"NumFindOldLinkAttempts", m_num_find_old_link_attempts},
+        {"NumGensAllowedNoImprovement", m_num_gens_allowed_no_improv},
+        {"OldAgePenalty", m_old_penalty_scaler},
+        {"OldAgeThreshold", m_old_penalty_threshold},
+        {"ParentSelection", to_string(m_selection)},
+        {"PerturbationDistribution", to_string(m_perturbation)},
+        {"PopulationSize", m_population_size},
+        {"SelectionPressure", m_selection_pressure},
+        {"SurvivalRate", m_survival_rate},
+        {"WeightLimit", m_weight_limit},
+        {"WeightReplacedProbability", m_new_weight_chance},
+        {"YoungBonusAgeThreshhold", m_young_bonus_threshold},
+        {"YoungFitnessBonus", m_young_bonus_scaler}
+    };
+    return object;
+}
+
+
 // ============================ PRIVATE METHODS =====================================
 void Params::InitValues(nlohmann::json& config)
 {
@@ -127,6 +187,7 @@ void Params::InitValues(nlohmann::json& config)
     set_value(config, "CrossoverRate", m_crossover_chance);
     set_value(config, "DisjointScaler", m_disjoint_scaler);
     set_value(config, "ExcessScaler", m_excess_scaler);
+    set_value(config, "FitnessCacheSize", m_fitness_cache_size);
     set_value(config, "MatchScaler", m_match_scaler);
     set_value(config, "MaxActivationPerturbation", m_max_activation_perturbation);
     set_value(config, "MaxPermittedNeurons", m_max_neurons);
@@ -140,7 +201,21 @@ void Params::InitValues(nlohmann::json& config)
     set_value(config, "OldAgePenalty", m_old_penalty_scaler);
     set_value(config, "OldAgeThreshold", m_old_penalty_threshold);
     set_value(config, "PopulationSize", m_population_size);
+    set_value(config, "SelectionPressure", m_selection_pressure);
+    if(config.contains("ParentSelection"))
+    {
+        m_selection = selection_type_from_string(config["ParentSelection"].get<std::string>());
+    }
+    if(config.contains("PerturbationDistribution"))
+    {
+        m_perturbation = perturbation_type_from_string(config["PerturbationDistribution"].get<std::string>());
+    }
+    if(m_selection_pressure < 1.0 || m_selection_pressure > 2.0)
+    {
+        throw std::invalid_argument("SelectionPressure must be between 1 and 2");
+    }
     set_value(config, "SurvivalRate", m_survival_rate);
+    set_value(config, "WeightLimit", m_weight_limit);
     set_value(config, "WeightReplacedProbability", m_new_weight_chance);
     set_value(config, "YoungBonusAgeThreshhold", m_young_bonus_threshold);
     set_value(config, "YoungFitnessBonus", m_young_bonus_scaler);
@@ -1,4 +1,7 @@
+#include <algorithm>
 #include <cmath>
+#include <stdexcept>
+#include <unordered_map>
 
 #include "cpplinq.hpp"
 
@@ -25,6 +28,22 @@ nlohmann::json Link::serialize() const
 }
 
 
+// keys in the order json::dump prints them
+void Link::serialize_to(JsonWriter& writer) const
+{
+    writer.BeginObject();
+    writer.Key("InputID");
+    writer.Value((int)In->ID);
+    writer.Key("IsRecurrent");
+    writer.Value(IsRecurrent);
+    writer.Key("OutputID");
+    writer.Value((int)Out->ID);
+    writer.Key("Weight");
+    writer.Value(Weight);
+    writer.EndObject();
+}
+
+
 nlohmann::json Neuron::serialize() const
 {
     using namespace cpplinq;
@@ -55,87 +74,351 @@ nlohmann::json Neuron::serialize() const
 }
 
 
+void Neuron::serialize_to(JsonWriter& writer) const
+{
+    writer.BeginObject();
+    writer.Key("ActivationResponse");
+    writer.Value(ActivationResponse);
+    writer.Key("ID");
+    writer.Value((int)ID);
+    writer.Key("InLinks");
+    writer.BeginArray();
+    for(const auto& link : InLinks)
+    {
+        link.serialize_to(writer);
+    }
+    writer.EndArray();
+    writer.Key("OutLinks");
+    writer.BeginArray();
+    for(const auto& link : OutLinks)
+    {
+        link.serialize_to(writer);
+    }
+    writer.EndArray();
+    writer.Key("SplitX");
+    writer.Value(SplitX);
+    writer.Key("SplitY");
+    writer.Value(SplitY);
+    writer.Key("Type");
+    writer.Value(to_string(Type));
+    writer.EndObject();
+}
+
+
+
+NeuralNet::NeuralNet(std::vector<Neuron>& neurons) : m_neurons(neurons),
+                                                     m_levels(),
+                                                     m_depth(0),
+                                                     m_settle_tolerance(DEFAULT_SETTLE_TOLERANCE),
+                                                     m_max_ticks(DEFAULT_MAX_TICKS),
+                                                     m_num_ticks(0),
+                                                     m_settled(false)
+{
+    std::unordered_map<int, std::size_t> index_of;
+    for(std::size_t i = 0; i < m_neurons.size(); ++i)
+    {
+        index_of[m_neurons[i].ID] = i;
+    }
+
+    // the copied links still point at the neurons they were copied with
+    auto rebase = [this, &index_of](const Neuron* neuron)
+    {
+        auto found = neuron ? index_of.find(neuron->ID) : index_of.end();
+        if(found == index_of.end())
+        {
+            throw std::invalid_argument("NeuralNet: link refers to a neuron outside of the network");
+        }
+        return &m_neurons[found->second];
+    };
+
+    for(auto& neuron : m_neurons)
+    {
+        for(auto* links : {&neuron.InLinks, &neuron.OutLinks})
+        {
+            for(auto& link : *links)
+            {
+                link.In = rebase(link.In);
+                link.Out = rebase(link.Out);
+            }
+        }
+    }
+    ComputeLevels();
+}
+
 
 NeuralNet::NeuralNet(const Genome& g) : NeuralNet(g.NeuronGenes(),
                                                   g.NeuronLinks())
 {}
 
 
-NeuralNet::NeuralNet(nlohmann::json& object)
+NeuralNet::NeuralNet(nlohmann::json& object) : m_neurons(),
+                                                m_levels(),
+                                                m_depth(0),
+                                                m_settle_tolerance(DEFAULT_SETTLE_TOLERANCE),
+                                                m_max_ticks(DEFAULT_MAX_TICKS),
+                                                m_num_ticks(0),
+                                                m_settled(false)
 {
-    using namespace cpplinq;
-    auto type_to_enum = [](std::string&& type)
+    m_neurons.reserve(object.size());
+    std::unordered_map<int, std::size_t> index_of;
+    for(const auto& j : object)
+    {
+        NeuronType type = neuron_type_from_string(j.at("Type").get_ref<const std::string&>());
+        NeuronID id = j.at("ID").get<int>();
+        double ar = j.at("ActivationResponse").get<double>();
+        double splitx = j.at("SplitX").get<double>();
+        double splity = j.at("SplitY").get<double>();
+
+        index_of[id] = m_neurons.size();
+        m_neurons.push_back(Neuron(type, id, ar, splitx, splity));
+    }
+
+    // m_neurons doesn't grow anymore, so pointers into it stay valid
+    auto get_neuron_ptr = [this, &index_of](NeuronID id)
+    {
+        auto found = index_of.find(id);
+        if(found == index_of.end())
+        {
+            throw std::runtime_error("NeuralNet: link refers to unknown neuron " + std::to_string(id));
+        }
+        return &m_neurons[found->second];
+    };
+
+    auto make_link = [&get_neuron_ptr](const nlohmann::json& obj)
+    {
+        NeuronID input_id = obj.at("InputID").get<int>();
+        NeuronID output_id = obj.at("OutputID").get<int>();
+        double weight = obj.at("Weight").get<double>();
+        bool is_recurrent = obj.at("IsRecurrent").get<bool>();
+        return Link(get_neuron_ptr(input_id), get_neuron_ptr(output_id), weight, is_recurrent);
+    };
+
+    // go over all links and restore them
+    std::size_t idx = 0;
+    for(const auto& j : object)
+    {
+        Neuron& n = m_neurons[idx++];
+        const auto& in_links = j.at("InLinks");
+        const auto& out_links = j.at("OutLinks");
+        n.InLinks.reserve(in_links.size());
+        n.OutLinks.reserve(out_links.size());
+
+        for(const auto& in_link : in_links)
+        {
+            n.InLinks.push_back(make_link(in_link));
+        }
+
+        for(const auto& out_link : out_links)
+        {
+            n.OutLinks.push_back(make_link(out_link));
+        }
+    }
+    ComputeLevels();
+}
+
+
+/**
+ * SAX handler for the output of NeuralNet::serialize. Neurons are collected
+ * as they are parsed, links as flat records that are resolved once every
+ * neuron is known, since keys of a neuron object are sorted and InLinks come
+ * before the neuron's ID.
+ */
+class NeuralNetSaxHandler : public nlohmann::json_sax<nlohmann::json>
+{
+public:
+    struct LinkRecord
+    {
+        std::size_t Owner = 0;
+        bool IsInLink = true;
+        NeuronID InputID = 0;
+        NeuronID OutputID = 0;
+        double Weight = 0;
+        bool IsRecurrent = false;
+    };
+
+private:
+    enum class Level
+    {
+        ROOT,
+        NEURONS,
+        NEURON,
+        LINKS,
+        LINK,
+        DONE
+    };
+
+    struct NeuronRecord
     {
-        if(type == "BIAS")
+        std::string Type;
+        NeuronID ID = 0;
+        double ActivationResponse = 0;
+        double SplitX = 0;
+        double SplitY = 0;
+    };
+
+    Level m_level = Level::ROOT;
+    std::string m_key;
+    bool m_in_links = true;
+    NeuronRecord m_neuron;
+    LinkRecord m_link;
+
+    bool Value(double value)
+    {
+        if(m_level == Level::NEURON)
         {
-            return NeuronType::BIAS;
+            if(m_key == "ID")                      m_neuron.ID = static_cast<int>(value);
+            else if(m_key == "ActivationResponse") m_neuron.ActivationResponse = value;
+            else if(m_key == "SplitX")             m_neuron.SplitX = value;
+            else if(m_key == "SplitY")             m_neuron.SplitY = value;
+            return true;
         }
-        else if(type == "HIDDEN")
+        if(m_level == Level::LINK)
         {
-            return NeuronType::HIDDEN;
+            if(m_key == "InputID")       m_link.InputID = static_cast<int>(value);
+            else if(m_key == "OutputID") m_link.OutputID = static_cast<int>(value);
+            else if(m_key == "Weight")   m_link.Weight = value;
+            return true;
         }
-        else if(type == "INPUT")
+        return false;
+    }
+
+public:
+    std::vector<Neuron> Neurons;
+    std::vector<LinkRecord> Links;
+
+    bool null() override { return false; }
+    bool boolean(bool value) override
+    {
+        if(m_level == Level::LINK && m_key == "IsRecurrent")
         {
-            return NeuronType::INPUT;
+            m_link.IsRecurrent = value;
         }
-        else if(type == "OUTPUT")
+        return m_level == Level::LINK;
+    }
+    bool number_integer(number_integer_t value) override { return Value(value); }
+    bool number_unsigned(number_unsigned_t value) override { return Value(value); }
+    bool number_float(number_float_t value, const string_t&) override { return Value(value); }
+    bool string(string_t& value) override
+    {
+        if(m_level == Level::NEURON && m_key == "Type")
         {
-            return NeuronType::OUTPUT;
+            m_neuron.Type = value;
+        }
+        return m_level == Level::NEURON;
+    }
+    bool binary(binary_t&) override { return false; }
+
+    bool start_object(std::size_t) override
+    {
+        if(m_level == Level::NEURONS)
+        {
+            m_neuron = NeuronRecord();
+            m_level = Level::NEURON;
+            return true;
+        }
+        if(m_level == Level::LINKS)
+        {
+            m_link = LinkRecord();
+            m_link.Owner = Neurons.size();
+            m_link.IsInLink = m_in_links;
+            m_level = Level::LINK;
+            return true;
+        }
+        return false;
+    }
+
+    bool end_object() override
+    {
+        if(m_level == Level::NEURON)
+        {
+            Neurons.push_back(Neuron(neuron_type_from_string(m_neuron.Type), m_neuron.ID,
+                                     m_neuron.ActivationResponse, m_neuron.SplitX, m_neuron.SplitY));
+            m_level = Level::NEURONS;
         }
         else
         {
-            return NeuronType::NONE;
+            Links.push_back(m_link);
+            m_level = Level::LINKS;
         }
-    };
+        return true;
+    }
 
-    auto get_neuron_ptr = [this](NeuronID id)
+    bool start_array(std::size_t size) override
     {
-        for(auto& np : this->m_neurons)
+        if(m_level == Level::ROOT)
+        {
+            if(size != static_cast<std::size_t>(-1))
+            {
+                Neurons.reserve(size);
+            }
+            m_level = Level::NEURONS;
+            return true;
+        }
+        if(m_level == Level::NEURON && (m_key == "InLinks" || m_key == "OutLinks"))
         {
-            if(np.ID == id)
-                return &np;
+            m_in_links = m_key == "InLinks";
+            m_level = Level::LINKS;
+            return true;
         }
-        return static_cast<Neuron*>(nullptr);
-    };
+        return false;
+    }
 
-    for(auto j : object)
+    bool end_array() override
     {
-        NeuronType type = type_to_enum(j["Type"]);
-        NeuronID id = (int)j["ID"];
-        double ar = j["ActivationResponse"];
-        double splitx = j["SplitX"];
-        double splity = j["SplitY"];
+        m_level = m_level == Level::LINKS ? Level::NEURON : Level::DONE;
+        return true;
+    }
 
-        m_neurons.push_back(Neuron(type, id, ar, splitx, splity));
+    bool key(string_t& value) override
+    {
+        m_key = value;
+        return true;
     }
 
-    auto make_link = [&get_neuron_ptr](nlohmann::json& obj)
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& ex) override
     {
-        NeuronID input_id = (int)obj["InputID"];
-        NeuronID output_id = (int)obj["OutputID"];
-        double weight = obj["Weight"];
-        bool is_recurrent = obj["IsRecurrent"];
-        return Link(get_neuron_ptr(input_id), get_neuron_ptr(output_id), weight, is_recurrent);
-    };
+        throw std::runtime_error(std::string("NeuralNet::FromStream: ") + ex.what());
+    }
+};
 
-    // go over all links and restore them
-    for(auto j : object)
+
+NeuralNet NeuralNet::FromStream(std::istream& in)
+{
+    NeuralNetSaxHandler handler;
+    if(!nlohmann::json::sax_parse(in, &handler))
     {
-        NeuronID id = (int)j["ID"];
-        nlohmann::json in_links = j["InLinks"];
-        nlohmann::json out_links = j["OutLinks"];
-        Neuron* n = get_neuron_ptr(id);
+        throw std::runtime_error("NeuralNet::FromStream: input is not a serialized NeuralNet");
+    }
 
-        for(auto in_link : in_links)
-        {
-            n->InLinks.push_back(make_link(in_link));
-        }
+    std::vector<Neuron> no_neurons;
+    NeuralNet nn(no_neurons);
+    nn.m_neurons = std::move(handler.Neurons);
+
+    std::unordered_map<int, std::size_t> index_of;
+    index_of.reserve(nn.m_neurons.size());
+    for(std::size_t i = 0; i < nn.m_neurons.size(); ++i)
+    {
+        index_of[nn.m_neurons[i].ID] = i;
+    }
 
-        for(auto out_link : out_links)
+    auto get_neuron_ptr = [&nn, &index_of](NeuronID id)
+    {
+        auto found = index_of.find(id);
+        if(found == index_of.end())
         {
-            n->OutLinks.push_back(make_link(out_link));
+            throw std::runtime_error("NeuralNet::FromStream: link refers to unknown neuron " + std::to_string(id));
         }
+        return &nn.m_neurons[found->second];
+    };
+
+    for(auto& record : handler.Links)
+    {
+        Link link(get_neuron_ptr(record.InputID), get_neuron_ptr(record.OutputID), record.Weight, record.IsRecurrent);
+        auto& owner = nn.m_neurons[record.Owner];
+        (record.IsInLink ? owner.InLinks : owner.OutLinks).push_back(link);
     }
+    nn.ComputeLevels();
+    return nn;
 }
 
 
@@ -168,8 +451,150 @@ Neuron* NeuralNet::find_helper(NeuronID id, int low, int high)
 }
 
 
+// enabled link gene between two positions in the list of neurons
+struct PhenotypeLink
+{
+    std::size_t From;
+    std::size_t To;
+    double Weight;
+    bool IsRecurrent;
+};
+
+
+/**
+ * Removes what can't change the outputs of a network before it is built.
+ * Update computes the neurons in order, so a neuron only sees the current
+ * signal of neurons before it and the last one of neurons after it.
+ *
+ * A neuron fed only by the bias neuron, or by such constant neurons before
+ * it, puts out the same signal on every tick. A link from it to a later
+ * neuron is replaced by a link from the bias neuron weighted with that
+ * signal, which adds up to exactly the same sum. Then every neuron without
+ * a path to an output is dropped along with its links.
+ *
+ * SNAPSHOT and ACTIVE updates give the same outputs as the whole genome.
+ * SETTLE doesn't necessarily: it measures the change of the kept neurons
+ * only, so a dropped recurrent neuron that keeps changing no longer holds it
+ * back. NumTicks, IsSettled and the outputs it settles on can differ.
+ *
+ * @returns which neurons are kept; input, bias and output neurons always are
+ */
+static std::vector<bool> compile_phenotype(const std::vector<Neuron>& neurons, std::vector<PhenotypeLink>& links)
+{
+    const std::size_t size = neurons.size();
+
+    std::vector<std::vector<std::size_t>> in_links(size);
+    for(std::size_t i = 0; i < links.size(); ++i)
+    {
+        in_links[links[i].To].push_back(i);
+    }
+
+    auto bias = std::find_if(neurons.begin(), neurons.end(), [](const Neuron& n)
+        {
+            return n.Type == NeuronType::BIAS;
+        });
+
+    if(bias != neurons.end())
+    {
+        std::size_t bias_idx = bias - neurons.begin();
+        std::vector<bool> is_constant(size, false);
+        std::vector<double> signals(size, 0.0);
+        is_constant[bias_idx] = true;
+        signals[bias_idx] = 1.0;
+
+        for(std::size_t i = bias_idx + 1; i < size; ++i)
+        {
+            if(neurons[i].Type == NeuronType::INPUT) continue;
+
+            // summed in the order of Update
+            double sum = 0.0;
+            bool constant = true;
+            for(auto link_idx : in_links[i])
+            {
+                std::size_t from = links[link_idx].From;
+                if(!is_constant[from] || (from >= i && from != bias_idx))
+                {
+                    constant = false;
+                    break;
+                }
+                sum += links[link_idx].Weight * signals[from];
+            }
+
+            if(constant)
+            {
+                is_constant[i] = true;
+                signals[i] = sigmoid(sum, neurons[i].ActivationResponse);
+            }
+        }
+
+        for(auto& link : links)
+        {
+            if(link.From != bias_idx && is_constant[link.From] && link.From < link.To)
+            {
+                link.Weight *= signals[link.From];
+                link.From = bias_idx;
+                link.IsRecurrent = false;
+            }
+        }
+
+        for(auto& link_indices : in_links)
+        {
+            link_indices.clear();
+        }
+        for(std::size_t i = 0; i < links.size(); ++i)
+        {
+            in_links[links[i].To].push_back(i);
+        }
+    }
+
+    std::vector<bool> is_live(size, false);
+    std::vector<std::size_t> pending;
+    for(std::size_t i = 0; i < size; ++i)
+    {
+        if(neurons[i].Type == NeuronType::OUTPUT)
+        {
+            is_live[i] = true;
+            pending.push_back(i);
+        }
+    }
+    while(!pending.empty())
+    {
+        std::size_t idx = pending.back();
+        pending.pop_back();
+        for(auto link_idx : in_links[idx])
+        {
+            std::size_t from = links[link_idx].From;
+            if(!is_live[from])
+            {
+                is_live[from] = true;
+                pending.push_back(from);
+            }
+        }
+    }
+
+    links.erase(std::remove_if(links.begin(), links.end(), [&is_live](const PhenotypeLink& link)
+        {
+            return !is_live[link.To];
+        }),
+        links.end());
+
+    std::vector<bool> keep(size);
+    for(std::size_t i = 0; i < size; ++i)
+    {
+        keep[i] = is_live[i] || neurons[i].Type != NeuronType::HIDDEN;
+    }
+    return keep;
+}
+
+
 NeuralNet::NeuralNet(const std::vector<NeuronGene>& neuron_genes,
-                     const std::vector<LinkGene>& link_genes) : m_neurons()
+                     const std::vector<LinkGene>& link_genes) : m_neurons(),
+                                                                m_levels(),
+                                                                m_depth(0),
+                                                                m_settle_tolerance(DEFAULT_SETTLE_TOLERANCE),
+                                                                m_max_ticks(DEFAULT_MAX_TICKS),
+                                                                m_num_ticks(0),
+                                                                m_settled(false)
 {
     //first, create all the required neurons
     for(const auto& ng : neuron_genes)
@@ -177,7 +602,7 @@ NeuralNet::NeuralNet(const std::vector<NeuronGene>& neuron_genes,
         m_neurons.push_back(Neuron(ng.Type, ng.ID, ng.ActivationResponse, ng.SplitX, ng.SplitY));
     }
 
-    //now create the links.
+    std::vector<PhenotypeLink> links;
     for(const auto& link_gene : link_genes)
     {
         if(link_gene.IsEnabled)
@@ -187,12 +612,44 @@ NeuralNet::NeuralNet(const std::vector<NeuronGene>& neuron_genes,
 
             assert(from_neuron && to_neuron);
 
-            Link tmp_link(from_neuron, to_neuron, link_gene.Weight, link_gene.IsRecurrent);
+            links.push_back(PhenotypeLink{static_cast<std::size_t>(from_neuron - m_neurons.data()),
+                                          static_cast<std::size_t>(to_neuron - m_neurons.data()),
+                                          link_gene.Weight,
+                                          link_gene.IsRecurrent});
+        }
+    }
 
-            from_neuron->OutLinks.push_back(tmp_link);
-            to_neuron->InLinks.push_back(tmp_link);
+    std::vector<bool> keep = compile_phenotype(m_neurons, links);
+
+    // drop the pruned neurons, m_neurons doesn't grow after this so pointers
+    // into it stay valid
+    std::vector<std::size_t> position(m_neurons.size());
+    std::size_t num_kept = 0;
+    for(std::size_t i = 0; i < m_neurons.size(); ++i)
+    {
+        position[i] = num_kept;
+        if(keep[i])
+        {
+            if(num_kept != i)
+            {
+                m_neurons[num_kept] = std::move(m_neurons[i]);
+            }
+            ++num_kept;
         }
     }
+    m_neurons.erase(m_neurons.begin() + num_kept, m_neurons.end());
+
+    //now create the links.
+    for(const auto& link : links)
+    {
+        Neuron* from_neuron = &m_neurons[position[link.From]];
+        Neuron* to_neuron = &m_neurons[position[link.To]];
+        Link tmp_link(from_neuron, to_neuron, link.Weight, link.IsRecurrent);
+
+        from_neuron->OutLinks.push_back(tmp_link);
+        to_neuron->InLinks.push_back(tmp_link);
+    }
+    ComputeLevels();
 }
 
 
@@ -200,11 +657,14 @@ std::vector<double> NeuralNet::Update(const std::vector<double>& inputs, const U
 {
     std::vector<double> outputs;
 
-    int flush_count = 1;
+    std::size_t max_ticks = update_type == UPDATE_TYPE::SETTLE ? std::max<std::size_t>(m_max_ticks, 1) : 1;
+    double max_change = 0.0;
+    m_num_ticks = 0;
 
-    for(int i = 0; i < flush_count; ++i)
+    do
     {
         outputs.clear();
+        max_change = 0.0;
         int neuron_idx = 0;
 
         // The expected order of neurons: INPUT .. INPUT, BIAS, HIDDEN .. HIDDEN
@@ -231,8 +691,9 @@ std::vector<double> NeuralNet::Update(const std::vector<double>& inputs, const U
 
             //now put the sum through the activation function and assign the
             //value to this neuron's output
-            m_neurons[neuron_idx].OutputSignal =
-                sigmoid(sum, m_neurons[neuron_idx].ActivationResponse);
+            double signal = sigmoid(sum, m_neurons[neuron_idx].ActivationResponse);
+            max_change = std::max(max_change, std::fabs(signal - m_neurons[neuron_idx].OutputSignal));
+            m_neurons[neuron_idx].OutputSignal = signal;
 
             if (m_neurons[neuron_idx].Type == NeuronType::OUTPUT)
             {
@@ -243,7 +704,11 @@ std::vector<double> NeuralNet::Update(const std::vector<double>& inputs, const U
             //next neuron
             ++neuron_idx;
         }
+        ++m_num_ticks;
     }
+    while(m_num_ticks < max_ticks && max_change >= m_settle_tolerance);
+
+    m_settled = max_change < m_settle_tolerance;
 
     if(update_type == UPDATE_TYPE::SNAPSHOT)
     {
@@ -256,6 +721,13 @@ std::vector<double> NeuralNet::Update(const std::vector<double>& inputs, const U
 }
 
 
+void NeuralNet::SetSettling(double tolerance, std::size_t max_ticks)
+{
+    m_settle_tolerance = tolerance;
+    m_max_ticks = max_ticks;
+}
+
+
 nlohmann::json NeuralNet::serialize() const
 {
     using namespace cpplinq;
@@ -269,6 +741,17 @@ nlohmann::json NeuralNet::serialize() const
 }
 
 
+void NeuralNet::serialize_to(JsonWriter& writer) const
+{
+    writer.BeginArray();
+    for(const auto& neuron : m_neurons)
+    {
+        neuron.serialize_to(writer);
+    }
+    writer.EndArray();
+}
+
+
 std::string to_string(const NeuralNet& nn)
 {
     using std::to_string;
@@ -281,39 +764,66 @@ std::string to_string(const NeuralNet& nn)
 }
 
 
-// TODO: Check number of neurons == (input_size + output_size + bias) then return 1
-std::size_t NeuralNet::GetDepth() const
+//=================================PRIVATE METHODS===============================
+/**
+ * Longest paths over the non recurrent links in a single topological pass
+ * (Kahn's algorithm), so every link is followed once no matter how many paths
+ * lead through it.
+ */
+void NeuralNet::ComputeLevels()
 {
-    using namespace cpplinq;
-    auto start_neurons = from(m_neurons) >> where([](const Neuron& n)
-        {
-            return n.Type == NeuronType::BIAS || n.Type == NeuronType::INPUT;
-        })
-    >> to_vector();
+    const std::size_t size = m_neurons.size();
+    const Neuron* first = m_neurons.data();
 
-    std::size_t final_depth = 0;
+    auto follows = [](const Link& link) { return !link.IsRecurrent; };
 
-    for(auto& n : start_neurons)
+    std::vector<std::size_t> num_in(size, 0);
+    for(const auto& neuron : m_neurons)
     {
-        final_depth = std::max(final_depth, GetDepth(&n, 1));
+        for(const auto& link : neuron.OutLinks)
+        {
+            if(follows(link)) ++num_in[link.Out - first];
+        }
     }
-    return final_depth;
-}
-
-
-//=================================PRIVATE METHODS===============================
-std::size_t NeuralNet::GetDepth(const Neuron* n, std::size_t depth) const
-{
-    if(n->Type == NeuronType::OUTPUT) return depth;
 
-    std::size_t final_depth = 0;
-    for(auto& link : n->OutLinks)
+    // reach counts the neurons on the longest path from an input or bias
+    // neuron that doesn't pass through an output, 0 if there is none
+    std::vector<std::size_t> levels(size, 0);
+    std::vector<std::size_t> reach(size, 0);
+    std::vector<std::size_t> ready;
+    ready.reserve(size);
+    for(std::size_t i = 0; i < size; ++i)
     {
-        if(link.IsRecurrent) continue;
-        final_depth = std::max(final_depth, GetDepth(link.Out, depth + 1));
+        if(m_neurons[i].Type == NeuronType::INPUT || m_neurons[i].Type == NeuronType::BIAS)
+        {
+            reach[i] = 1;
+        }
+        if(num_in[i] == 0) ready.push_back(i);
     }
-    return final_depth;
-}
 
+    std::size_t depth = 0;
+    for(std::size_t next = 0; next < ready.size(); ++next)
+    {
+        std::size_t idx = ready[next];
+        const Neuron& neuron = m_neurons[idx];
+        bool is_output = neuron.Type == NeuronType::OUTPUT;
+        if(is_output) depth = std::max(depth, reach[idx]);
+
+        for(const auto& link : neuron.OutLinks)
+        {
+            if(!follows(link)) continue;
 
+            std::size_t out = link.Out - first;
+            levels[out] = std::max(levels[out], levels[idx] + 1);
+            if(!is_output && reach[idx] > 0)
+            {
+                reach[out] = std::max(reach[out], reach[idx] + 1);
+            }
+            if(--num_in[out] == 0) ready.push_back(out);
+        }
+    }
+
+    m_depth = depth;
+    m_levels = std::move(levels);
+}
 };
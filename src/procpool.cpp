@@ -0,0 +1,409 @@
+#include <semaphore.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/prctl.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <new>
+#include <stdexcept>
+#include <system_error>
+
+#include "binformat.h"
+#include "procpool.h"
+#include "utils.h"
+
+namespace neat
+{
+
+namespace internal
+{
+
+// upper bound of results a worker can have waiting for the parent
+const std::size_t RESULT_SLOTS = 64;
+
+struct Result
+{
+    std::uint64_t JobID;
+    double Fitness;
+};
+
+/**
+ * Lives in memory shared between the parent and one worker. The job ring
+ * holds records of [u32 payload size][u32 unused][u64 job id][payload], each
+ * padded to 8 bytes, and directly follows this struct. Only the parent moves
+ * JobHead and ResultTail, only the worker JobTail and ResultHead - except
+ * that the parent resets both job indices while the ring is empty.
+ */
+struct WorkerChannel
+{
+    sem_t JobsReady;
+    std::atomic<std::uint64_t> JobHead;
+    std::atomic<std::uint64_t> JobTail;
+    std::atomic<std::uint64_t> ResultHead;
+    std::atomic<std::uint64_t> ResultTail;
+    Result Results[RESULT_SLOTS];
+    std::uint64_t Capacity;
+
+    std::uint8_t* Jobs() { return reinterpret_cast<std::uint8_t*>(this + 1); }
+};
+
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+              "Ring buffer indices must be lock free to be shared between processes.");
+
+}
+
+using internal::WorkerChannel;
+
+// a record that doesn't fit before the end of the ring starts over at its
+// beginning, this marks the skipped space
+const std::uint32_t WRAP_MARKER = 0xFFFFFFFF;
+const std::size_t RECORD_HEADER_SIZE = 16;
+// jobs queued per worker - one being evaluated and one ready to go
+const std::size_t MAX_QUEUED_PER_WORKER = 2;
+const std::chrono::milliseconds RESULT_WAIT(10);
+
+
+static std::size_t padded(std::size_t size)
+{
+    return (size + 7) & ~std::size_t(7);
+}
+
+
+static void* map_shared(std::size_t size)
+{
+    void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+    if(memory == MAP_FAILED)
+    {
+        throw std::system_error(errno, std::generic_category(), "ProcessPoolEvaluator: mmap failed");
+    }
+    return memory;
+}
+
+
+[[noreturn]] static void run_worker(WorkerChannel* channel, sem_t* results_ready, const FitnessFunc& fitness)
+{
+    auto capacity = channel->Capacity;
+    auto jobs = channel->Jobs();
+
+    try
+    {
+        while(true)
+        {
+            while(sem_wait(&channel->JobsReady) != 0)
+            {
+                // interrupted by a signal
+            }
+
+            auto tail = channel->JobTail.load(std::memory_order_relaxed);
+            auto pos = tail % capacity;
+            std::uint32_t size;
+            std::memcpy(&size, jobs + pos, sizeof(size));
+            if(size == WRAP_MARKER)
+            {
+                tail += capacity - pos;
+                pos = 0;
+                std::memcpy(&size, jobs, sizeof(size));
+            }
+
+            std::uint64_t job_id;
+            std::memcpy(&job_id, jobs + pos + 8, sizeof(job_id));
+
+            BinaryReader reader(jobs + pos + RECORD_HEADER_SIZE, size);
+            auto brain = std::make_shared<NeuralNet>(decode_net(reader));
+
+            // the record has been copied out, the parent may reuse its space
+            channel->JobTail.store(tail + RECORD_HEADER_SIZE + padded(size), std::memory_order_release);
+
+            double result = fitness(brain);
+
+            auto head = channel->ResultHead.load(std::memory_order_relaxed);
+            channel->Results[head % internal::RESULT_SLOTS] = internal::Result{job_id, result};
+            channel->ResultHead.store(head + 1, std::memory_order_release);
+            sem_post(results_ready);
+        }
+    }
+    catch(...)
+    {
+        // a failing fitness function is treated like any other crash
+    }
+    _exit(1);
+}
+
+
+ProcessPoolEvaluator::ProcessPoolEvaluator(FitnessFunc fitness,
+                                           std::size_t num_workers,
+                                           double penalty,
+                                           std::size_t ring_capacity): m_fitness(fitness),
+                                                                       m_penalty(penalty),
+                                                                       m_ring_capacity(padded(ring_capacity)),
+                                                                       m_num_crashes(0),
+                                                                       m_shared(nullptr),
+                                                                       m_shared_size(sizeof(sem_t)),
+                                                                       m_workers()
+{
+    if(num_workers == 0)
+    {
+        throw std::invalid_argument("ProcessPoolEvaluator needs at least one worker");
+    }
+    if(m_ring_capacity < RECORD_HEADER_SIZE)
+    {
+        throw std::invalid_argument("ProcessPoolEvaluator ring buffer is too small");
+    }
+
+    m_shared = map_shared(m_shared_size);
+    sem_init(static_cast<sem_t*>(m_shared), 1, 0);
+
+    for(std::size_t i = 0; i < num_workers; ++i)
+    {
+        void* memory = map_shared(sizeof(WorkerChannel) + m_ring_capacity);
+        auto channel = new(memory) WorkerChannel();
+        channel->Capacity = m_ring_capacity;
+        sem_init(&channel->JobsReady, 1, 0);
+
+        m_workers.push_back(Worker{-1, channel, {}});
+        Spawn(m_workers.back());
+    }
+}
+
+
+ProcessPoolEvaluator::~ProcessPoolEvaluator()
+{
+    for(auto& worker : m_workers)
+    {
+        if(worker.Pid > 0)
+        {
+            kill(worker.Pid, SIGKILL);
+            waitpid(worker.Pid, nullptr, 0);
+        }
+        sem_destroy(&worker.Channel->JobsReady);
+        worker.Channel->~WorkerChannel();
+        munmap(worker.Channel, sizeof(WorkerChannel) + m_ring_capacity);
+    }
+    sem_destroy(static_cast<sem_t*>(m_shared));
+    munmap(m_shared, m_shared_size);
+}
+
+
+void ProcessPoolEvaluator::Evaluate(const std::vector<SNeuralNetPtr>& brains, const FitnessReport& report)
+{
+    std::deque<std::size_t> pending;
+    for(std::size_t i = 0; i < brains.size(); ++i)
+    {
+        pending.push_back(i);
+    }
+
+    std::size_t num_reported = 0;
+    auto counted_report = [&](std::size_t idx, double fitness)
+    {
+        report(idx, fitness);
+        ++num_reported;
+    };
+
+    std::vector<std::uint8_t> job;
+    try
+    {
+        while(num_reported < brains.size())
+        {
+            bool progress = false;
+            for(auto& worker : m_workers)
+            {
+                progress |= CollectResults(worker, counted_report) > 0;
+
+                if(waitpid(worker.Pid, nullptr, WNOHANG) == worker.Pid)
+                {
+                    worker.Pid = -1;
+                    // anything the worker finished before dying still counts
+                    CollectResults(worker, counted_report);
+                    ++m_num_crashes;
+
+                    // the oldest outstanding network is the one that was being
+                    // evaluated, the rest goes back to the queue
+                    if(!worker.Outstanding.empty())
+                    {
+                        counted_report(worker.Outstanding.front(), m_penalty);
+                        worker.Outstanding.pop_front();
+                        pending.insert(pending.begin(), worker.Outstanding.begin(), worker.Outstanding.end());
+                        worker.Outstanding.clear();
+                    }
+                    Spawn(worker);
+                    progress = true;
+                }
+
+                while(!pending.empty() && worker.Outstanding.size() < MAX_QUEUED_PER_WORKER)
+                {
+                    job.clear();
+                    BinaryWriter writer(job);
+                    encode_net(writer, *brains[pending.front()]);
+                    if(!Dispatch(worker, pending.front(), job))
+                    {
+                        break;
+                    }
+                    worker.Outstanding.push_back(pending.front());
+                    pending.pop_front();
+                    progress = true;
+                }
+            }
+
+            if(!progress)
+            {
+                auto deadline = std::chrono::system_clock::now() + RESULT_WAIT;
+                auto since_epoch = deadline.time_since_epoch();
+                auto seconds = std::chrono::duration_cast<std::chrono::seconds>(since_epoch);
+                timespec ts;
+                ts.tv_sec = seconds.count();
+                ts.tv_nsec = std::chrono::duration_cast<std::chrono::nanoseconds>(since_epoch - seconds).count();
+                sem_timedwait(static_cast<sem_t*>(m_shared), &ts);
+            }
+        }
+    }
+    catch(...)
+    {
+        // networks of this call may still be queued in the rings, their
+        // results must not reach a later call
+        DiscardOutstanding();
+        throw;
+    }
+}
+
+
+//=================================PRIVATE METHODS==============================
+
+/**
+ * Replaces every worker that still has networks queued or results waiting,
+ * along with its rings, so no result of an abandoned evaluation is ever
+ * collected. Workers that died are replaced too.
+ */
+void ProcessPoolEvaluator::DiscardOutstanding()
+{
+    for(auto& worker : m_workers)
+    {
+        auto channel = worker.Channel;
+        bool has_results = channel->ResultTail.load() != channel->ResultHead.load();
+        if(worker.Pid > 0 && worker.Outstanding.empty() && !has_results)
+        {
+            continue;
+        }
+        // a worker that died has been waited for already
+        if(worker.Pid > 0)
+        {
+            kill(worker.Pid, SIGKILL);
+            waitpid(worker.Pid, nullptr, 0);
+        }
+        worker.Outstanding.clear();
+        Spawn(worker);
+    }
+}
+
+
+void ProcessPoolEvaluator::Spawn(Worker& worker)
+{
+    auto channel = worker.Channel;
+    sem_destroy(&channel->JobsReady);
+    sem_init(&channel->JobsReady, 1, 0);
+    channel->JobHead = 0;
+    channel->JobTail = 0;
+    channel->ResultHead = 0;
+    channel->ResultTail = 0;
+
+    pid_t parent = getpid();
+    pid_t pid = fork();
+    if(pid < 0)
+    {
+        throw std::system_error(errno, std::generic_category(), "ProcessPoolEvaluator: fork failed");
+    }
+
+    if(pid == 0)
+    {
+        // don't outlive the parent
+        prctl(PR_SET_PDEATHSIG, SIGKILL);
+        if(getppid() != parent)
+        {
+            _exit(1);
+        }
+
+        // every worker starts out with a copy of the parent's random engine
+        auto tp = std::chrono::high_resolution_clock::now();
+        Utils::DefaultRandom::Instance().Seed(tp.time_since_epoch().count() ^ getpid());
+
+        run_worker(channel, static_cast<sem_t*>(m_shared), m_fitness);
+    }
+
+    worker.Pid = pid;
+}
+
+
+bool ProcessPoolEvaluator::Dispatch(Worker& worker, std::uint64_t job_id, const std::vector<std::uint8_t>& job)
+{
+    auto channel = worker.Channel;
+    auto capacity = channel->Capacity;
+    auto record_size = RECORD_HEADER_SIZE + padded(job.size());
+    // at most half the ring, so a record always fits once the ring is empty
+    if(record_size > capacity / 2)
+    {
+        throw std::length_error("ProcessPoolEvaluator: network doesn't fit into the ring buffer");
+    }
+
+    auto head = channel->JobHead.load(std::memory_order_relaxed);
+    auto tail = channel->JobTail.load(std::memory_order_acquire);
+    if(head == tail && head != 0)
+    {
+        // the worker copied out every record and won't touch JobTail before
+        // the next sem_post, so both can start over at the front of the ring
+        channel->JobTail.store(0, std::memory_order_relaxed);
+        channel->JobHead.store(0, std::memory_order_relaxed);
+        head = tail = 0;
+    }
+    auto free_space = capacity - (head - tail);
+    auto pos = head % capacity;
+    auto contiguous = capacity - pos;
+    auto wasted = contiguous < record_size ? contiguous : 0;
+
+    if(record_size + wasted > free_space)
+    {
+        return false;
+    }
+
+    auto jobs = channel->Jobs();
+    if(wasted)
+    {
+        std::memcpy(jobs + pos, &WRAP_MARKER, sizeof(WRAP_MARKER));
+        head += wasted;
+        pos = 0;
+    }
+
+    std::uint32_t size = job.size();
+    std::memcpy(jobs + pos, &size, sizeof(size));
+    std::memcpy(jobs + pos + 8, &job_id, sizeof(job_id));
+    std::memcpy(jobs + pos + RECORD_HEADER_SIZE, job.data(), job.size());
+
+    channel->JobHead.store(head + record_size, std::memory_order_release);
+    sem_post(&channel->JobsReady);
+    return true;
+}
+
+
+std::size_t ProcessPoolEvaluator::CollectResults(Worker& worker, const FitnessReport& report)
+{
+    auto channel = worker.Channel;
+    auto tail = channel->ResultTail.load(std::memory_order_relaxed);
+    auto head = channel->ResultHead.load(std::memory_order_acquire);
+
+    std::size_t num_results = 0;
+    for(; tail < head; ++tail, ++num_results)
+    {
+        auto result = channel->Results[tail % internal::RESULT_SLOTS];
+        // workers evaluate their networks in the order they were sent
+        worker.Outstanding.pop_front();
+        report(result.JobID, result.Fitness);
+    }
+    channel->ResultTail.store(tail, std::memory_order_release);
+    return num_results;
+}
+
+
+};
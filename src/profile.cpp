@@ -0,0 +1,164 @@
+#include "profile.h"
+
+namespace neat
+{
+
+
+std::string to_string(EpochPhase phase)
+{
+    switch(phase)
+    {
+        case EpochPhase::PURGE_SPECIES:
+            return "PurgeSpecies";
+        case EpochPhase::UPDATE_GENOME_SCORES:
+            return "UpdateGenomeScores";
+        case EpochPhase::SPECIATE_GENOMES:
+            return "SpeciateGenomes";
+        case EpochPhase::UPDATE_BEST_GENOMES:
+            return "UpdateBestGenomes";
+        case EpochPhase::UPDATE_SPECIES_FITNESS:
+            return "UpdateSpeciesFitness";
+        case EpochPhase::CALCULATE_SPAWN_AMOUNTS:
+            return "CalculateSpeciesSpawnAmounts";
+        case EpochPhase::CREATE_NEW_POPULATION:
+            return "CreateNewPopulation";
+        case EpochPhase::STATISTICS:
+            return "Statistics";
+        case EpochPhase::CREATE_PHENOTYPES:
+            return "CreateNeuralNetworks";
+        default:
+            return "NONE";
+    }
+}
+
+
+EpochProfile::EpochProfile(): m_phase_stats(),
+                              m_current(),
+                              m_accumulated(),
+                              m_accumulated_start(),
+                              m_origin(Clock::now()),
+                              m_generation(0),
+                              m_tracing(false),
+                              m_events()
+{}
+
+
+void EpochProfile::Record(EpochPhase phase, Clock::time_point start, Clock::time_point end)
+{
+    double duration = std::chrono::duration<double>(end - start).count();
+    m_current[static_cast<std::size_t>(phase)] += duration;
+    if(m_tracing)
+    {
+        double since_origin = std::chrono::duration<double>(start - m_origin).count();
+        m_events.push_back(TraceEvent{phase, m_generation, since_origin, duration});
+    }
+}
+
+
+void EpochProfile::Accumulate(EpochPhase phase, Clock::time_point start, Clock::time_point end)
+{
+    auto idx = static_cast<std::size_t>(phase);
+    m_current[idx] += std::chrono::duration<double>(end - start).count();
+    if(!m_accumulated[idx])
+    {
+        m_accumulated[idx] = true;
+        m_accumulated_start[idx] = start;
+    }
+}
+
+
+void EpochProfile::FinishEpoch()
+{
+    for(std::size_t i = 0; i < NUM_EPOCH_PHASES; ++i)
+    {
+        if(m_accumulated[i] && m_tracing)
+        {
+            // starts with the first piece and lasts as long as all of them
+            double since_origin = std::chrono::duration<double>(m_accumulated_start[i] - m_origin).count();
+            m_events.push_back(TraceEvent{static_cast<EpochPhase>(i), m_generation, since_origin, m_current[i]});
+        }
+        m_accumulated[i] = false;
+    }
+    for(std::size_t i = 0; i < NUM_EPOCH_PHASES; ++i)
+    {
+        m_phase_stats[i].Push(m_current[i]);
+        m_current[i] = 0.0;
+    }
+    ++m_generation;
+}
+
+
+double EpochProfile::LastEpochSeconds() const
+{
+    double total = 0.0;
+    for(auto& stat : m_phase_stats)
+    {
+        total += stat.LastValue();
+    }
+    return total;
+}
+
+
+nlohmann::json EpochProfile::serialize() const
+{
+    nlohmann::json events = nlohmann::json::array();
+    for(auto& event : m_events)
+    {
+        events.push_back({
+            {"name", to_string(event.Phase)},
+            {"cat", "epoch"},
+            {"ph", "X"},
+            {"ts", event.Start * 1e6},
+            {"dur", event.Duration * 1e6},
+            {"pid", 0},
+            {"tid", 0},
+            {"args", {{"generation", event.Generation}}}
+        });
+    }
+
+    nlohmann::json object = {
+        {"traceEvents", events},
+        {"displayTimeUnit", "ms"}
+    };
+    return object;
+}
+
+
+// keys in the order json::dump prints them
+void EpochProfile::serialize_to(JsonWriter& writer) const
+{
+    writer.BeginObject();
+    writer.Key("displayTimeUnit");
+    writer.Value("ms");
+    writer.Key("traceEvents");
+    writer.BeginArray();
+    for(auto& event : m_events)
+    {
+        writer.BeginObject();
+        writer.Key("args");
+        writer.BeginObject();
+        writer.Key("generation");
+        writer.Value(event.Generation);
+        writer.EndObject();
+        writer.Key("cat");
+        writer.Value("epoch");
+        writer.Key("dur");
+        writer.Value(event.Duration * 1e6);
+        writer.Key("name");
+        writer.Value(to_string(event.Phase));
+        writer.Key("ph");
+        writer.Value("X");
+        writer.Key("pid");
+        writer.Value(0);
+        writer.Key("tid");
+        writer.Value(0);
+        writer.Key("ts");
+        writer.Value(event.Start * 1e6);
+        writer.EndObject();
+    }
+    writer.EndArray();
+    writer.EndObject();
+}
+
+
+};
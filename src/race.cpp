@@ -0,0 +1,260 @@
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <stdexcept>
+#include <unordered_map>
+
+#include "genalg.h"
+#include "race.h"
+
+namespace neat
+{
+
+
+static std::vector<SpeciesID> species_of(const GenAlg& ga, std::size_t num_brains)
+{
+    auto& genomes = ga.GetGenomes();
+    if(genomes.size() != num_brains)
+    {
+        throw std::invalid_argument("Race number of networks doesn't match number of genomes");
+    }
+
+    std::vector<SpeciesID> species;
+    species.reserve(genomes.size());
+    for(auto& g : genomes)
+    {
+        species.push_back(g.GetSpeciesID());
+    }
+    return species;
+}
+
+
+Race::Race(const std::vector<SNeuralNetPtr>& brains,
+           std::size_t num_episodes,
+           double survival_rate,
+           std::vector<SpeciesID> groups,
+           std::size_t min_episodes,
+           double z): m_num_episodes(num_episodes),
+                      m_survival_rate(survival_rate),
+                      m_min_episodes(min_episodes),
+                      m_z(z),
+                      m_entries(brains.size(), Entry{0, 0.0, 0.0, false}),
+                      m_groups(std::move(groups)),
+                      m_members(),
+                      m_group_of(),
+                      m_index(),
+                      m_num_aborted(0),
+                      m_episodes_played(0)
+{
+    if(m_num_episodes == 0)
+    {
+        throw std::invalid_argument("Race needs at least one episode per network");
+    }
+    if(m_groups.empty())
+    {
+        m_groups.assign(brains.size(), SpeciesID(0));
+    }
+    if(m_groups.size() != brains.size())
+    {
+        throw std::invalid_argument("Race needs a group for every network");
+    }
+
+    for(std::size_t i = 0; i < brains.size(); ++i)
+    {
+        m_index[brains[i].get()] = i;
+    }
+    GroupMembers();
+}
+
+
+/**
+ * Only truncation selection leaves members of a species without a chance to
+ * be a parent. The other selections may pick any member, so with them every
+ * member survives and no network is dropped.
+ */
+static double race_survival_rate(const Params& params)
+{
+    return params.Selection() == SelectionType::TRUNCATION ? params.SurvivalRate() : 1.0;
+}
+
+
+Race::Race(const GenAlg& ga,
+           const std::vector<SNeuralNetPtr>& brains,
+           std::size_t num_episodes,
+           std::size_t min_episodes,
+           double z): Race(brains, num_episodes, race_survival_rate(ga.Parameters()),
+                           species_of(ga, brains.size()), min_episodes, z)
+{
+}
+
+
+bool Race::Report(const SNeuralNetPtr& brain, double score)
+{
+    auto idx = IndexOf(brain);
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    Entry& entry = m_entries[idx];
+    if(entry.Aborted || entry.NumEpisodes == m_num_episodes)
+    {
+        throw std::logic_error("Race::Report network already stopped playing");
+    }
+
+    // Welford's running mean and variance
+    ++entry.NumEpisodes;
+    double delta = score - entry.Mean;
+    entry.Mean += delta / entry.NumEpisodes;
+    entry.M2 += delta * (score - entry.Mean);
+    ++m_episodes_played;
+
+    if(entry.NumEpisodes == m_num_episodes)
+    {
+        return false;
+    }
+    if(entry.NumEpisodes >= m_min_episodes && !CanSurvive(idx))
+    {
+        entry.Aborted = true;
+        ++m_num_aborted;
+        return false;
+    }
+    return true;
+}
+
+
+bool Race::ShouldContinue(const SNeuralNetPtr& brain) const
+{
+    auto idx = IndexOf(brain);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return !m_entries[idx].Aborted && m_entries[idx].NumEpisodes < m_num_episodes;
+}
+
+
+double Race::Finalize(const SNeuralNetPtr& brain) const
+{
+    auto idx = IndexOf(brain);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if(m_entries[idx].NumEpisodes == 0)
+    {
+        throw std::logic_error("Race::Finalize network hasn't played any episode");
+    }
+    return m_entries[idx].Mean;
+}
+
+
+FitnessFunc Race::Fitness(EpisodeFunc episode)
+{
+    return [this, episode](SNeuralNetPtr brain)
+    {
+        std::size_t num_played = 0;
+        while(Report(brain, episode(brain, num_played++)))
+        {}
+        return Finalize(brain);
+    };
+}
+
+
+std::size_t Race::NumAborted() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_num_aborted;
+}
+
+
+std::size_t Race::EpisodesPlayed() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_episodes_played;
+}
+
+
+bool Race::IsAborted(const SNeuralNetPtr& brain) const
+{
+    auto idx = IndexOf(brain);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_entries[idx].Aborted;
+}
+
+
+//=================================PRIVATE METHODS==============================
+
+double Race::LowerBound(const Entry& entry) const
+{
+    if(entry.NumEpisodes == m_num_episodes)
+    {
+        return entry.Mean;
+    }
+    if(entry.NumEpisodes < 2)
+    {
+        return -std::numeric_limits<double>::infinity();
+    }
+    return entry.Mean - m_z * std::sqrt(entry.M2 / (entry.NumEpisodes - 1) / entry.NumEpisodes);
+}
+
+
+double Race::UpperBound(const Entry& entry) const
+{
+    if(entry.NumEpisodes == m_num_episodes)
+    {
+        return entry.Mean;
+    }
+    if(entry.NumEpisodes < 2)
+    {
+        return std::numeric_limits<double>::infinity();
+    }
+    return entry.Mean + m_z * std::sqrt(entry.M2 / (entry.NumEpisodes - 1) / entry.NumEpisodes);
+}
+
+
+/**
+ * Species::Spawn picks parents among the first SurvivalRate * size + 1
+ * members, and the leader survives anyway. A network that is surely beaten
+ * by that many others of its group can't become a parent.
+ */
+bool Race::CanSurvive(std::size_t idx) const
+{
+    const auto& members = m_members[m_group_of[idx]];
+    std::size_t group_size = members.size();
+    std::size_t num_better = 0;
+    double upper = UpperBound(m_entries[idx]);
+    for(auto i : members)
+    {
+        if(i != idx && LowerBound(m_entries[i]) > upper)
+        {
+            ++num_better;
+        }
+    }
+
+    std::size_t num_survivors = std::min<std::size_t>(group_size * m_survival_rate + 1, group_size - 1) + 1;
+    return num_better < num_survivors;
+}
+
+
+void Race::GroupMembers()
+{
+    std::unordered_map<int, std::size_t> group_idx;
+    m_members.clear();
+    m_group_of.resize(m_groups.size());
+    for(std::size_t i = 0; i < m_groups.size(); ++i)
+    {
+        auto inserted = group_idx.emplace(static_cast<int>(m_groups[i]), m_members.size());
+        if(inserted.second)
+        {
+            m_members.emplace_back();
+        }
+        m_group_of[i] = inserted.first->second;
+        m_members[m_group_of[i]].push_back(i);
+    }
+}
+
+
+std::size_t Race::IndexOf(const SNeuralNetPtr& brain) const
+{
+    auto found = m_index.find(brain.get());
+    if(found == m_index.end())
+    {
+        throw std::invalid_argument("Race got a network that isn't part of it");
+    }
+    return found->second;
+}
+
+
+};
@@ -1,4 +1,5 @@
 #include <fstream>
+#include <stdexcept>
 
 #include "serialize.h"
 #include "utils.h"
@@ -7,17 +8,143 @@ namespace neat
 {
 
 
-void serialize_to_file(std::string path, const ISerialize& object, bool pretty)
+JsonWriter::JsonWriter(std::ostream& out, int indent) : m_out(out),
+                                                          m_indent(indent),
+                                                          m_levels(),
+                                                          m_after_key(false)
+{}
+
+
+void JsonWriter::NewLine(std::size_t depth)
 {
-    std::ofstream out(path);
-    if(pretty)
+    if(m_indent >= 0)
+    {
+        m_out << '\n' << std::string(depth * m_indent, ' ');
+    }
+}
+
+
+void JsonWriter::BeforeValue()
+{
+    if(m_after_key)
+    {
+        m_after_key = false;
+        return;
+    }
+    if(!m_levels.empty())
+    {
+        if(m_levels.back().IsObject)
+        {
+            throw std::logic_error("Json object values need a key");
+        }
+        if(!m_levels.back().IsEmpty)
+        {
+            m_out << ',';
+        }
+        m_levels.back().IsEmpty = false;
+        NewLine(m_levels.size());
+    }
+}
+
+
+void JsonWriter::BeginObject()
+{
+    BeforeValue();
+    m_out << '{';
+    m_levels.push_back({true, true});
+}
+
+
+void JsonWriter::EndObject()
+{
+    if(m_levels.empty() || !m_levels.back().IsObject || m_after_key)
+    {
+        throw std::logic_error("No json object to end");
+    }
+    bool is_empty = m_levels.back().IsEmpty;
+    m_levels.pop_back();
+    if(!is_empty)
+    {
+        NewLine(m_levels.size());
+    }
+    m_out << '}';
+}
+
+
+void JsonWriter::BeginArray()
+{
+    BeforeValue();
+    m_out << '[';
+    m_levels.push_back({false, true});
+}
+
+
+void JsonWriter::EndArray()
+{
+    if(m_levels.empty() || m_levels.back().IsObject)
+    {
+        throw std::logic_error("No json array to end");
+    }
+    bool is_empty = m_levels.back().IsEmpty;
+    m_levels.pop_back();
+    if(!is_empty)
+    {
+        NewLine(m_levels.size());
+    }
+    m_out << ']';
+}
+
+
+void JsonWriter::Key(const std::string& key)
+{
+    if(m_levels.empty() || !m_levels.back().IsObject || m_after_key)
+    {
+        throw std::logic_error("Json keys only go into objects");
+    }
+    if(!m_levels.back().IsEmpty)
+    {
+        m_out << ',';
+    }
+    m_levels.back().IsEmpty = false;
+    NewLine(m_levels.size());
+    m_out << nlohmann::json(key).dump() << (m_indent >= 0 ? ": " : ":");
+    m_after_key = true;
+}
+
+
+void JsonWriter::Value(const nlohmann::json& value)
+{
+    BeforeValue();
+    std::string text = value.dump(m_indent);
+    if(m_indent < 0 || m_levels.empty())
     {
-        out << object.serialize().dump(2);
+        m_out << text;
+        return;
     }
-    else
+    // strings are escaped by dump, so every newline is one of its line breaks
+    std::string padding(m_levels.size() * m_indent, ' ');
+    for(char c : text)
     {
-        out << object.serialize().dump();
+        m_out << c;
+        if(c == '\n')
+        {
+            m_out << padding;
+        }
     }
+}
+
+
+void serialize_to_stream(std::ostream& out, const ISerialize& object, bool pretty)
+{
+    JsonWriter writer(out, pretty ? 2 : -1);
+    object.serialize_to(writer);
+}
+
+
+void serialize_to_file(std::string path, const ISerialize& object, bool pretty)
+{
+    std::ofstream out(path);
+    serialize_to_stream(out, object, pretty);
     out.close();
 }
 
@@ -1,37 +1,103 @@
+#include <algorithm>
 #include <cassert>
 
-#include "cpplinq.hpp"
 #include "species.h"
 #include "utils.h"
 
 namespace neat
 {
 
-Species::Species(Genome& originator, SpeciesID id, Params* params): m_leader(originator),
-                                                                    m_id(id),
-                                                                    m_members(),
-                                                                    m_gens_no_improvement(0),
-                                                                    m_age(0),
-                                                                    m_spawns_required(0),
-                                                                    m_params(params)
+std::vector<double> selection_weights(const Params& params, const std::vector<double>& fitness)
 {
-    m_members.push_back(&originator);
+    std::size_t size = fitness.size();
+    if(params.Selection() == SelectionType::FITNESS_PROPORTIONAL || size < 2)
+    {
+        return fitness;
+    }
+
+    std::vector<double> weights(size, 1.0);
+    if(params.Selection() == SelectionType::RANK)
+    {
+        // linear ranking, the fittest gets pressure times the average weight
+        double pressure = params.SelectionPressure();
+        for(std::size_t rank = 0; rank < size; ++rank)
+        {
+            weights[rank] = 2 - pressure + 2 * (pressure - 1) * (size - 1 - rank) / (size - 1);
+        }
+    }
+    return weights;
 }
 
+
+Species::Species(std::size_t originator,
+                 std::vector<Genome>* population,
+                 SpeciesID id,
+                 Params* params): m_leader(),
+                                  m_leader_is_member(true),
+                                  m_leader_idx(originator),
+                                  m_id(id),
+                                  m_population(population),
+                                  m_first(0),
+                                  m_size(1),
+                                  m_gens_no_improvement(0),
+                                  m_age(0),
+                                  m_spawns_required(0),
+                                  m_params(params)
+{}
+
+Species::Species(const Genome& leader,
+                 SpeciesID id,
+                 std::size_t gens_no_improvement,
+                 std::size_t age,
+                 double spawns_required,
+                 std::vector<Genome>* population,
+                 Params* params): m_leader(leader),
+                                  m_leader_is_member(false),
+                                  m_leader_idx(0),
+                                  m_id(id),
+                                  m_population(population),
+                                  m_first(0),
+                                  m_size(0),
+                                  m_gens_no_improvement(gens_no_improvement),
+                                  m_age(age),
+                                  m_spawns_required(spawns_required),
+                                  m_params(params)
+{}
+
 //==============================PUBLIC METHODS=================================
-void Species::AddMember(Genome& new_member)
+void Species::AddMember(std::size_t new_member)
 {
-    if(new_member.Fitness() > m_leader.Fitness())
+    if((*m_population)[new_member].Fitness() > LeaderFitness())
     {
-        m_leader = new_member;
+        m_leader_is_member = true;
+        m_leader_idx = new_member;
         m_gens_no_improvement = 0;
     }
-    m_members.push_back(&new_member);
+    ++m_size;
+}
+
+void Species::SetMembers(std::size_t first, const std::vector<std::size_t>& new_positions)
+{
+    m_first = first;
+    if(m_leader_is_member)
+    {
+        m_leader_idx = new_positions[m_leader_idx];
+    }
+}
+
+void Species::KeepLeader()
+{
+    if(m_leader_is_member)
+    {
+        m_leader = std::move((*m_population)[m_leader_idx]);
+        m_leader_is_member = false;
+    }
 }
 
 void Species::Purge()
 {
-    m_members.clear();
+    m_first = 0;
+    m_size = 0;
     ++m_age;
     ++m_gens_no_improvement;
     m_spawns_required = 0;
@@ -39,9 +105,10 @@ void Species::Purge()
 
 void Species::AdjustFitness()
 {
-    for(auto genome : m_members)
+    for(std::size_t i = 0; i < m_size; ++i)
     {
-        double fitness = genome->Fitness();
+        Genome& genome = Member(i);
+        double fitness = genome.Fitness();
         assert(fitness >= 0);
 
         if(m_age < m_params->YoungBonusThreshold())
@@ -52,37 +119,58 @@ void Species::AdjustFitness()
         {
             fitness *= m_params->OldPenaltyScaler();
         }
-        double shared_fitness = fitness / m_members.size();
+        double shared_fitness = fitness / m_size;
 
         assert(shared_fitness >= 0);
-        genome->SetAjustedFitness(shared_fitness);
+        genome.SetAjustedFitness(shared_fitness);
     }
 }
 
 void Species::CalculateSpawnAmount()
 {
-    m_spawns_required = cpplinq::from(m_members)
-        >> cpplinq::sum([](const Genome* const g)
-            {
-                return g->AmountToSpawn();
-            });
+    m_spawns_required = 0;
+    for(std::size_t i = 0; i < m_size; ++i)
+    {
+        m_spawns_required += Member(i).AmountToSpawn();
+    }
     assert(m_spawns_required >= 0);
 }
 
+void Species::PrepareSelection()
+{
+    if(m_params->Selection() == SelectionType::TRUNCATION)
+    {
+        return;
+    }
+
+    std::vector<double> fitness(m_size);
+    for(std::size_t i = 0; i < m_size; ++i)
+    {
+        fitness[i] = Member(i).Fitness();
+    }
+    m_parents.Build(selection_weights(*m_params, fitness));
+}
+
 Genome* Species::Spawn()
 {
     auto& random = Utils::DefaultRandom::Instance();
 
-    assert(m_members.size() > 0);
-    if(m_members.size() == 1)
+    assert(m_size > 0);
+    if(m_size == 1)
+    {
+        return &Member(0);
+    }
+    else if(m_params->Selection() != SelectionType::TRUNCATION)
     {
-        return m_members[0];
+        assert(m_parents.Size() == m_size);
+        return &Member(m_parents.Sample(random));
     }
     else
     {
-        int max_idx = m_members.size() * m_params->SurvivalRate() + 1;
+        int max_idx = std::min<int>(m_size * m_params->SurvivalRate() + 1,
+                                    m_size - 1);
         int the_one = random.RandomClamped(0, max_idx);
-        return m_members[the_one];
+        return &Member(the_one);
     }
 }
 
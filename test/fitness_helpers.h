@@ -0,0 +1,49 @@
+#ifndef __FITNESS_HELPERS_H__
+#define __FITNESS_HELPERS_H__
+
+/**
+ * Fitness functions shared by the tests.
+ */
+
+#include <vector>
+
+#include "phenotype.h"
+
+
+// how close a network with two inputs and one output gets to XOR, 0 to 4
+// where 4 is a perfect XOR
+inline double xor_fitness(neat::SNeuralNetPtr brain)
+{
+    double error = 0.0;
+    error += brain->Update({0, 0}, neat::UPDATE_TYPE::SNAPSHOT)[0];
+    error += 1 - brain->Update({0, 1}, neat::UPDATE_TYPE::SNAPSHOT)[0];
+    error += 1 - brain->Update({1, 0}, neat::UPDATE_TYPE::SNAPSHOT)[0];
+    error += brain->Update({1, 1}, neat::UPDATE_TYPE::SNAPSHOT)[0];
+    return 4 - error;
+}
+
+
+inline std::vector<double> xor_scores(const std::vector<neat::SNeuralNetPtr>& brains)
+{
+    std::vector<double> scores;
+    for(auto& brain : brains)
+    {
+        scores.push_back(xor_fitness(brain));
+    }
+    return scores;
+}
+
+
+// deterministic fitness that rewards larger networks
+inline double count_links(neat::SNeuralNetPtr brain)
+{
+    double num_links = 0;
+    for(auto& n : brain->GetNeurons())
+    {
+        num_links += n.InLinks.size();
+    }
+    return num_links;
+}
+
+
+#endif
@@ -0,0 +1,340 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <set>
+#include <vector>
+
+#include "binary.h"
+#include "binformat.h"
+#include "checkpoint.h"
+#include "fitness_helpers.h"
+#include "genalg.h"
+
+
+// everything that identifies a population, flattened for comparison
+std::vector<double> fingerprint(const neat::GenAlg& ga)
+{
+    std::vector<double> values{static_cast<double>(ga.Generation()), ga.BestEverFitness()};
+    for(auto& g : ga.GetGenomes())
+    {
+        values.push_back(g.ID());
+        for(auto& lg : g.NeuronLinks())
+        {
+            values.insert(values.end(), {lg.Weight, (double)lg.FromNeuronID, (double)lg.ToNeuronID, (double)lg.InnovID});
+        }
+        for(auto& ng : g.NeuronGenes())
+        {
+            values.push_back(ng.ActivationResponse);
+        }
+    }
+    return values;
+}
+
+
+std::vector<std::vector<double>> evolve(neat::GenAlg& ga, int num_generations)
+{
+    std::vector<std::vector<double>> history;
+    auto brains = ga.CreateNeuralNetworks();
+    for(int i = 0; i < num_generations; ++i)
+    {
+        brains = ga.Epoch(xor_scores(brains));
+        history.push_back(fingerprint(ga));
+    }
+    return history;
+}
+
+
+// genes an offspring doesn't share with its parent, split into the ones that
+// only got a new weight or activation response and the ones it gained, lost
+// or changed otherwise
+struct GeneChanges
+{
+    std::size_t Values = 0;
+    std::size_t Structure = 0;
+};
+
+
+template <typename TGene, typename TKey, typename TEncode>
+void count_changed_genes(GeneChanges& changes,
+                         const std::vector<TGene>& genes,
+                         const std::vector<TGene>& parent_genes,
+                         TKey key,
+                         TEncode encode,
+                         double TGene::* value)
+{
+    auto encoded = [&](TGene gene, bool with_value)
+    {
+        if(!with_value)
+        {
+            gene.*value = 0;
+        }
+        std::vector<std::uint8_t> buffer;
+        neat::BinaryWriter writer(buffer);
+        encode(writer, gene);
+        return buffer;
+    };
+
+    std::map<int, const TGene*> inherited;
+    for(auto& gene : parent_genes)
+    {
+        inherited[key(gene)] = &gene;
+    }
+    std::set<int> own;
+    for(auto& gene : genes)
+    {
+        own.insert(key(gene));
+        auto found = inherited.find(key(gene));
+        if(found == inherited.end() || encoded(gene, false) != encoded(*found->second, false))
+        {
+            ++changes.Structure;
+        }
+        else if(encoded(gene, true) != encoded(*found->second, true))
+        {
+            ++changes.Values;
+        }
+    }
+    for(auto& gene : inherited)
+    {
+        changes.Structure += !own.count(gene.first);
+    }
+}
+
+
+SCENARIO("An evolution continues exactly after being restored from a checkpoint", "[checkpoint]")
+{
+    GIVEN("A GenAlg that evolved for a few generations")
+    {
+        auto p = neat::Params::FromString(R"({"ChanceAddNeuron": 0.2, "ChanceAddLink": 0.5})");
+        neat::GenAlg ga(2, 1, p);
+        evolve(ga, 5);
+
+        WHEN("It is checkpointed and keeps evolving")
+        {
+            ga.SaveCheckpoint("evolution.ckpt");
+            auto original = evolve(ga, 5);
+
+            THEN("The restored evolution produces the same generations")
+            {
+                neat::GenAlg restored(neat::read_checkpoint("evolution.ckpt"));
+                REQUIRE(restored.Generation() == 5);
+                REQUIRE(evolve(restored, 5) == original);
+            }
+        }
+
+        WHEN("It is checkpointed in the background while the next generation is evaluated")
+        {
+            auto brains = ga.CreateNeuralNetworks();
+            auto saved = ga.SaveCheckpointAsync("evolution_async.ckpt");
+            auto scores = xor_scores(brains);
+            saved.get();
+            brains = ga.Epoch(scores);
+            auto original = fingerprint(ga);
+
+            THEN("The checkpoint holds the state from before the evaluation")
+            {
+                neat::GenAlg restored(neat::read_checkpoint("evolution_async.ckpt"));
+                restored.Epoch(xor_scores(restored.CreateNeuralNetworks()));
+                REQUIRE(fingerprint(restored) == original);
+            }
+        }
+
+        WHEN("Scores of the current generation were already submitted")
+        {
+            ga.SubmitFitness(ga.GetGenomes()[0].ID(), 1.0);
+
+            THEN("No snapshot can be taken")
+            {
+                REQUIRE_THROWS_AS(ga.Snapshot(), std::logic_error);
+            }
+        }
+
+        WHEN("The checkpoint file is damaged")
+        {
+            ga.SaveCheckpoint("evolution.ckpt");
+            std::ifstream in("evolution.ckpt", std::ios::binary);
+            std::vector<std::uint8_t> buffer((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+            THEN("It can't be loaded")
+            {
+                REQUIRE_THROWS_AS(neat::decode_checkpoint(buffer.data(), buffer.size() / 2), std::runtime_error);
+                buffer[0] = 'X';
+                REQUIRE_THROWS_AS(neat::decode_checkpoint(buffer.data(), buffer.size()), std::runtime_error);
+            }
+        }
+    }
+}
+
+
+SCENARIO("An evolution is restored from a log of delta checkpoints", "[checkpoint]")
+{
+    GIVEN("A GenAlg writing a checkpoint log every generation")
+    {
+        auto p = neat::Params::FromString(R"({"ChanceAddNeuron": 0.2, "ChanceAddLink": 0.5})");
+        neat::GenAlg ga(2, 1, p);
+        neat::CheckpointLog log("evolution.log", 3);
+
+        std::size_t full_size = 0;
+        std::size_t delta_size = 0;
+        auto brains = ga.CreateNeuralNetworks();
+        for(int i = 0; i < 7; ++i)
+        {
+            brains = ga.Epoch(xor_scores(brains));
+            log.Write(ga.Snapshot());
+            (log.NumDeltas() == 0 ? full_size : delta_size) = log.LastWriteSize();
+        }
+
+        THEN("Full snapshots are written periodically and deltas in between")
+        {
+            // full at generations 1, 5, deltas at 2, 3, 4, 6, 7
+            REQUIRE(log.NumDeltas() == 2);
+            REQUIRE(delta_size < full_size);
+        }
+
+        WHEN("The state hasn't changed since the last checkpoint")
+        {
+            log.Write(ga.Snapshot());
+
+            THEN("The delta only refers to the genomes written before")
+            {
+                REQUIRE(log.LastWriteSize() < full_size / 3);
+            }
+        }
+
+        WHEN("The log is replayed")
+        {
+            auto expected = fingerprint(ga);
+            auto original = evolve(ga, 3);
+
+            THEN("The restored evolution continues exactly")
+            {
+                neat::GenAlg restored(neat::read_checkpoint_log("evolution.log"));
+                REQUIRE(fingerprint(restored) == expected);
+                REQUIRE(evolve(restored, 3) == original);
+            }
+        }
+
+        WHEN("The log is compacted")
+        {
+            auto expected = fingerprint(ga);
+            neat::compact_checkpoint_log("evolution.log");
+
+            THEN("It holds the same state")
+            {
+                neat::GenAlg restored(neat::read_checkpoint_log("evolution.log"));
+                REQUIRE(fingerprint(restored) == expected);
+            }
+        }
+
+        WHEN("Writing the last delta was interrupted")
+        {
+            auto expected = fingerprint(ga);
+            brains = ga.Epoch(xor_scores(brains));
+            log.Write(ga.Snapshot());
+            std::filesystem::resize_file("evolution.log", std::filesystem::file_size("evolution.log") - 10);
+
+            THEN("The log is restored up to the previous checkpoint")
+            {
+                neat::GenAlg restored(neat::read_checkpoint_log("evolution.log"));
+                REQUIRE(fingerprint(restored) == expected);
+            }
+        }
+    }
+}
+
+
+SCENARIO("A delta checkpoint grows with the genes that changed", "[checkpoint]")
+{
+    GIVEN("A GenAlg that evolved for a while and logged its population")
+    {
+        auto p = neat::Params::FromString(R"({"ChanceAddNeuron": 0.2, "ChanceAddLink": 0.5, "CompatibilityThreshold": 0.5})");
+        neat::GenAlg ga(2, 1, p);
+        evolve(ga, 20);
+
+        neat::CheckpointLog log("evolution_growth.log", 10);
+        auto previous = ga.Snapshot();
+        log.Write(previous);
+        auto full_size = log.LastWriteSize();
+
+        WHEN("The next generation is logged")
+        {
+            ga.Epoch(xor_scores(ga.CreateNeuralNetworks()));
+            auto next = ga.Snapshot();
+            log.Write(next);
+            auto delta_size = log.LastWriteSize();
+            // every genome is retained now
+            log.Write(next);
+            auto unchanged_size = log.LastWriteSize();
+
+            THEN("Its size is bounded by the offspring and the genes they changed")
+            {
+                std::map<int, const neat::Genome*> known;
+                for(auto genomes : {&previous.Genomes, &previous.BestGenomes})
+                {
+                    for(auto& g : *genomes)
+                    {
+                        known[g.ID()] = &g;
+                    }
+                }
+                for(auto& s : previous.Species)
+                {
+                    known[s.Leader.ID()] = &s.Leader;
+                }
+
+                std::size_t num_offspring = 0;
+                std::size_t num_genes = 0;
+                GeneChanges changes;
+                auto count = [&](const neat::Genome& g)
+                {
+                    num_genes += g.NumNeurons() + g.NumLinks();
+                    if(known.count(g.ID()))
+                    {
+                        return;
+                    }
+                    ++num_offspring;
+                    auto parent = known.find(g.ParentID());
+                    const neat::Genome none;
+                    auto& parent_genome = parent == known.end() ? none : *parent->second;
+                    count_changed_genes(changes, g.NeuronGenes(), parent_genome.NeuronGenes(),
+                                        [](const neat::NeuronGene& ng) { return ng.ID; },
+                                        neat::encode_neuron_gene, &neat::NeuronGene::ActivationResponse);
+                    count_changed_genes(changes, g.NeuronLinks(), parent_genome.NeuronLinks(),
+                                        [](const neat::LinkGene& lg) { return (int)lg.InnovID; },
+                                        neat::encode_link_gene, &neat::LinkGene::Weight);
+                };
+                for(auto genomes : {&next.Genomes, &next.BestGenomes})
+                {
+                    for(auto& g : *genomes)
+                    {
+                        count(g);
+                    }
+                }
+                for(auto& s : next.Species)
+                {
+                    count(s.Leader);
+                }
+
+                // over a retained genome an offspring costs its parent id, two
+                // edit counts and the first run of copies of each. A new value
+                // costs at most 13 bytes, any other change at most a neuron gene
+                // in full, and either may interrupt a run of copies.
+                auto num_new_innovations = next.Innovations.Innovations().size() -
+                                           previous.Innovations.Innovations().size();
+                REQUIRE(num_offspring > 0);
+                REQUIRE(changes.Values + changes.Structure < num_genes / 2);
+                REQUIRE(delta_size <= unchanged_size + 30 * num_offspring + (13 + 9) * changes.Values +
+                                      (31 + 9) * changes.Structure + 34 * num_new_innovations);
+                REQUIRE(delta_size < full_size / 2);
+            }
+
+            THEN("It replays to the logged generation")
+            {
+                neat::GenAlg restored(neat::read_checkpoint_log("evolution_growth.log"));
+                REQUIRE(fingerprint(restored) == fingerprint(ga));
+            }
+        }
+    }
+}
@@ -0,0 +1,260 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "distributed.h"
+#include "genalg.h"
+
+
+double slow_fitness(neat::SNeuralNetPtr brain)
+{
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    double error = 0.0;
+    error += brain->Update({0, 0}, neat::UPDATE_TYPE::SNAPSHOT)[0];
+    error += 1 - brain->Update({1, 1}, neat::UPDATE_TYPE::SNAPSHOT)[0];
+    return 2 - error;
+}
+
+
+std::vector<pid_t> start_workers(const std::string& address, std::size_t num_workers, neat::FitnessFunc fitness)
+{
+    std::vector<pid_t> pids;
+    for(std::size_t i = 0; i < num_workers; ++i)
+    {
+        pid_t pid = fork();
+        if(pid == 0)
+        {
+            // the exit status tells how many networks the worker scored
+            _exit(std::min<std::size_t>(neat::run_worker(address, fitness), 255));
+        }
+        pids.push_back(pid);
+    }
+    return pids;
+}
+
+
+std::vector<std::size_t> stop_workers(const std::vector<pid_t>& pids)
+{
+    std::vector<std::size_t> num_scored;
+    for(auto pid : pids)
+    {
+        int status = 0;
+        waitpid(pid, &status, 0);
+        num_scored.push_back(WIFEXITED(status) ? WEXITSTATUS(status) : 0);
+    }
+    return num_scored;
+}
+
+
+double seconds_to_evaluate(neat::IEvaluator& evaluator, const std::vector<neat::SNeuralNetPtr>& brains)
+{
+    auto start = std::chrono::steady_clock::now();
+    evaluator.Evaluate(brains, [](std::size_t, double) {});
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+
+SCENARIO("Networks are evaluated by workers connected over a socket", "[DistributedEvaluator]")
+{
+    GIVEN("A population and a coordinator on a Unix-domain socket")
+    {
+        auto p = neat::Params::FromString(R"({"PopulationSize": 120})");
+        neat::GenAlg ga(2, 1, p);
+        auto brains = ga.CreateNeuralNetworks();
+        std::string path = "unix:/tmp/neatnet_test_" + std::to_string(getpid()) + ".sock";
+
+        std::vector<double> expected;
+        for(auto& brain : brains)
+        {
+            expected.push_back(slow_fitness(brain));
+        }
+
+        WHEN("Three workers connect")
+        {
+            std::vector<pid_t> pids;
+            {
+                neat::DistributedEvaluator coordinator(path);
+                pids = start_workers(coordinator.Address(), 3, slow_fitness);
+                REQUIRE(coordinator.WaitForWorkers(3, std::chrono::seconds(10)) == 3);
+
+                std::vector<double> scores(brains.size(), -1);
+                coordinator.Evaluate(brains, [&](std::size_t idx, double fitness) { scores[idx] = fitness; });
+
+                THEN("Every network gets the same score it gets in this process")
+                {
+                    REQUIRE(scores == expected);
+                }
+
+                brains = ga.Epoch(brains, coordinator);
+                REQUIRE(ga.Generation() == 1);
+            }
+            stop_workers(pids);
+        }
+
+        WHEN("Reporting a score throws while networks are still out")
+        {
+            std::vector<pid_t> pids;
+            std::vector<neat::SNeuralNetPtr> rest(brains.rbegin(), brains.rend() - 10);
+            std::vector<double> scores(rest.size(), -1);
+            std::size_t num_scored = 0;
+            std::size_t num_workers = 0;
+            bool in_range = true;
+            {
+                neat::DistributedEvaluator coordinator(path);
+                pids = start_workers(coordinator.Address(), 3, slow_fitness);
+                REQUIRE(coordinator.WaitForWorkers(3, std::chrono::seconds(10)) == 3);
+
+                std::size_t num_reports = 0;
+                REQUIRE_THROWS_AS(coordinator.Evaluate(brains, [&](std::size_t, double)
+                    {
+                        if(++num_reports == 5)
+                        {
+                            throw std::invalid_argument("rejected score");
+                        }
+                    }), std::invalid_argument);
+
+                coordinator.Evaluate(rest, [&](std::size_t idx, double fitness)
+                    {
+                        in_range = in_range && idx < rest.size() && scores[idx] == -1;
+                        if(idx < rest.size())
+                        {
+                            scores[idx] = fitness;
+                        }
+                        ++num_scored;
+                    });
+                num_workers = coordinator.NumWorkers();
+            }
+            stop_workers(pids);
+
+            THEN("A retry with other networks only gets their results")
+            {
+                REQUIRE(in_range);
+                REQUIRE(num_scored == rest.size());
+                REQUIRE(num_workers == 3);
+                for(std::size_t i = 0; i < rest.size(); ++i)
+                {
+                    REQUIRE(scores[i] == expected[brains.size() - 1 - i]);
+                }
+            }
+        }
+
+        WHEN("No worker ever connects")
+        {
+            neat::DistributedEvaluator coordinator(path, std::chrono::milliseconds(300));
+            std::size_t num_reported = 0;
+
+            THEN("Evaluate gives up after the worker timeout")
+            {
+                auto start = std::chrono::steady_clock::now();
+                REQUIRE_THROWS_AS(coordinator.Evaluate(brains, [&](std::size_t, double) { ++num_reported; }),
+                                  std::runtime_error);
+                REQUIRE(std::chrono::steady_clock::now() - start >= std::chrono::milliseconds(300));
+                REQUIRE(num_reported == 0);
+            }
+        }
+
+        WHEN("A worker disconnects in the middle of the evaluation")
+        {
+            std::vector<pid_t> pids;
+            std::vector<double> scores(brains.size(), -1);
+            std::size_t num_requeued = 0;
+            {
+                neat::DistributedEvaluator coordinator(path);
+                pids = start_workers(coordinator.Address(), 2, slow_fitness);
+
+                int num_calls = 0;
+                auto quitting_fitness = [&num_calls](neat::SNeuralNetPtr brain)
+                {
+                    if(++num_calls == 5)
+                    {
+                        _exit(0);
+                    }
+                    return slow_fitness(brain);
+                };
+                auto quitter = start_workers(coordinator.Address(), 1, quitting_fitness);
+                pids.insert(pids.end(), quitter.begin(), quitter.end());
+
+                REQUIRE(coordinator.WaitForWorkers(3, std::chrono::seconds(10)) == 3);
+                coordinator.Evaluate(brains, [&](std::size_t idx, double fitness) { scores[idx] = fitness; });
+                num_requeued = coordinator.NumRequeued();
+            }
+            stop_workers(pids);
+
+            THEN("Its work is handed to the remaining workers")
+            {
+                REQUIRE(num_requeued > 0);
+                REQUIRE(scores == expected);
+            }
+        }
+    }
+
+    GIVEN("A coordinator on a loopback TCP port")
+    {
+        auto p = neat::Params::FromString(R"({"PopulationSize": 200})");
+        neat::GenAlg ga(2, 1, p);
+        auto brains = ga.CreateNeuralNetworks();
+
+        WHEN("The same population is evaluated by one and by four workers")
+        {
+            double one_worker = 0;
+            double four_workers = 0;
+
+            std::vector<pid_t> pids;
+            {
+                neat::DistributedEvaluator coordinator("tcp:127.0.0.1:0");
+                pids = start_workers(coordinator.Address(), 1, slow_fitness);
+                REQUIRE(coordinator.WaitForWorkers(1, std::chrono::seconds(10)) == 1);
+                one_worker = seconds_to_evaluate(coordinator, brains);
+            }
+            stop_workers(pids);
+
+            {
+                neat::DistributedEvaluator coordinator("tcp:127.0.0.1:0");
+                pids = start_workers(coordinator.Address(), 4, slow_fitness);
+                REQUIRE(coordinator.WaitForWorkers(4, std::chrono::seconds(10)) == 4);
+                four_workers = seconds_to_evaluate(coordinator, brains);
+            }
+            stop_workers(pids);
+
+            THEN("Throughput scales close to linearly")
+            {
+                // slow_fitness sleeps for every network, so the bound holds on a loaded machine too
+                REQUIRE(one_worker / four_workers >= 2.5);
+            }
+        }
+
+        WHEN("Four workers evaluate the population")
+        {
+            std::size_t num_reported = 0;
+            std::vector<pid_t> pids;
+            {
+                neat::DistributedEvaluator coordinator("tcp:127.0.0.1:0");
+                pids = start_workers(coordinator.Address(), 4, slow_fitness);
+                REQUIRE(coordinator.WaitForWorkers(4, std::chrono::seconds(10)) == 4);
+                coordinator.Evaluate(brains, [&](std::size_t, double) { ++num_reported; });
+            }
+            auto num_scored = stop_workers(pids);
+
+            THEN("Every worker gets a share of the work and every network is scored once")
+            {
+                REQUIRE(num_reported == brains.size());
+                std::size_t total = 0;
+                for(auto n : num_scored)
+                {
+                    REQUIRE(n > 0);
+                    total += n;
+                }
+                REQUIRE(total == brains.size());
+            }
+        }
+    }
+}
@@ -0,0 +1,277 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "evaluate.h"
+#include "fitness_helpers.h"
+#include "genalg.h"
+
+
+SCENARIO("A population is scored with the thread pool evaluator", "[ThreadPoolEvaluator]")
+{
+    GIVEN("A GenAlg and an evaluator with 4 threads")
+    {
+        neat::Params p;
+        neat::GenAlg ga(2, 1, p);
+        neat::ThreadPoolEvaluator evaluator(count_links, 4);
+        auto brains = ga.CreateNeuralNetworks();
+
+        WHEN("The networks are evaluated")
+        {
+            std::vector<double> scores(brains.size(), -1);
+            evaluator.Evaluate(brains, [&](std::size_t idx, double fitness) { scores[idx] = fitness; });
+
+            THEN("Every network gets its own score")
+            {
+                for(std::size_t i = 0; i < brains.size(); ++i)
+                {
+                    REQUIRE(scores[i] == count_links(brains[i]));
+                }
+            }
+        }
+
+        WHEN("Several generations are evolved through the evaluator")
+        {
+            for(int gen = 0; gen < 5; ++gen)
+            {
+                brains = ga.Epoch(brains, evaluator);
+            }
+
+            THEN("The generations advance")
+            {
+                REQUIRE(ga.Generation() == 5);
+                REQUIRE(brains.size() == p.PopulationSize());
+            }
+        }
+    }
+
+    GIVEN("A GenAlg and an evaluator whose fitness throws on its 50th call")
+    {
+        neat::Params p;
+        neat::GenAlg ga(2, 1, p);
+        auto brains = ga.CreateNeuralNetworks();
+
+        std::atomic<std::size_t> num_calls(0);
+        neat::ThreadPoolEvaluator evaluator([&num_calls](neat::SNeuralNetPtr brain)
+            {
+                if(++num_calls == 50)
+                {
+                    throw std::runtime_error("fitness failed");
+                }
+                return count_links(brain);
+            }, 4);
+
+        WHEN("The failed epoch is retried")
+        {
+            REQUIRE_THROWS_AS(ga.Epoch(brains, evaluator), std::runtime_error);
+            std::size_t num_scored = ga.NumScored();
+            REQUIRE(num_scored < brains.size());
+            REQUIRE(ga.Generation() == 0);
+
+            std::size_t calls_before = num_calls;
+            brains = ga.Epoch(brains, evaluator);
+
+            THEN("It only evaluates the genomes that are still missing a score")
+            {
+                REQUIRE(num_calls - calls_before == p.PopulationSize() - num_scored);
+                REQUIRE(ga.Generation() == 1);
+                REQUIRE(ga.NumScored() == 0);
+            }
+        }
+    }
+}
+
+
+SCENARIO("Stragglers are cut off by the async evaluator", "[AsyncEvaluator]")
+{
+    GIVEN("An async fitness function where one evaluation never finishes on its own")
+    {
+        using namespace std::chrono_literals;
+
+        neat::Params p;
+        neat::GenAlg ga(2, 1, p);
+        auto brains = ga.CreateNeuralNetworks();
+        const double penalty = 0.5;
+        std::atomic<int> num_calls(0);
+
+        auto fitness = [&](neat::SNeuralNetPtr brain, std::stop_token stop)
+        {
+            bool straggler = num_calls++ == 3;
+            return std::async(std::launch::async, [brain, stop, straggler]()
+                {
+                    while(straggler && !stop.stop_requested())
+                    {
+                        std::this_thread::sleep_for(1ms);
+                    }
+                    return count_links(brain);
+                });
+        };
+
+        neat::AsyncEvaluator evaluator(fitness, 8, 50ms, penalty);
+
+        WHEN("The population is evaluated")
+        {
+            std::vector<double> scores(brains.size(), -1);
+            auto start = std::chrono::steady_clock::now();
+            evaluator.Evaluate(brains, [&](std::size_t idx, double fitness) { scores[idx] = fitness; });
+            auto elapsed = std::chrono::steady_clock::now() - start;
+
+            THEN("The straggler gets the penalty fitness and everybody else their score")
+            {
+                REQUIRE(evaluator.NumTimeouts() == 1);
+                REQUIRE(scores[3] == penalty);
+                for(std::size_t i = 0; i < brains.size(); ++i)
+                {
+                    if(i != 3)
+                    {
+                        REQUIRE(scores[i] == count_links(brains[i]));
+                    }
+                }
+                REQUIRE(elapsed < 5s);
+            }
+        }
+
+        WHEN("A generation is evolved through the evaluator")
+        {
+            brains = ga.Epoch(brains, evaluator);
+
+            THEN("The epoch completes despite the straggler")
+            {
+                REQUIRE(ga.Generation() == 1);
+            }
+        }
+    }
+}
+
+
+SCENARIO("Deferred and failing evaluations are kept under control", "[AsyncEvaluator]")
+{
+    GIVEN("A population")
+    {
+        using namespace std::chrono_literals;
+
+        neat::Params p;
+        neat::GenAlg ga(2, 1, p);
+        auto brains = ga.CreateNeuralNetworks();
+
+        WHEN("The fitness function returns deferred futures and one of them never finishes")
+        {
+            std::atomic<int> num_calls(0);
+            auto fitness = [&](neat::SNeuralNetPtr brain, std::stop_token stop)
+            {
+                bool straggler = num_calls++ == 3;
+                return std::async(std::launch::deferred, [brain, stop, straggler]()
+                    {
+                        while(straggler && !stop.stop_requested())
+                        {
+                            std::this_thread::sleep_for(1ms);
+                        }
+                        return count_links(brain);
+                    });
+            };
+
+            neat::AsyncEvaluator evaluator(fitness, 8, 50ms, -1.0);
+            std::vector<double> scores(brains.size(), -2);
+            evaluator.Evaluate(brains, [&](std::size_t idx, double fitness) { scores[idx] = fitness; });
+
+            THEN("The deadline applies to them as well")
+            {
+                REQUIRE(evaluator.NumTimeouts() == 1);
+                REQUIRE(scores[3] == -1.0);
+                REQUIRE(scores[0] == count_links(brains[0]));
+            }
+        }
+
+        WHEN("One evaluation throws while others are in flight")
+        {
+            std::atomic<int> num_calls(0);
+            std::atomic<int> num_stopped(0);
+            auto fitness = [&](neat::SNeuralNetPtr, std::stop_token stop)
+            {
+                bool failing = num_calls++ == 0;
+                return std::async(std::launch::async, [&num_stopped, stop, failing]() -> double
+                    {
+                        if(failing)
+                        {
+                            throw std::runtime_error("evaluation failed");
+                        }
+                        while(!stop.stop_requested())
+                        {
+                            std::this_thread::sleep_for(1ms);
+                        }
+                        ++num_stopped;
+                        return 0.0;
+                    });
+            };
+
+            neat::AsyncEvaluator evaluator(fitness, 4, 5s, 0.0);
+
+            THEN("The others are stopped before the error is passed on")
+            {
+                REQUIRE_THROWS_AS(evaluator.Evaluate(brains, [](std::size_t, double) {}), std::runtime_error);
+                REQUIRE(num_stopped == 3);
+            }
+        }
+    }
+}
+
+
+SCENARIO("Repeated genomes are scored from the fitness cache", "[FitnessCache]")
+{
+    GIVEN("A GenAlg with a fitness cache and an evaluator counting its networks")
+    {
+        auto p = neat::Params::FromString(R"({"FitnessCacheSize": 1000})");
+        neat::GenAlg ga(2, 1, p);
+        neat::ThreadPoolEvaluator pool(count_links, 2);
+        std::size_t num_evaluated = 0;
+
+        class CountingEvaluator : public neat::IEvaluator
+        {
+        public:
+            neat::IEvaluator& Inner;
+            std::size_t& NumEvaluated;
+
+            CountingEvaluator(neat::IEvaluator& inner, std::size_t& num): Inner(inner), NumEvaluated(num) {}
+
+            void Evaluate(const std::vector<neat::SNeuralNetPtr>& brains, const neat::FitnessReport& report) override
+            {
+                NumEvaluated += brains.size();
+                Inner.Evaluate(brains, report);
+            }
+        } evaluator(pool, num_evaluated);
+
+        auto brains = ga.CreateNeuralNetworks();
+
+        WHEN("Several generations are evolved through the evaluator")
+        {
+            const int num_generations = 5;
+            for(int gen = 0; gen < num_generations; ++gen)
+            {
+                brains = ga.Epoch(brains, evaluator);
+            }
+
+            THEN("Species leaders carried over are not evaluated again")
+            {
+                auto& cache = ga.GetFitnessCache();
+                REQUIRE(cache.NumHits() > 0);
+                REQUIRE(cache.Size() <= 1000);
+                REQUIRE(num_evaluated + cache.NumHits() == num_generations * p.PopulationSize());
+                REQUIRE(ga.GetGenomes().size() == p.PopulationSize());
+            }
+
+            THEN("A cached score is the score the genome would get")
+            {
+                for(auto& g : ga.BestGenomes())
+                {
+                    REQUIRE(g.Fitness() == count_links(std::make_shared<neat::NeuralNet>(g)));
+                }
+            }
+        }
+    }
+}
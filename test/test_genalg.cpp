@@ -0,0 +1,433 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <algorithm>
+#include <random>
+#include <sstream>
+#include <stdexcept>
+#include <vector>
+
+#include "genalg.h"
+#include "params.h"
+
+
+SCENARIO("Fitness scores are submitted one genome at a time", "[SubmitFitness]")
+{
+    GIVEN("A fresh GenAlg with 2 inputs and 1 output")
+    {
+        neat::Params p;
+        neat::GenAlg ga(2, 1, p);
+        const auto& genomes = ga.GetGenomes();
+        std::size_t population_size = genomes.size();
+
+        std::vector<neat::GenomeID> ids;
+        for(auto& g : genomes)
+        {
+            ids.push_back(g.ID());
+        }
+
+        WHEN("Scores arrive in random order")
+        {
+            std::mt19937 shuffler(42);
+            std::shuffle(ids.begin(), ids.end(), shuffler);
+
+            for(std::size_t i = 0; i < ids.size() - 1; ++i)
+            {
+                ga.SubmitFitness(ids[i], 1.0 + i);
+            }
+
+            THEN("Partial statistics are available before the generation ends")
+            {
+                REQUIRE(ga.NumScored() == population_size - 1);
+                REQUIRE(ga.FitnessStats().NumValues() == population_size - 1);
+                REQUIRE(ga.GetSpecies().size() > 0);
+            }
+
+            THEN("Epoch refuses to run until the last score arrives")
+            {
+                REQUIRE_THROWS_AS(ga.Epoch(), std::logic_error);
+            }
+
+            THEN("Once the last score arrives Epoch creates the next generation")
+            {
+                ga.SubmitFitness(ids.back(), 1000.0);
+                auto brains = ga.Epoch();
+
+                REQUIRE(brains.size() == population_size);
+                REQUIRE(ga.Generation() == 1);
+                REQUIRE(ga.BestEverFitness() == 1000.0);
+                REQUIRE(ga.BestGenome().Fitness() == 1000.0);
+                REQUIRE(ga.NumScored() == 0);
+            }
+        }
+
+        WHEN("A genome is scored twice")
+        {
+            ga.SubmitFitness(ids[0], 1.0);
+
+            THEN("The second score is rejected")
+            {
+                REQUIRE_THROWS_AS(ga.SubmitFitness(ids[0], 2.0), std::invalid_argument);
+            }
+        }
+
+        WHEN("An unknown genome is scored")
+        {
+            THEN("The score is rejected")
+            {
+                REQUIRE_THROWS_AS(ga.SubmitFitness(neat::GenomeID(-5), 1.0), std::invalid_argument);
+            }
+        }
+
+        WHEN("Several generations are scored incrementally")
+        {
+            for(int gen = 0; gen < 5; ++gen)
+            {
+                for(auto& g : std::vector<neat::Genome>(ga.GetGenomes()))
+                {
+                    ga.SubmitFitness(g.ID(), g.NumLinks());
+                }
+                ga.Epoch();
+            }
+
+            THEN("Every generation keeps unique genome IDs")
+            {
+                std::vector<int> gen_ids;
+                for(auto& g : ga.GetGenomes())
+                {
+                    gen_ids.push_back(g.ID());
+                }
+                std::sort(gen_ids.begin(), gen_ids.end());
+                REQUIRE(std::adjacent_find(gen_ids.begin(), gen_ids.end()) == gen_ids.end());
+                REQUIRE(ga.Generation() == 5);
+            }
+        }
+    }
+}
+
+
+SCENARIO("Submitted genomes are speciated in the order they arrive", "[SubmitFitness]")
+{
+    GIVEN("Two copies of a population that splits into several species")
+    {
+        auto p = neat::Params::FromString(R"({"CompatibilityThreshold": 0.05})");
+        auto state = neat::GenAlg(2, 1, p).Snapshot();
+
+        // distinct fitness for every genome, the later ones are fitter
+        std::vector<double> scores;
+        for(std::size_t i = 0; i < state.Genomes.size(); ++i)
+        {
+            scores.push_back(1.0 + i);
+        }
+
+        WHEN("The weakest genome is scored first")
+        {
+            neat::GenAlg ga(state);
+            ga.SubmitFitness(ga.GetGenomes().front().ID(), scores.front());
+
+            THEN("It founds the first species")
+            {
+                REQUIRE(ga.GetSpecies().size() == 1);
+                REQUIRE(ga.GetSpecies()[0].Leader().ID() == ga.GetGenomes().front().ID());
+            }
+        }
+
+        WHEN("One copy is scored in a batch and the other fittest first")
+        {
+            neat::GenAlg batch(state);
+            batch.Epoch(scores);
+            auto batch_species = batch.GetSpecies();
+            auto batch_genomes = batch.GetGenomes();
+
+            neat::GenAlg incremental(state);
+            auto genomes = incremental.GetGenomes();
+            for(std::size_t i = genomes.size(); i-- > 0;)
+            {
+                incremental.SubmitFitness(genomes[i].ID(), scores[i]);
+            }
+            incremental.Epoch();
+
+            THEN("Both found the same species and breed the same generation")
+            {
+                REQUIRE(batch_species.size() > 1);
+                REQUIRE(incremental.GetSpecies().size() == batch_species.size());
+                for(std::size_t i = 0; i < batch_species.size(); ++i)
+                {
+                    REQUIRE(incremental.GetSpecies()[i].ID() == batch_species[i].ID());
+                    REQUIRE(incremental.GetSpecies()[i].Leader().ID() == batch_species[i].Leader().ID());
+                }
+                REQUIRE(incremental.GetGenomes().size() == batch_genomes.size());
+                for(std::size_t i = 0; i < batch_genomes.size(); ++i)
+                {
+                    REQUIRE(incremental.GetGenomes()[i].Fingerprint() == batch_genomes[i].Fingerprint());
+                }
+            }
+        }
+    }
+}
+
+
+SCENARIO("The phases of every epoch are timed", "[EpochProfile]")
+{
+    GIVEN("A GenAlg recording a trace")
+    {
+        neat::Params p;
+        neat::GenAlg ga(2, 1, p);
+        ga.EnableTracing(true);
+
+        auto brains = ga.CreateNeuralNetworks();
+        for(int gen = 0; gen < 3; ++gen)
+        {
+            brains = ga.Epoch(std::vector<double>(brains.size(), 1.0));
+        }
+
+        WHEN("The profile is inspected")
+        {
+            const auto& profile = ga.EpochTimes();
+
+            THEN("Every phase has a time for every generation")
+            {
+                for(std::size_t i = 0; i < neat::NUM_EPOCH_PHASES; ++i)
+                {
+                    auto phase = static_cast<neat::EpochPhase>(i);
+                    REQUIRE(profile.Phase(phase).NumValues() == 3);
+                    REQUIRE(profile.Phase(phase).MinValue() >= 0.0);
+                }
+                REQUIRE(profile.Phase(neat::EpochPhase::CREATE_NEW_POPULATION).Total() > 0.0);
+                REQUIRE(profile.LastEpochSeconds() > 0.0);
+            }
+
+            THEN("The trace holds one event per timed phase")
+            {
+                auto trace = profile.serialize();
+                // the first CreateNeuralNetworks and nine phases per epoch
+                REQUIRE(trace["traceEvents"].size() == 1 + 3 * 9);
+                REQUIRE(trace["traceEvents"][0]["name"] == "CreateNeuralNetworks");
+                REQUIRE(trace["traceEvents"][0]["ph"] == "X");
+
+                std::ostringstream streamed;
+                neat::serialize_to_stream(streamed, profile);
+                REQUIRE(streamed.str() == trace.dump(2));
+            }
+        }
+
+        WHEN("A generation is scored one genome at a time")
+        {
+            for(auto& g : std::vector<neat::Genome>(ga.GetGenomes()))
+            {
+                ga.SubmitFitness(g.ID(), 1.0);
+            }
+            ga.Epoch();
+
+            THEN("Speciating the genomes is traced as a single event")
+            {
+                auto events = ga.EpochTimes().serialize()["traceEvents"];
+                // no UpdateGenomeScores in the last generation, the scores were submitted
+                REQUIRE(events.size() == 1 + 3 * 9 + 8);
+                std::size_t num_speciate = 0;
+                for(auto& event : events)
+                {
+                    if(event["name"] == "SpeciateGenomes" && event["args"]["generation"] == 3)
+                    {
+                        ++num_speciate;
+                        REQUIRE(event["dur"].get<double>() > 0.0);
+                    }
+                }
+                REQUIRE(num_speciate == 1);
+                REQUIRE(ga.EpochTimes().Phase(neat::EpochPhase::SPECIATE_GENOMES).NumValues() == 4);
+            }
+        }
+    }
+}
+
+
+SCENARIO("Species hold their members as contiguous ranges", "[Species]")
+{
+    GIVEN("A GenAlg with a low compatibility threshold so genomes split up")
+    {
+        auto p = neat::Params::FromString(R"({"CompatibilityThreshold": 0.01})");
+        neat::GenAlg ga(2, 1, p);
+        auto brains = ga.CreateNeuralNetworks();
+
+        WHEN("A generation is scored with distinct fitness")
+        {
+            std::vector<double> scores;
+            for(std::size_t i = 0; i < brains.size(); ++i)
+            {
+                scores.push_back(1.0 + (i * 37) % brains.size());
+            }
+            brains = ga.Epoch(scores);
+
+            THEN("The ranges of the species cover the population without overlap")
+            {
+                auto& species = ga.GetSpecies();
+                REQUIRE(species.size() > 1);
+                std::size_t first = 0;
+                for(auto& s : species)
+                {
+                    REQUIRE(s.First() == first);
+                    first += s.Size();
+                }
+                REQUIRE(first == p.PopulationSize());
+            }
+
+            THEN("Every species keeps its fittest member as leader")
+            {
+                double best = 0.0;
+                for(auto& s : ga.GetSpecies())
+                {
+                    best = std::max(best, s.LeaderFitness());
+                    REQUIRE(s.Leader().GetSpeciesID() == s.ID());
+                }
+                REQUIRE(best == ga.BestGenome().Fitness());
+            }
+        }
+    }
+}
+
+
+SCENARIO("Parents are sampled from alias tables", "[Selection]")
+{
+    GIVEN("An alias table over uneven weights")
+    {
+        Utils::AliasTable table({1.0, 0.0, 3.0, 4.0});
+        auto& random = Utils::DefaultRandom::Instance();
+
+        WHEN("It is sampled many times")
+        {
+            std::vector<int> counts(4, 0);
+            const int num_samples = 80000;
+            for(int i = 0; i < num_samples; ++i)
+            {
+                ++counts[table.Sample(random)];
+            }
+
+            THEN("Every index comes up in proportion to its weight")
+            {
+                REQUIRE(counts[1] == 0);
+                REQUIRE(counts[0] / double(num_samples) == Approx(1.0 / 8).epsilon(0.05));
+                REQUIRE(counts[2] / double(num_samples) == Approx(3.0 / 8).epsilon(0.05));
+                REQUIRE(counts[3] / double(num_samples) == Approx(4.0 / 8).epsilon(0.05));
+            }
+        }
+    }
+
+    GIVEN("Linear ranking weights")
+    {
+        auto p = neat::Params::FromString(R"({"ParentSelection": "Rank", "SelectionPressure": 2.0})");
+        auto weights = neat::selection_weights(p, {5.0, 3.0, 1.0});
+
+        THEN("The fittest gets twice the average and the weakest nothing")
+        {
+            REQUIRE(weights[0] == Approx(2.0));
+            REQUIRE(weights[1] == Approx(1.0));
+            REQUIRE(weights[2] == Approx(0.0));
+        }
+    }
+
+    for(std::string selection : {"FitnessProportional", "Rank"})
+    {
+        GIVEN("A GenAlg with " + selection + " selection")
+        {
+            auto p = neat::Params::FromString(R"({"ParentSelection": ")" + selection + R"(", "ChanceAddNeuron": 0.2})");
+            neat::GenAlg ga(2, 1, p);
+            auto brains = ga.CreateNeuralNetworks();
+
+            WHEN("Several generations are evolved")
+            {
+                for(int gen = 0; gen < 10; ++gen)
+                {
+                    std::vector<double> scores;
+                    for(auto& brain : brains)
+                    {
+                        scores.push_back(brain->Update({1, 0})[0]);
+                    }
+                    brains = ga.Epoch(scores);
+                }
+
+                THEN("Every generation is filled")
+                {
+                    REQUIRE(brains.size() == p.PopulationSize());
+                    REQUIRE(ga.Generation() == 10);
+                }
+            }
+        }
+    }
+}
+
+
+SCENARIO("Random numbers are generated in bulk", "[Random]")
+{
+    GIVEN("The random engine of this thread")
+    {
+        auto& random = Utils::DefaultRandom::Instance();
+        random.Seed(7);
+        const std::size_t count = 40001;
+        std::vector<double> values(count);
+
+        WHEN("A buffer is filled with uniform numbers")
+        {
+            random.FillUniform(values.data(), count, -1.0, 1.0);
+
+            THEN("They cover the range evenly")
+            {
+                Utils::RunningStat stat;
+                for(double value : values)
+                {
+                    stat.Push(value);
+                }
+                REQUIRE(stat.MinValue() >= -1.0);
+                REQUIRE(stat.MaxValue() < 1.0);
+                REQUIRE(std::fabs(stat.Mean()) < 0.02);
+                REQUIRE(stat.Variance() == Approx(1.0 / 3).epsilon(0.02));
+            }
+        }
+
+        WHEN("A buffer is filled with normal numbers")
+        {
+            random.FillNormal(values.data(), count, 2.0, 0.5);
+
+            THEN("They have the requested mean and deviation")
+            {
+                Utils::RunningStat stat;
+                for(double value : values)
+                {
+                    stat.Push(value);
+                }
+                REQUIRE(stat.Mean() == Approx(2.0).epsilon(0.01));
+                REQUIRE(stat.StandardDeviation() == Approx(0.5).epsilon(0.02));
+            }
+        }
+
+        WHEN("The state is saved and restored")
+        {
+            auto state = random.GetState();
+            std::vector<double> expected(10);
+            random.FillUniform(expected.data(), expected.size());
+            double expected_scalar = random.RandomDouble();
+
+            random.SetState(state);
+            std::vector<double> repeated(10);
+            random.FillUniform(repeated.data(), repeated.size());
+
+            THEN("Both engines continue where they were")
+            {
+                REQUIRE(repeated == expected);
+                REQUIRE(random.RandomDouble() == expected_scalar);
+            }
+        }
+
+        WHEN("A state saved without the bulk engine is restored")
+        {
+            std::ostringstream scalar_only;
+            scalar_only << std::mt19937_64(3);
+            random.SetState(scalar_only.str());
+
+            THEN("The scalar engine continues from it")
+            {
+                std::mt19937_64 engine(3);
+                REQUIRE(random.RandomDouble() == std::uniform_real_distribution<double>(0.0, 1.0)(engine));
+            }
+        }
+    }
+}
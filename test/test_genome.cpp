@@ -1,6 +1,8 @@
 #define CATCH_CONFIG_MAIN
 #include "catch.hpp"
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <vector>
 #include <set>
@@ -101,6 +103,38 @@ SCENARIO("Genome gets initialized with correct number of neurons", "[GenomeInit]
             }
         }
 
+        WHEN("Genome's weights get gaussian perturbations beyond the weight limit")
+        {
+            std::vector<double> orig_weights = from(g.NeuronLinks())
+                >> select([](const neat::LinkGene& g) { return g.Weight; } ) >> to_vector();
+
+            g.MutateWeights(neat::MutationSpec{1.0, 0.0, 10.0, neat::PerturbationType::GAUSSIAN, 0.5});
+            THEN("The weights change but stay within the limit")
+            {
+                std::vector<double> new_weights = from(g.NeuronLinks())
+                    >> select([](const neat::LinkGene& g) { return g.Weight; } ) >> to_vector();
+
+                for(std::size_t i = 0; i < new_weights.size(); ++i)
+                {
+                    REQUIRE(new_weights[i] != orig_weights[i]);
+                    REQUIRE(std::fabs(new_weights[i]) <= 0.5);
+                }
+            }
+        }
+
+        WHEN("Activation responses get mutated with replacement asked for")
+        {
+            g.MutateActivationResponse(neat::MutationSpec{1.0, 1.0, 0.1, neat::PerturbationType::UNIFORM, 0.0});
+            THEN("They are only perturbed around their value")
+            {
+                for(auto& neuron : g.NeuronGenes())
+                {
+                    REQUIRE(neuron.ActivationResponse != 1.0);
+                    REQUIRE(std::fabs(neuron.ActivationResponse - 1.0) <= 0.1);
+                }
+            }
+        }
+
         WHEN("Genome's weights get mutated with 100\% probability and 100\% replacement")
         {
             std::vector<double> orig_weights = from(g.NeuronLinks())
@@ -398,3 +432,76 @@ SCENARIO("Compatibility is calculated between genomes", "[CalculateDifferenceSco
         }
     }
 }
+
+
+SCENARIO("Genomes are fingerprinted", "[Fingerprint]")
+{
+    GIVEN("A genome and a copy of its genes with another ID and fitness")
+    {
+        neat::Params p;
+        neat::Genome g1(1, 2, 1, &p);
+        neat::Genome g2(2, g1.NeuronGenes(), g1.NeuronLinks(), 2, 1, &p);
+        g2.SetFitness(10.0);
+
+        THEN("Both have the same fingerprint")
+        {
+            REQUIRE(g1.Fingerprint() == g2.Fingerprint());
+        }
+
+        WHEN("The links of the copy are in another order")
+        {
+            auto links = g1.NeuronLinks();
+            std::reverse(links.begin(), links.end());
+            neat::Genome g3(3, g1.NeuronGenes(), links, 2, 1, &p);
+
+            THEN("The fingerprint doesn't change")
+            {
+                REQUIRE(g1.Fingerprint() == g3.Fingerprint());
+            }
+        }
+
+        WHEN("A weight of the copy changes")
+        {
+            g2.MutateWeights(1.0, 0.0, 0.5);
+
+            THEN("The fingerprints differ")
+            {
+                REQUIRE(g1.Fingerprint() != g2.Fingerprint());
+            }
+        }
+
+        WHEN("An activation response of the copy changes")
+        {
+            g2.MutateActivationResponse(1.0, 0.5);
+
+            THEN("The fingerprints differ")
+            {
+                REQUIRE(g1.Fingerprint() != g2.Fingerprint());
+            }
+        }
+    }
+}
+
+
+SCENARIO("Genomes are moved without copying their genes", "[Genome]")
+{
+    GIVEN("A genome")
+    {
+        neat::Params p;
+        neat::Genome g(1, 3, 2, &p);
+        const neat::LinkGene* links = g.NeuronLinks().data();
+        auto num_links = g.NumLinks();
+
+        WHEN("It is move constructed")
+        {
+            neat::Genome moved(std::move(g));
+
+            THEN("The new genome owns the same genes")
+            {
+                REQUIRE(moved.NeuronLinks().data() == links);
+                REQUIRE(moved.NumLinks() == num_links);
+                REQUIRE(moved.ID() == 1);
+            }
+        }
+    }
+}
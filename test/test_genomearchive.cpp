@@ -0,0 +1,94 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <fstream>
+#include <vector>
+
+#include "fitness_helpers.h"
+#include "genalg.h"
+#include "genomearchive.h"
+
+
+SCENARIO("Genomes are saved and used to seed a new run", "[GenomeArchive]")
+{
+    GIVEN("A population evolved for a few generations")
+    {
+        auto p = neat::Params::FromString(R"({"ChanceAddNeuron": 0.3, "ChanceAddLink": 0.6})");
+        neat::GenAlg ga(2, 1, p);
+        auto brains = ga.CreateNeuralNetworks();
+        for(int gen = 0; gen < 8; ++gen)
+        {
+            brains = ga.Epoch(xor_scores(brains));
+        }
+        const auto& genomes = ga.BestGenomes();
+        auto innovations = ga.Snapshot().Innovations;
+
+        WHEN("A genome is serialized to json")
+        {
+            auto object = genomes[0].serialize();
+            neat::Genome loaded(object, &p);
+
+            THEN("It is loaded with all its genes and bookkeeping")
+            {
+                REQUIRE(loaded.serialize() == object);
+                REQUIRE(loaded.NumLinks() == genomes[0].NumLinks());
+                REQUIRE(loaded.Fitness() == genomes[0].Fitness());
+            }
+        }
+
+        WHEN("The genomes are archived")
+        {
+            neat::write_genome_archive("genomes.ngen", genomes, innovations);
+            neat::GenomeArchive archive("genomes.ngen");
+
+            THEN("Every genome can be loaded on its own")
+            {
+                REQUIRE(archive.Size() == genomes.size());
+                for(std::size_t i = genomes.size(); i-- > 0;)
+                {
+                    REQUIRE(archive.ID(i) == genomes[i].ID());
+                    REQUIRE(archive.GetSpeciesID(i) == genomes[i].GetSpeciesID());
+                    REQUIRE(archive.Fitness(i) == genomes[i].Fitness());
+                    REQUIRE(archive.Load(i, &p).serialize() == genomes[i].serialize());
+                }
+                REQUIRE_THROWS_AS(archive.Load(genomes.size(), &p), std::out_of_range);
+            }
+
+            THEN("The innovation database is restored")
+            {
+                auto restored = archive.Innovations();
+                REQUIRE(restored.NextNeuronID() == innovations.NextNeuronID());
+                REQUIRE(restored.NextInnovationID() == innovations.NextInnovationID());
+                REQUIRE(restored.Innovations().size() == innovations.Innovations().size());
+            }
+
+            THEN("A new run starts from the archived genomes")
+            {
+                auto seeded_params = neat::Params::FromString(R"({"PopulationSize": 50})");
+                neat::GenAlg seeded(archive.LoadAll(&seeded_params), seeded_params, archive.Innovations());
+                auto seeded_brains = seeded.CreateNeuralNetworks();
+
+                REQUIRE(seeded_brains.size() == 50);
+                for(std::size_t i = 0; i < seeded_brains.size(); ++i)
+                {
+                    neat::NeuralNet expected(genomes[i % genomes.size()]);
+                    REQUIRE(seeded_brains[i]->Update({1, 0}) == expected.Update({1, 0}));
+                }
+
+                seeded_brains = seeded.Epoch(xor_scores(seeded_brains));
+                REQUIRE(seeded.Generation() == 1);
+                REQUIRE(seeded.BestEverFitness() >= ga.BestGenome().Fitness() - 1e-9);
+            }
+        }
+
+        WHEN("A file isn't a genome archive")
+        {
+            std::ofstream("not_an_archive.ngen") << std::string(64, 'x');
+
+            THEN("It can't be opened")
+            {
+                REQUIRE_THROWS_AS(neat::GenomeArchive("not_an_archive.ngen"), std::runtime_error);
+            }
+        }
+    }
+}
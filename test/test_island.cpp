@@ -0,0 +1,74 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <algorithm>
+#include <vector>
+
+#include "fitness_helpers.h"
+#include "island.h"
+#include "params.h"
+
+
+SCENARIO("Islands evolve in parallel and exchange their best genomes", "[IslandGenAlg]")
+{
+    GIVEN("Three islands of 30 genomes migrating every 2 generations")
+    {
+        auto p = neat::Params::FromString(R"({"PopulationSize": 30, "NumBestGenomes": 3})");
+
+        WHEN("They evolve on a ring for 6 generations")
+        {
+            neat::IslandGenAlg islands(2, 1, p, 3, 2, 2, neat::MigrationTopology::RING);
+            islands.Evolve(6, count_links);
+
+            THEN("Every island advanced and migration happened after every second generation")
+            {
+                REQUIRE(islands.Generation() == 6);
+                REQUIRE(islands.NumMigrations() == 3);
+                for(std::size_t i = 0; i < islands.NumIslands(); ++i)
+                {
+                    REQUIRE(islands.Island(i).Generation() == 6);
+                    REQUIRE(islands.IslandNeuralNetworks(i).size() == islands.Island(i).GetGenomes().size());
+                }
+                REQUIRE(islands.BestGenome().Fitness() <= islands.BestEverFitness());
+            }
+
+            THEN("Genome IDs stay unique within each island")
+            {
+                for(std::size_t i = 0; i < islands.NumIslands(); ++i)
+                {
+                    std::vector<int> ids;
+                    for(auto& g : islands.Island(i).GetGenomes())
+                    {
+                        ids.push_back(g.ID());
+                    }
+                    std::sort(ids.begin(), ids.end());
+                    REQUIRE(std::adjacent_find(ids.begin(), ids.end()) == ids.end());
+                }
+            }
+        }
+
+        WHEN("They evolve fully connected")
+        {
+            neat::IslandGenAlg islands(2, 1, p, 3, 1, 2, neat::MigrationTopology::FULLY_CONNECTED);
+            islands.Evolve(3, count_links);
+
+            THEN("Migration happens every generation")
+            {
+                REQUIRE(islands.NumMigrations() == 3);
+            }
+        }
+
+        WHEN("The fitness function fails on one of the islands")
+        {
+            neat::IslandGenAlg islands(2, 1, p, 3, 2, 2);
+
+            THEN("The error is reported to the caller")
+            {
+                REQUIRE_THROWS_AS(islands.Evolve(3, [](neat::SNeuralNetPtr) -> double
+                    {
+                        throw std::runtime_error("simulation crashed");
+                    }), std::runtime_error);
+            }
+        }
+    }
+}
@@ -0,0 +1,80 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <fstream>
+#include <vector>
+
+#include "fitness_helpers.h"
+#include "genalg.h"
+#include "netarchive.h"
+
+
+SCENARIO("A population is evaluated straight from a memory-mapped archive", "[NetArchive]")
+{
+    GIVEN("A population with hidden neurons and recurrent links")
+    {
+        auto p = neat::Params::FromString(R"({"ChanceAddNeuron": 0.3, "ChanceAddLink": 0.6, "ChanceAddRecurrentLink": 0.3})");
+        neat::GenAlg ga(2, 1, p);
+        auto brains = ga.CreateNeuralNetworks();
+        for(int gen = 0; gen < 10; ++gen)
+        {
+            brains = ga.Epoch(xor_scores(brains));
+        }
+
+        WHEN("Its genomes are archived")
+        {
+            const auto& genomes = ga.GetGenomes();
+            neat::write_net_archive("population.narc", genomes);
+            neat::NetArchive archive("population.narc");
+
+            THEN("Every archived network behaves exactly like its phenotype")
+            {
+                REQUIRE(archive.Size() == genomes.size());
+                for(std::size_t i = 0; i < genomes.size(); ++i)
+                {
+                    REQUIRE(archive.ID(i) == genomes[i].ID());
+                    REQUIRE(archive.Fitness(i) == genomes[i].Fitness());
+
+                    neat::NeuralNet nn(genomes[i]);
+                    auto view = archive.Net(i);
+                    REQUIRE(view.NumInputs() == 2);
+                    REQUIRE(view.NumOutputs() == 1);
+                    for(int tick = 0; tick < 3; ++tick)
+                    {
+                        REQUIRE(view.Update({0.3, 0.7}) == nn.Update({0.3, 0.7}));
+                    }
+                    REQUIRE(view.Update({1, 0}, neat::UPDATE_TYPE::SNAPSHOT) ==
+                            nn.Update({1, 0}, neat::UPDATE_TYPE::SNAPSHOT));
+                    REQUIRE(view.Update({0, 1}) == nn.Update({0, 1}));
+                    REQUIRE(view.Update({0.5, 0.5}, neat::UPDATE_TYPE::SETTLE) ==
+                            nn.Update({0.5, 0.5}, neat::UPDATE_TYPE::SETTLE));
+                    REQUIRE(view.NumTicks() == nn.NumTicks());
+                }
+            }
+        }
+
+        WHEN("Networks are archived without their genomes")
+        {
+            neat::write_net_archive("champions.narc", brains);
+            neat::NetArchive archive("champions.narc");
+
+            THEN("They are numbered by position")
+            {
+                REQUIRE(archive.Size() == brains.size());
+                REQUIRE(archive.ID(3) == 3);
+                REQUIRE(archive.Net(3).Update({1, 1}) == brains[3]->Update({1, 1}));
+                REQUIRE_THROWS_AS(archive.Net(brains.size()), std::out_of_range);
+            }
+        }
+
+        WHEN("A file isn't an archive")
+        {
+            std::ofstream("not_an_archive.narc") << "This is definitely not a network archive.";
+
+            THEN("It can't be opened")
+            {
+                REQUIRE_THROWS_AS(neat::NetArchive("not_an_archive.narc"), std::runtime_error);
+            }
+        }
+    }
+}
@@ -121,3 +121,56 @@ SCENARIO("Copying params instance with copy constructor", "[params]")
         }
     }
 }
+
+
+SCENARIO("Parent selection is configured by name", "[params]")
+{
+    GIVEN("A string selecting rank based parents")
+    {
+        std::string config = R"({"ParentSelection": "Rank", "SelectionPressure": 1.8})";
+
+        WHEN("String is parsed")
+        {
+            neat::Params p = neat::Params::FromString(config);
+
+            THEN("The selection survives copying and serialization")
+            {
+                REQUIRE(p.Selection() == neat::SelectionType::RANK);
+                REQUIRE(p.SelectionPressure() == 1.8);
+                REQUIRE(neat::Params(p).Selection() == neat::SelectionType::RANK);
+
+                auto object = p.serialize();
+                REQUIRE(object["ParentSelection"] == "Rank");
+                REQUIRE(neat::Params(object).Selection() == neat::SelectionType::RANK);
+            }
+        }
+    }
+
+    GIVEN("A string asking for gaussian perturbations of bounded weights")
+    {
+        std::string config = R"({"PerturbationDistribution": "Gaussian", "WeightLimit": 8})";
+
+        WHEN("String is parsed")
+        {
+            neat::Params p = neat::Params::FromString(config);
+
+            THEN("Both settings are read and serialized")
+            {
+                REQUIRE(p.Perturbation() == neat::PerturbationType::GAUSSIAN);
+                REQUIRE(p.WeightLimit() == 8);
+                REQUIRE(p.serialize()["PerturbationDistribution"] == "Gaussian");
+                REQUIRE(neat::Params(p).WeightLimit() == 8);
+            }
+        }
+    }
+
+    GIVEN("An unknown selection or a pressure out of range")
+    {
+        THEN("Parsing fails")
+        {
+            REQUIRE_THROWS_AS(neat::Params::FromString(R"({"ParentSelection": "Roulette"})"), std::invalid_argument);
+            REQUIRE_THROWS_AS(neat::Params::FromString(R"({"SelectionPressure": 2.5})"), std::invalid_argument);
+            REQUIRE_THROWS_AS(neat::Params::FromString(R"({"PerturbationDistribution": "Cauchy"})"), std::invalid_argument);
+        }
+    }
+}
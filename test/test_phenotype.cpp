@@ -0,0 +1,345 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "genes.h"
+#include "genome.h"
+#include "params.h"
+#include "phenotype.h"
+
+
+SCENARIO("The depth of a network is measured", "[GetDepth]")
+{
+    GIVEN("A genome without hidden neurons")
+    {
+        neat::Params p;
+        neat::Genome g(1, 2, 1, &p);
+        neat::NeuralNet nn(g);
+
+        THEN("Its depth is an input and an output")
+        {
+            REQUIRE(nn.GetDepth() == 2);
+
+            for(std::size_t i = 0; i < nn.GetNeurons().size(); ++i)
+            {
+                bool is_output = nn.GetNeurons()[i].Type == neat::NeuronType::OUTPUT;
+                REQUIRE(nn.GetLevels()[i] == (is_output ? 1 : 0));
+            }
+        }
+    }
+
+    GIVEN("A network of 40 layers of 2 hidden neurons, each linked to both neurons of the next layer")
+    {
+        const int num_layers = 40;
+        std::vector<neat::NeuronGene> neurons = {
+            neat::NeuronGene(neat::NeuronType::INPUT, 0, 0, 0),
+            neat::NeuronGene(neat::NeuronType::BIAS, 1, 0, 0),
+            neat::NeuronGene(neat::NeuronType::OUTPUT, 2, 1, 0)
+        };
+        std::vector<neat::LinkGene> links;
+        int innovation = 0;
+        auto link = [&links, &innovation](int from, int to, bool recurrent)
+        {
+            links.push_back(neat::LinkGene(from, to, 1.0, true, innovation++, recurrent));
+        };
+
+        for(int layer = 0; layer < num_layers; ++layer)
+        {
+            for(int i = 0; i < 2; ++i)
+            {
+                int id = 3 + 2 * layer + i;
+                neurons.push_back(neat::NeuronGene(neat::NeuronType::HIDDEN, id, 0.5, 0));
+                if(layer == 0)
+                {
+                    link(0, id, false);
+                }
+                else
+                {
+                    link(id - 2 - i, id, false);
+                    link(id - 1 - i, id, false);
+                }
+            }
+        }
+        int last = 3 + 2 * num_layers - 2;
+        link(last, 2, false);
+        link(last + 1, 2, false);
+        // neither of these lengthen any path
+        link(2, 3, true);
+        link(1, 2, false);
+
+        neat::NeuralNet nn(neurons, links);
+
+        THEN("Every one of the 2^40 paths is accounted for without following them")
+        {
+            REQUIRE(nn.GetDepth() == num_layers + 2);
+            REQUIRE(nn.GetDepth() == num_layers + 2);
+        }
+
+        THEN("Neurons are levelled by their longest path from the input")
+        {
+            const auto& levels = nn.GetLevels();
+            REQUIRE(levels.size() == nn.GetNeurons().size());
+            REQUIRE(levels[0] == 0);
+            REQUIRE(levels[1] == 0);
+            REQUIRE(levels[2] == num_layers + 1);
+            for(std::size_t i = 3; i < levels.size(); ++i)
+            {
+                REQUIRE(levels[i] == (i - 3) / 2 + 1);
+            }
+        }
+
+        THEN("A network built from a copy of its neurons links the copies")
+        {
+            auto copied = nn.GetNeurons();
+            neat::NeuralNet copy(copied);
+            copied.clear();
+
+            REQUIRE(copy.GetDepth() == nn.GetDepth());
+            REQUIRE(copy.GetLevels() == nn.GetLevels());
+            REQUIRE(copy.Update({0.5}) == nn.Update({0.5}));
+        }
+
+        THEN("A network can't be built from neurons linked to others")
+        {
+            auto neurons_only = std::vector<neat::Neuron>(nn.GetNeurons().begin(), nn.GetNeurons().begin() + 3);
+            REQUIRE_THROWS_AS(neat::NeuralNet{neurons_only}, std::invalid_argument);
+        }
+    }
+}
+
+
+SCENARIO("A recurrent network settles on its inputs", "[Update]")
+{
+    GIVEN("A hidden neuron feeding itself and the output")
+    {
+        std::vector<neat::NeuronGene> neurons = {
+            neat::NeuronGene(neat::NeuronType::INPUT, 0, 0, 0),
+            neat::NeuronGene(neat::NeuronType::BIAS, 1, 0, 0),
+            neat::NeuronGene(neat::NeuronType::OUTPUT, 2, 1, 0),
+            neat::NeuronGene(neat::NeuronType::HIDDEN, 3, 0.5, 0)
+        };
+        std::vector<neat::LinkGene> links = {
+            neat::LinkGene(0, 3, 1.0, true, 0),
+            neat::LinkGene(3, 3, 0.5, true, 1, true),
+            neat::LinkGene(3, 2, 1.0, true, 2)
+        };
+        neat::NeuralNet nn(neurons, links);
+
+        WHEN("It is updated once")
+        {
+            nn.Update({1.0});
+
+            THEN("It takes a single tick")
+            {
+                REQUIRE(nn.NumTicks() == 1);
+                REQUIRE_FALSE(nn.IsSettled());
+            }
+        }
+
+        WHEN("It is left to settle")
+        {
+            auto outputs = nn.Update({1.0}, neat::UPDATE_TYPE::SETTLE);
+            std::size_t ticks = nn.NumTicks();
+
+            THEN("It stops once the signals stop changing")
+            {
+                REQUIRE(nn.IsSettled());
+                REQUIRE(ticks > 1);
+                REQUIRE(ticks < neat::DEFAULT_MAX_TICKS);
+
+                auto again = nn.Update({1.0}, neat::UPDATE_TYPE::SETTLE);
+                REQUIRE(nn.NumTicks() == 1);
+                REQUIRE(std::fabs(again[0] - outputs[0]) < neat::DEFAULT_SETTLE_TOLERANCE);
+            }
+        }
+
+        WHEN("It can't settle within the tick cap")
+        {
+            nn.SetSettling(0.0, 3);
+            nn.Update({1.0}, neat::UPDATE_TYPE::SETTLE);
+
+            THEN("It stops at the cap")
+            {
+                REQUIRE(nn.NumTicks() == 3);
+                REQUIRE_FALSE(nn.IsSettled());
+            }
+        }
+    }
+}
+
+
+// Update over every neuron gene, with the signal of neuron i at position i
+std::vector<double> reference_update(const std::vector<neat::NeuronGene>& neurons,
+                                     const std::vector<neat::LinkGene>& links,
+                                     std::vector<double>& signals,
+                                     const std::vector<double>& inputs)
+{
+    std::vector<double> outputs;
+    for(std::size_t i = 0; i < neurons.size(); ++i)
+    {
+        if(neurons[i].Type == neat::NeuronType::INPUT)
+        {
+            signals[i] = inputs[i];
+            continue;
+        }
+        if(neurons[i].Type == neat::NeuronType::BIAS)
+        {
+            signals[i] = 1.0;
+            continue;
+        }
+
+        double sum = 0.0;
+        for(auto& link : links)
+        {
+            if(link.IsEnabled && static_cast<int>(link.ToNeuronID) == static_cast<int>(neurons[i].ID))
+            {
+                sum += link.Weight * signals[static_cast<int>(link.FromNeuronID)];
+            }
+        }
+        signals[i] = neat::sigmoid(sum, neurons[i].ActivationResponse);
+        if(neurons[i].Type == neat::NeuronType::OUTPUT)
+        {
+            outputs.push_back(signals[i]);
+        }
+    }
+    return outputs;
+}
+
+
+// SETTLE over every neuron gene, returns the outputs and the number of ticks
+std::pair<std::vector<double>, std::size_t> reference_settle(const std::vector<neat::NeuronGene>& neurons,
+                                                             const std::vector<neat::LinkGene>& links,
+                                                             std::vector<double>& signals,
+                                                             const std::vector<double>& inputs,
+                                                             double tolerance,
+                                                             std::size_t max_ticks)
+{
+    std::vector<double> outputs;
+    std::size_t num_ticks = 0;
+    double max_change = 0.0;
+    do
+    {
+        auto last = signals;
+        outputs = reference_update(neurons, links, signals, inputs);
+        max_change = 0.0;
+        for(std::size_t i = 0; i < neurons.size(); ++i)
+        {
+            if(neurons[i].Type != neat::NeuronType::INPUT && neurons[i].Type != neat::NeuronType::BIAS)
+            {
+                max_change = std::max(max_change, std::fabs(signals[i] - last[i]));
+            }
+        }
+        ++num_ticks;
+    }
+    while(num_ticks < max_ticks && max_change >= tolerance);
+    return {outputs, num_ticks};
+}
+
+
+SCENARIO("Neurons that can't change the outputs are left out of the network", "[NeuralNet]")
+{
+    GIVEN("A genome with a dead end, a neuron fed only by the bias and one whose signal arrives a tick late")
+    {
+        std::vector<neat::NeuronGene> neurons = {
+            neat::NeuronGene(neat::NeuronType::INPUT, 0, 0, 0),
+            neat::NeuronGene(neat::NeuronType::BIAS, 1, 0, 0),
+            neat::NeuronGene(neat::NeuronType::OUTPUT, 2, 1, 0),
+            neat::NeuronGene(neat::NeuronType::HIDDEN, 3, 0.5, 0),
+            neat::NeuronGene(neat::NeuronType::HIDDEN, 4, 0.5, 0),
+            neat::NeuronGene(neat::NeuronType::HIDDEN, 5, 0.5, 0),
+            neat::NeuronGene(neat::NeuronType::HIDDEN, 6, 0.5, 0),
+            neat::NeuronGene(neat::NeuronType::HIDDEN, 7, 0.5, 0)
+        };
+        std::vector<neat::LinkGene> links = {
+            neat::LinkGene(0, 3, 0.9, true, 0),
+            neat::LinkGene(3, 6, 0.8, true, 1),
+            neat::LinkGene(1, 4, 0.7, true, 2),
+            neat::LinkGene(0, 5, 0.5, true, 3),
+            neat::LinkGene(4, 5, 0.3, true, 4),
+            neat::LinkGene(5, 5, 0.2, true, 5, true),
+            neat::LinkGene(5, 2, 1.0, true, 6),
+            neat::LinkGene(1, 7, -0.4, true, 7),
+            neat::LinkGene(7, 2, 0.6, true, 8),
+            neat::LinkGene(0, 2, -1.0, true, 9),
+            neat::LinkGene(0, 6, 2.0, false, 10)
+        };
+        neat::NeuralNet nn(neurons, links);
+
+        THEN("The dead end and the folded neuron are gone")
+        {
+            std::vector<int> ids;
+            for(auto& neuron : nn.GetNeurons())
+            {
+                ids.push_back(static_cast<int>(neuron.ID));
+            }
+            REQUIRE(ids == std::vector<int>({0, 1, 2, 5, 7}));
+
+            const auto& folded = nn.GetNeurons()[3].InLinks;
+            REQUIRE(folded.size() == 3);
+            REQUIRE(folded[1].In->Type == neat::NeuronType::BIAS);
+            REQUIRE(folded[1].Weight == 0.3 * neat::sigmoid(0.7, neurons[4].ActivationResponse));
+        }
+
+        THEN("The outputs are exactly those of the whole genome")
+        {
+            std::vector<double> signals(neurons.size(), 0.0);
+            std::vector<std::vector<double>> inputs = {{0.0}, {1.0}, {0.3}, {-2.0}, {0.3}};
+            for(auto& in : inputs)
+            {
+                REQUIRE(nn.Update(in) == reference_update(neurons, links, signals, in));
+            }
+            neat::NeuralNet fresh(neurons, links);
+            for(auto& in : inputs)
+            {
+                std::fill(signals.begin(), signals.end(), 0.0);
+                REQUIRE(fresh.Update(in, neat::UPDATE_TYPE::SNAPSHOT) == reference_update(neurons, links, signals, in));
+            }
+        }
+
+        THEN("Settling takes as many ticks as it takes the whole genome")
+        {
+            std::vector<double> signals(neurons.size(), 0.0);
+            std::vector<std::vector<double>> inputs = {{0.0}, {1.0}, {0.3}, {-2.0}, {0.3}};
+            for(auto& in : inputs)
+            {
+                auto expected = reference_settle(neurons, links, signals, in, nn.SettleTolerance(), nn.MaxTicks());
+                REQUIRE(nn.Update(in, neat::UPDATE_TYPE::SETTLE) == expected.first);
+                REQUIRE(nn.NumTicks() == expected.second);
+                REQUIRE(nn.IsSettled());
+            }
+        }
+    }
+
+    GIVEN("A genome with a dead end that never settles")
+    {
+        std::vector<neat::NeuronGene> neurons = {
+            neat::NeuronGene(neat::NeuronType::INPUT, 0, 0, 0),
+            neat::NeuronGene(neat::NeuronType::BIAS, 1, 0, 0),
+            neat::NeuronGene(neat::NeuronType::OUTPUT, 2, 1, 0),
+            neat::NeuronGene(neat::NeuronType::HIDDEN, 3, 0.5, 0)
+        };
+        std::vector<neat::LinkGene> links = {
+            neat::LinkGene(0, 2, 1.0, true, 0),
+            neat::LinkGene(0, 3, 0.5, true, 1),
+            neat::LinkGene(3, 3, -20.0, true, 2, true)
+        };
+        neat::NeuralNet nn(neurons, links);
+
+        THEN("SETTLE stops as soon as the outputs settle")
+        {
+            std::vector<double> signals(neurons.size(), 0.0);
+            auto expected = reference_settle(neurons, links, signals, {1.0}, nn.SettleTolerance(), nn.MaxTicks());
+            REQUIRE(expected.second == nn.MaxTicks());
+
+            REQUIRE(nn.Update({1.0}, neat::UPDATE_TYPE::SETTLE) == expected.first);
+            REQUIRE(nn.NumTicks() == 2);
+            REQUIRE(nn.IsSettled());
+        }
+
+    }
+}
@@ -0,0 +1,228 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <signal.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <memory>
+#include <stdexcept>
+#include <vector>
+
+#include "binformat.h"
+#include "fitness_helpers.h"
+#include "genalg.h"
+#include "procpool.h"
+
+
+SCENARIO("A network survives the trip to a worker", "[binformat]")
+{
+    GIVEN("A network with hidden neurons and recurrent links")
+    {
+        neat::Params p;
+        neat::Genome g(1, 3, 2, &p);
+        neat::InnovationDB inno_db(g.NeuronGenes(), g.NeuronLinks());
+        for(int i = 0; i < 5; ++i)
+        {
+            g.AddNeuron(1.0, inno_db, 100);
+            g.AddLink(1.0, 0.5, inno_db, 100, 100);
+        }
+        neat::NeuralNet nn(g);
+
+        WHEN("It is encoded and decoded")
+        {
+            std::vector<std::uint8_t> buffer;
+            neat::BinaryWriter writer(buffer);
+            neat::encode_net(writer, nn);
+
+            neat::BinaryReader reader(buffer);
+            auto decoded = neat::decode_net(reader);
+
+            THEN("Both networks produce identical outputs")
+            {
+                for(int tick = 0; tick < 3; ++tick)
+                {
+                    REQUIRE(nn.Update({0.1, 0.5, 0.9}) == decoded.Update({0.1, 0.5, 0.9}));
+                }
+                REQUIRE(reader.Remaining() == 0);
+            }
+        }
+    }
+}
+
+
+SCENARIO("A population is evaluated by worker processes", "[ProcessPoolEvaluator]")
+{
+    GIVEN("A GenAlg and its networks")
+    {
+        neat::Params p;
+        neat::GenAlg ga(2, 1, p);
+        auto brains = ga.CreateNeuralNetworks();
+
+        std::vector<double> expected;
+        for(auto& brain : brains)
+        {
+            expected.push_back(xor_fitness(brain));
+        }
+
+        WHEN("Three workers evaluate the networks")
+        {
+            neat::ProcessPoolEvaluator evaluator(xor_fitness, 3);
+            std::vector<double> scores(brains.size(), -1);
+            evaluator.Evaluate(brains, [&](std::size_t idx, double fitness) { scores[idx] = fitness; });
+
+            THEN("The scores match evaluation in this process")
+            {
+                REQUIRE(scores == expected);
+                REQUIRE(evaluator.NumCrashes() == 0);
+            }
+
+            THEN("The evaluator drives GenAlg epochs")
+            {
+                for(int gen = 0; gen < 3; ++gen)
+                {
+                    brains = ga.Epoch(brains, evaluator);
+                }
+                REQUIRE(ga.Generation() == 3);
+            }
+        }
+
+        WHEN("Reporting a score throws while networks are still queued")
+        {
+            neat::ProcessPoolEvaluator evaluator(xor_fitness, 3);
+            std::size_t num_reports = 0;
+            REQUIRE_THROWS_AS(evaluator.Evaluate(brains, [&](std::size_t, double)
+                {
+                    if(++num_reports == 5)
+                    {
+                        throw std::invalid_argument("rejected score");
+                    }
+                }), std::invalid_argument);
+
+            THEN("A retry with other networks only gets their results")
+            {
+                std::vector<neat::SNeuralNetPtr> rest(brains.rbegin(), brains.rend() - 10);
+                std::vector<double> scores(rest.size(), -1);
+                std::size_t num_scored = 0;
+                evaluator.Evaluate(rest, [&](std::size_t idx, double fitness)
+                    {
+                        REQUIRE(idx < rest.size());
+                        REQUIRE(scores[idx] == -1);
+                        scores[idx] = fitness;
+                        ++num_scored;
+                    });
+
+                REQUIRE(num_scored == rest.size());
+                for(std::size_t i = 0; i < rest.size(); ++i)
+                {
+                    REQUIRE(scores[i] == expected[brains.size() - 1 - i]);
+                }
+            }
+        }
+
+        WHEN("Evaluating the best network crashes its worker")
+        {
+            double best = *std::max_element(expected.begin(), expected.end());
+            auto crashing_fitness = [best](neat::SNeuralNetPtr brain)
+            {
+                double fitness = xor_fitness(brain);
+                if(fitness == best)
+                {
+                    kill(getpid(), SIGKILL);
+                }
+                return fitness;
+            };
+
+            const double penalty = -1.0;
+            neat::ProcessPoolEvaluator evaluator(crashing_fitness, 2, penalty);
+            std::vector<double> scores(brains.size(), -2);
+            evaluator.Evaluate(brains, [&](std::size_t idx, double fitness) { scores[idx] = fitness; });
+
+            THEN("The crashing networks get the penalty and the rest is still evaluated")
+            {
+                std::size_t num_best = std::count(expected.begin(), expected.end(), best);
+                REQUIRE(evaluator.NumCrashes() == num_best);
+                for(std::size_t i = 0; i < brains.size(); ++i)
+                {
+                    REQUIRE(scores[i] == (expected[i] == best ? penalty : expected[i]));
+                }
+            }
+
+            THEN("The respawned workers keep evaluating")
+            {
+                std::vector<neat::SNeuralNetPtr> rest;
+                for(std::size_t i = 0; i < brains.size(); ++i)
+                {
+                    if(expected[i] != best)
+                    {
+                        rest.push_back(brains[i]);
+                    }
+                }
+
+                std::size_t num_scored = 0;
+                evaluator.Evaluate(rest, [&](std::size_t, double) { ++num_scored; });
+                REQUIRE(num_scored == rest.size());
+            }
+        }
+    }
+}
+
+
+SCENARIO("Networks of different sizes share a small ring buffer", "[ProcessPoolEvaluator]")
+{
+    GIVEN("Small networks and a large one")
+    {
+        neat::Params p;
+        neat::GenAlg ga(2, 1, p);
+        auto brains = ga.CreateNeuralNetworks();
+
+        neat::Genome g(1, 2, 1, &p);
+        neat::InnovationDB inno_db(g.NeuronGenes(), g.NeuronLinks());
+        for(int i = 0; i < 10; ++i)
+        {
+            g.AddNeuron(1.0, inno_db, 100);
+        }
+        auto large = std::make_shared<neat::NeuralNet>(g);
+
+        std::vector<std::uint8_t> buffer;
+        neat::BinaryWriter writer(buffer);
+        neat::encode_net(writer, *large);
+        // record header and payload padded to 8 bytes
+        std::size_t record_size = 16 + ((buffer.size() + 7) & ~std::size_t(7));
+
+        std::vector<neat::SNeuralNetPtr> mixed;
+        for(std::size_t i = 0; i < brains.size(); ++i)
+        {
+            mixed.push_back(brains[i]);
+            if(i % 3 == 0)
+            {
+                mixed.push_back(large);
+            }
+        }
+
+        WHEN("The large network takes up exactly half the ring")
+        {
+            neat::ProcessPoolEvaluator evaluator(xor_fitness, 1, 0.0, 2 * record_size);
+            std::vector<double> scores(mixed.size(), -1);
+            evaluator.Evaluate(mixed, [&](std::size_t idx, double fitness) { scores[idx] = fitness; });
+
+            THEN("Every network is evaluated")
+            {
+                for(std::size_t i = 0; i < mixed.size(); ++i)
+                {
+                    REQUIRE(scores[i] == xor_fitness(mixed[i]));
+                }
+            }
+        }
+
+        WHEN("The large network takes up just over half the ring")
+        {
+            neat::ProcessPoolEvaluator evaluator(xor_fitness, 1, 0.0, 2 * record_size - 8);
+
+            THEN("It is rejected instead of waiting for space that never comes")
+            {
+                REQUIRE_THROWS_AS(evaluator.Evaluate(mixed, [](std::size_t, double) {}), std::length_error);
+            }
+        }
+    }
+}
@@ -0,0 +1,164 @@
+#define CATCH_CONFIG_MAIN
+#include "catch.hpp"
+
+#include <vector>
+
+#include "evaluate.h"
+#include "genalg.h"
+#include "race.h"
+
+
+SCENARIO("Networks that can't survive are dropped from the race", "[Race]")
+{
+    GIVEN("Ten networks whose episodes score their index plus noise")
+    {
+        neat::Params p;
+        neat::Genome g(1, 2, 1, &p);
+        std::vector<neat::SNeuralNetPtr> brains;
+        for(int i = 0; i < 10; ++i)
+        {
+            brains.push_back(std::make_shared<neat::NeuralNet>(g));
+        }
+        auto quality = [&](const neat::SNeuralNetPtr& brain)
+        {
+            return double(std::find(brains.begin(), brains.end(), brain) - brains.begin());
+        };
+        // best networks first, like a population sorted by the last epoch
+        auto episode = [&](neat::SNeuralNetPtr brain, std::size_t num)
+        {
+            return 10 * (10 - quality(brain)) + (num % 2 ? 0.5 : -0.5);
+        };
+
+        neat::Race race(brains, 20, 0.2);
+
+        WHEN("Every network plays one after another")
+        {
+            auto fitness = race.Fitness(episode);
+            std::vector<double> scores;
+            for(auto& brain : brains)
+            {
+                scores.push_back(fitness(brain));
+            }
+
+            THEN("The best networks play every episode")
+            {
+                // Species::Spawn picks parents among the first 10 * 0.2 + 1
+                // and the leader
+                for(int i = 0; i < 4; ++i)
+                {
+                    REQUIRE_FALSE(race.IsAborted(brains[i]));
+                    REQUIRE(scores[i] == Approx(10 * (10 - i)));
+                }
+            }
+
+            THEN("The rest stop after the minimum number of episodes")
+            {
+                for(int i = 4; i < 10; ++i)
+                {
+                    REQUIRE(race.IsAborted(brains[i]));
+                    REQUIRE_FALSE(race.ShouldContinue(brains[i]));
+                }
+                REQUIRE(race.NumAborted() == 6);
+                REQUIRE(race.EpisodesPlayed() == 4 * 20 + 6 * 3);
+            }
+
+            THEN("Dropped networks still rank below the survivors")
+            {
+                for(int i = 1; i < 10; ++i)
+                {
+                    REQUIRE(scores[i] < scores[i - 1]);
+                }
+            }
+
+            THEN("A stopped network can't report again")
+            {
+                REQUIRE_THROWS_AS(race.Report(brains[9], 1.0), std::logic_error);
+            }
+        }
+
+        WHEN("The networks race in two groups")
+        {
+            std::vector<neat::SpeciesID> groups;
+            for(int i = 0; i < 10; ++i)
+            {
+                groups.push_back(i < 5 ? 1 : 2);
+            }
+            neat::Race grouped(brains, 20, 0.2, groups);
+            auto fitness = grouped.Fitness(episode);
+            for(auto& brain : brains)
+            {
+                fitness(brain);
+            }
+
+            THEN("The best of every group play every episode")
+            {
+                REQUIRE_FALSE(grouped.IsAborted(brains[0]));
+                REQUIRE_FALSE(grouped.IsAborted(brains[5]));
+                REQUIRE(grouped.IsAborted(brains[4]));
+                REQUIRE(grouped.IsAborted(brains[9]));
+            }
+        }
+    }
+}
+
+
+SCENARIO("A population is evolved with a race", "[Race]")
+{
+    GIVEN("A GenAlg and a multi-episode fitness function")
+    {
+        neat::Params p;
+        neat::GenAlg ga(2, 1, p);
+        auto brains = ga.CreateNeuralNetworks();
+
+        WHEN("Several generations are evolved through a thread pool")
+        {
+            std::size_t num_played = 0;
+            std::size_t num_possible = 0;
+            std::size_t num_aborted = 0;
+            for(int gen = 0; gen < 5; ++gen)
+            {
+                neat::Race race(ga, brains, 10);
+                neat::ThreadPoolEvaluator evaluator(race.Fitness([](neat::SNeuralNetPtr brain, std::size_t num)
+                    {
+                        // the output depends on the weights, so networks of a species score apart
+                        return 100 * brain->Update({1, 1}, neat::UPDATE_TYPE::SNAPSHOT)[0] + (num % 3);
+                    }), 4);
+                brains = ga.Epoch(brains, evaluator);
+                num_played += race.EpisodesPlayed();
+                num_aborted += race.NumAborted();
+                num_possible += 10 * p.PopulationSize();
+            }
+
+            THEN("The generations advance with fewer episodes played")
+            {
+                REQUIRE(ga.Generation() == 5);
+                REQUIRE(num_aborted > 0);
+                REQUIRE(num_played < num_possible);
+                REQUIRE(num_played >= 3 * num_possible / 10);
+            }
+        }
+    }
+
+    GIVEN("A GenAlg that selects parents by rank")
+    {
+        auto p = neat::Params::FromString(R"({"ParentSelection": "Rank"})");
+        neat::GenAlg ga(2, 1, p);
+        auto brains = ga.CreateNeuralNetworks();
+
+        WHEN("A generation is evaluated with a race")
+        {
+            neat::Race race(ga, brains, 10);
+            neat::ThreadPoolEvaluator evaluator(race.Fitness([](neat::SNeuralNetPtr brain, std::size_t num)
+                {
+                    return 100 * brain->Update({1, 1}, neat::UPDATE_TYPE::SNAPSHOT)[0] + (num % 3);
+                }), 4);
+            ga.Epoch(brains, evaluator);
+
+            THEN("Every network plays every episode, since any of them can be a parent")
+            {
+                REQUIRE(race.NumAborted() == 0);
+                REQUIRE(race.EpisodesPlayed() == 10 * p.PopulationSize());
+            }
+        }
+    }
+}
@@ -4,8 +4,12 @@
 #include "cpplinq.hpp"
 #include "json.hpp"
 
+#include <algorithm>
+#include <fstream>
+#include <sstream>
 #include <vector>
 
+#include "binformat.h"
 #include "genome.h"
 #include "phenotype.h"
 #include "genalg.h"
@@ -45,6 +49,8 @@ SCENARIO("A neural network gets serialized into a json file", "[serialize]")
             {
                 auto object = neat::deserialize_from_file("network.json");
                 neat::NeuralNet desernn(object);
+                REQUIRE(desernn.GetLevels() == nn.GetLevels());
+                REQUIRE(desernn.GetDepth() == nn.GetDepth());
 
                 auto nnresult = nn.Update({0.5, 0.5, 0.5});
                 auto desernnresult = desernn.Update({0.5, 0.5, 0.5});
@@ -57,6 +63,136 @@ SCENARIO("A neural network gets serialized into a json file", "[serialize]")
                     REQUIRE(diff < 0.0000000001);
                 });
             }
+
+            THEN("It gets loaded from a stream without a json document")
+            {
+                std::ifstream in("network.json");
+                auto streamed = neat::NeuralNet::FromStream(in);
+
+                REQUIRE(streamed.serialize() == nn.serialize());
+                REQUIRE(streamed.GetLevels() == nn.GetLevels());
+                REQUIRE(streamed.Update({0.5, 0.5, 0.5}) == nn.Update({0.5, 0.5, 0.5}));
+            }
+        }
+
+        WHEN("It gets written to a stream without a json document")
+        {
+            std::ostringstream pretty, compact, params;
+            neat::serialize_to_stream(pretty, nn);
+            neat::serialize_to_stream(compact, nn, false);
+            neat::serialize_to_stream(params, p);
+
+            THEN("The output is the same as dumping the document")
+            {
+                REQUIRE(pretty.str() == nn.serialize().dump(2));
+                REQUIRE(compact.str() == nn.serialize().dump());
+                REQUIRE(params.str() == p.serialize().dump(2));
+            }
+        }
+
+        WHEN("A stream doesn't hold a network")
+        {
+            std::istringstream not_json("[{\"ID\": 1,");
+            std::istringstream not_a_net("{\"ID\": 1}");
+
+            THEN("Loading it fails")
+            {
+                REQUIRE_THROWS_AS(neat::NeuralNet::FromStream(not_json), std::runtime_error);
+                REQUIRE_THROWS_AS(neat::NeuralNet::FromStream(not_a_net), std::runtime_error);
+            }
+        }
+    }
+}
+
+
+SCENARIO("A neural network gets serialized into the binary format", "[serialize]")
+{
+    GIVEN("A neural network with hidden neurons and recurrent links")
+    {
+        neat::Params p;
+        neat::Genome g(1, 3, 2, &p);
+        neat::InnovationDB inno_db(g.NeuronGenes(), g.NeuronLinks());
+        for(int i = 0; i < 5; ++i)
+        {
+            g.AddNeuron(1.0, inno_db, 100);
+            g.AddLink(1.0, 0.5, inno_db, 100, 100);
+        }
+        neat::NeuralNet nn(g);
+
+        WHEN("It gets serialized with double precision weights")
+        {
+            neat::serialize_binary_to_file("network.nnet", nn);
+            auto desernn = neat::deserialize_binary_from_file("network.nnet");
+
+            THEN("It produces exactly the same outputs")
+            {
+                REQUIRE(desernn.GetNeurons().size() == nn.GetNeurons().size());
+                for(int tick = 0; tick < 3; ++tick)
+                {
+                    REQUIRE(nn.Update({0.1, 0.5, 0.9}) == desernn.Update({0.1, 0.5, 0.9}));
+                }
+            }
+        }
+
+        WHEN("It gets serialized with single precision weights")
+        {
+            auto buffer = neat::serialize_binary(nn, neat::WeightPrecision::FLOAT32);
+            auto desernn = neat::deserialize_binary(buffer);
+
+            THEN("It is smaller and produces nearly the same outputs")
+            {
+                REQUIRE(buffer.size() < neat::serialize_binary(nn).size());
+                auto nnresult = nn.Update({0.5, 0.5, 0.5});
+                auto desernnresult = desernn.Update({0.5, 0.5, 0.5});
+                for(std::size_t i = 0; i < nnresult.size(); ++i)
+                {
+                    REQUIRE(std::fabs(nnresult[i] - desernnresult[i]) < 0.0001);
+                }
+            }
+        }
+
+        WHEN("The data is damaged")
+        {
+            auto buffer = neat::serialize_binary(nn);
+
+            THEN("Loading it fails")
+            {
+                auto truncated = buffer;
+                truncated.resize(buffer.size() - 1);
+                REQUIRE_THROWS_AS(neat::deserialize_binary(truncated), std::runtime_error);
+
+                auto bad_magic = buffer;
+                bad_magic[0] = 'X';
+                REQUIRE_THROWS_AS(neat::deserialize_binary(bad_magic), std::runtime_error);
+
+                // a neuron count far beyond the data is rejected before anything is allocated for it
+                auto huge_count = buffer;
+                std::fill(huge_count.begin() + 8, huge_count.begin() + 12, 0xFF);
+                REQUIRE_THROWS_AS(neat::deserialize_binary(huge_count), std::runtime_error);
+
+                // neurons start after the 16 byte header, 29 bytes each: type, ID, ...
+                auto bad_type = buffer;
+                bad_type[16] = 0x7F;
+                REQUIRE_THROWS_AS(neat::deserialize_binary(bad_type), std::runtime_error);
+
+                auto duplicate_id = buffer;
+                std::copy(buffer.begin() + 17, buffer.begin() + 21, duplicate_id.begin() + 16 + 29 + 1);
+                REQUIRE_THROWS_AS(neat::deserialize_binary(duplicate_id), std::runtime_error);
+            }
+        }
+
+        WHEN("An innovation database claims more innovations than the data holds")
+        {
+            std::vector<std::uint8_t> buffer;
+            neat::BinaryWriter writer(buffer);
+            neat::encode_innovations(writer, inno_db);
+            std::fill(buffer.begin() + 8, buffer.begin() + 12, 0xFF);
+
+            THEN("Loading it fails")
+            {
+                neat::BinaryReader reader(buffer);
+                REQUIRE_THROWS_AS(neat::decode_innovations(reader), std::runtime_error);
+            }
         }
     }
 }
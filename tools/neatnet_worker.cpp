@@ -0,0 +1,62 @@
+/**
+ * Standalone evaluation worker: connects to a DistributedEvaluator and scores
+ * the networks it receives with one of the built-in tasks. Custom tasks link
+ * against the library and call neat::run_worker with their own fitness
+ * function.
+ *
+ * Usage: neatnet_worker <address> [task]
+ */
+
+#include <cmath>
+#include <exception>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <string>
+
+#include "distributed.h"
+
+
+double xor_fitness(neat::SNeuralNetPtr brain)
+{
+    double error = 0.0;
+    error += brain->Update({0, 0}, neat::UPDATE_TYPE::SNAPSHOT)[0];
+    error += std::fabs(1 - brain->Update({0, 1}, neat::UPDATE_TYPE::SNAPSHOT)[0]);
+    error += std::fabs(1 - brain->Update({1, 0}, neat::UPDATE_TYPE::SNAPSHOT)[0]);
+    error += brain->Update({1, 1}, neat::UPDATE_TYPE::SNAPSHOT)[0];
+    return std::pow(4 - error, 2);
+}
+
+
+int main(int argc, char** argv)
+{
+    const std::map<std::string, neat::FitnessFunc> tasks = {
+        {"xor", xor_fitness}
+    };
+
+    if(argc < 2 || argc > 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " <unix:path | tcp:host:port> [task]" << std::endl;
+        return 1;
+    }
+
+    std::string task = argc == 3 ? argv[2] : "xor";
+    auto found = tasks.find(task);
+    if(found == tasks.end())
+    {
+        std::cerr << "Unknown task '" << task << "'" << std::endl;
+        return 1;
+    }
+
+    try
+    {
+        auto num_evaluated = neat::run_worker(argv[1], found->second);
+        std::cout << "Evaluated " << num_evaluated << " networks" << std::endl;
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}